@@ -16,6 +16,37 @@
 #include "ei_types.h"
 #include "ei_widget.h"
 
+/**
+ * @brief	What is left to do after a call to \ref ei_app_step.
+ */
+typedef enum {
+	ei_step_idle		= 0,	///< Nothing to do until the next event.
+	ei_step_pending,		///< Some work is pending: the next step should not wait.
+	ei_step_quit			///< \ref ei_app_quit_request has been called.
+} ei_step_status_t;
+
+/**
+ * @brief	A task run by the main loop when the application is idle.
+ *
+ * @param	user_param	The parameter given to \ref ei_app_post_idle.
+ *
+ * @return			EI_TRUE if the task is not done and must run again, EI_FALSE when
+ *				it is done.
+ */
+typedef ei_bool_t (*ei_idle_func_t)(void* user_param);
+
+/**
+ * @brief	A function that applies an update posted by \ref ei_app_post_update.
+ *		Called on the thread of the main loop.
+ *
+ * @param	widget		The widget given to \ref ei_app_post_update.
+ * @param	user_param	The parameter given to \ref ei_app_post_update.
+ * @param	superseded	EI_TRUE if a newer update of the same property has been posted
+ *				since: the update must not be applied, only user_param released.
+ */
+typedef void	(*ei_update_func_t)	(ei_widget_t*		widget,
+					 void*			user_param,
+					 ei_bool_t		superseded);
 
 
 /**
@@ -49,6 +80,69 @@ void ei_app_free(void);
  */
 void ei_app_run(void);
 
+/**
+ * \brief	Runs one iteration of the main loop, for programs which have their own main loop:
+ *		waits for an event at most timeout_ms milliseconds, processes all the events
+ *		that are ready, then draws what has been invalidated. What has been invalidated
+ *		since the previous step is drawn before waiting. The idle tasks run last, within
+ *		their budget: the step does not wait for an event while some are queued.
+ *
+ * @param	timeout_ms	The maximal time to wait for an event, in milliseconds. 0 only
+ *				processes the events that are already there, a negative value
+ *				waits until an event arrives.
+ *
+ * @return			\ref ei_step_quit if \ref ei_app_quit_request has been called,
+ *				\ref ei_step_pending if some work is left that does not need
+ *				to wait for an event, \ref ei_step_idle otherwise.
+ */
+ei_step_status_t ei_app_step(int timeout_ms);
+
+/**
+ * \brief	Queues a task to run when the application is idle: when all the ready events have
+ *		been processed and the screen is up to date. Idle tasks run by order of priority
+ *		(tasks of the same priority in turn), until the idle budget of the iteration of the
+ *		main loop is spent, so a long job should be split in small steps.
+ *
+ * @param	func		The function of the task.
+ * @param	user_param	A programmer supplied parameter that will be passed to func.
+ * @param	priority	The priority of the task: tasks with a higher priority run first.
+ *
+ * @return			An identifier of the task, to give to \ref ei_app_cancel_idle.
+ */
+uint32_t ei_app_post_idle(ei_idle_func_t func, void* user_param, int priority);
+
+/**
+ * \brief	Removes a task from the idle tasks. Does nothing if the task is already done.
+ *
+ * @param	id		The identifier returned by \ref ei_app_post_idle.
+ */
+void ei_app_cancel_idle(uint32_t id);
+
+/**
+ * \brief	Sets the time given to the idle tasks in each iteration of the main loop. No
+ *		task is started once it is spent, but a task is never interrupted.
+ *
+ * @param	budget_us	The budget, in microseconds. Defaults to 4000.
+ */
+void ei_app_set_idle_budget(int budget_us);
+
+/**
+ * \brief	Posts an update of the user interface from any thread. The only function of the
+ *		library that can be called from another thread than the one of the main loop.
+ *
+ *		The main loop applies all the posted updates at once in each iteration, before
+ *		drawing. Among the updates of the same widget with the same key posted in the
+ *		meantime, only the last one is applied: the others are called as superseded.
+ *		The widget must not be destroyed while an update of it is pending.
+ *
+ * @param	widget		The widget to update, or NULL.
+ * @param	key		Identifies the property updated, for example the address of the
+ *				configure function, or NULL if the update must never be skipped.
+ * @param	func		The function that applies the update.
+ * @param	user_param	A programmer supplied parameter that will be passed to func.
+ */
+void ei_app_post_update(ei_widget_t* widget, const void* key, ei_update_func_t func, void* user_param);
+
 /**
  * \brief	Adds a rectangle to the list of rectangles that must be updated on screen. The real
  *		update on the screen will be done at the right moment in the main loop.
@@ -58,6 +152,48 @@ void ei_app_run(void);
  */
 void ei_app_invalidate_rect(ei_rect_t* rect);
 
+/**
+ * \brief	Same as \ref ei_app_invalidate_rect, also given the place of the call in the source,
+ *		which is logged in the repaint flash mode (see \ref ei_flash_set_enabled).
+ *
+ * @param	rect		The rectangle to add, expressed in the root window coordinates.
+ * @param	file, line	Where the rectangle is invalidated, or NULL and 0 if unknown.
+ */
+void ei_app_invalidate_rect_at(ei_rect_t* rect, const char* file, int line);
+
+// The calls compiled with this header tell where they come from
+#define ei_app_invalidate_rect(rect) ei_app_invalidate_rect_at((rect), __FILE__, __LINE__)
+
+/**
+ * \brief	Scrolls the content of a rectangle of the root window: the pixels already drawn,
+ *		and the picking offscreen, are moved in place, and only the strips that the move
+ *		exposes are invalidated. The widgets drawn in the rectangle must already have
+ *		moved by the same offset, and nothing must be drawn over the rectangle.
+ *
+ *		The whole rectangle is invalidated instead when it cannot be moved: in a batch,
+ *		before the first frame, when the offset is larger than the rectangle, or when a
+ *		debugging overlay is drawn over the widgets.
+ *
+ * @param	rect		The rectangle, expressed in the root window coordinates.
+ * @param	dx, dy		The offset of the content, in pixels.
+ */
+void ei_app_scroll_rect(const ei_rect_t* rect, int dx, int dy);
+
+/**
+ * \brief	Starts a batch of changes to the widget tree, for example when creating or
+ *		destroying many widgets at once. Until the matching \ref ei_app_batch_commit,
+ *		the invalidated rectangles are merged instead of being added one by one to the
+ *		list of rectangles to update. Batches can be nested.
+ */
+void ei_app_batch_begin(void);
+
+/**
+ * \brief	Ends a batch started by \ref ei_app_batch_begin. When the outermost batch ends,
+ *		a single rectangle, which contains all the rectangles invalidated during the
+ *		batch, is added to the list of rectangles to update.
+ */
+void ei_app_batch_commit(void);
+
 /**
  * \brief	Tells the application to quite. Is usually called by an event handler (for example
  *		when pressing the "Escape" key).
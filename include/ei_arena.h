@@ -0,0 +1,62 @@
+#ifndef EI_ARENA_H
+#define EI_ARENA_H
+
+#include <stddef.h>
+
+/**
+ * \brief	A position in the frame arena, to release at once everything allocated after it.
+ */
+typedef struct ei_arena_mark_t {
+        void* block;                    ///< The block in use when the mark was taken.
+        size_t used;                    ///< The bytes used in this block.
+} ei_arena_mark_t;
+
+/**
+ * \brief	Allocates memory in the frame arena. The memory is set to 0 and stays valid
+ *		until the end of the current iteration of the main loop, when the arena is
+ *		reset: it must *not* be freed, and must not be kept from one frame to the next.
+ *		Widget classes can use it for transient drawing data (points, clippers...).
+ *
+ * @param	size		The number of bytes to allocate.
+ *
+ * @return			A block of memory with all bytes set to 0.
+ */
+void* ei_arena_alloc(size_t size);
+
+/**
+ * \brief	Returns the current position in the frame arena.
+ *
+ * @return			The mark, to give to \ref ei_arena_rewind.
+ */
+ei_arena_mark_t ei_arena_get_mark(void);
+
+/**
+ * \brief	Releases everything allocated in the frame arena since a mark was taken. Lets
+ *		a drawing function use the arena for its own scratch data even when it is called
+ *		outside of the main loop.
+ *
+ * @param	mark		A mark returned by \ref ei_arena_get_mark during the current frame.
+ */
+void ei_arena_rewind(ei_arena_mark_t mark);
+
+/**
+ * \brief	Releases at once all the memory allocated in the frame arena, which can then be
+ *		reused. Called by \ref ei_app_run at the end of each iteration of the main loop.
+ *		When the last frame needed more than one block, the blocks are merged so that
+ *		the next frames fit in a single block.
+ */
+void ei_arena_reset(void);
+
+/**
+ * \brief	Returns the memory reserved by the frame arena, whether it is in use or not.
+ *
+ * @return			The size of all the blocks of the arena, in bytes.
+ */
+size_t ei_arena_get_size(void);
+
+/**
+ * \brief	Gives back the memory of the frame arena to the system.
+ */
+void ei_arena_free(void);
+
+#endif //EI_ARENA_H
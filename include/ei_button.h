@@ -4,6 +4,8 @@
 #include "ei_application.h"
 #include "ei_drawing_tools.h"
 #include "ei_event.h"
+#include "ei_occlusion.h"
+#include "ei_skin.h"
 #include "ei_toplevel.h"
 #include "ei_widget.h"
 #include "ei_widgetclass.h"
@@ -27,4 +29,15 @@ typedef struct ei_button_t {
 
 extern ei_widgetclass_t buttonclass;
 
+/**
+ * \brief	Tells which part of a button is opaque: the widest band of the button that
+ *		does not cross the rounded corners.
+ *
+ * @param	widget		The button.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			EI_FALSE if the corners are too big to leave such a band.
+ */
+ei_bool_t button_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
 #endif //EI_BUTTON_H
@@ -0,0 +1,184 @@
+#ifndef EI_CANVAS_H
+#define EI_CANVAS_H
+
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_event.h"
+#include "ei_occlusion.h"
+#include "ei_rtree.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "ei_widgetclass.h"
+
+/**
+ * \brief	The kinds of items of a canvas.
+ */
+typedef enum {
+        ei_canvas_polygon = 0,          ///< A filled polygon, see \ref ei_draw_polygon.
+        ei_canvas_polyline,             ///< A line made of segments, see \ref ei_draw_polyline.
+        ei_canvas_text,                 ///< A text, see \ref ei_draw_text.
+        ei_canvas_image                 ///< A part of a surface, see \ref ei_draw_sprites.
+} ei_canvas_item_type_t;
+
+/**
+ * \brief	An item of a canvas. Its coordinates are relative to the top left corner of the
+ *		canvas.
+ */
+typedef struct ei_canvas_item_t {
+        int id;                         ///< The item, also its rank in the drawing order.
+        ei_canvas_item_type_t type;
+        ei_rect_t bounds;               ///< The rectangle the item is drawn in.
+        ei_color_t color;
+        ei_point_t* points;             ///< The points of a polygon or a polyline.
+        int point_count;
+        char* text;
+        ei_font_t font;
+        ei_surface_t image;             ///< The surface of an image, not owned by the canvas.
+        ei_point_t img_origin;          ///< The top left corner of the part of the surface to draw.
+} ei_canvas_item_t;
+
+/**
+ * \brief	A function that is called in response to a mouse event over a canvas.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item under the mouse, 0 if there is none.
+ * @param	event		The event.
+ * @param	user_param	The parameter given to \ref ei_canvas_configure.
+ *
+ * @return			EI_TRUE if the event was consumed.
+ */
+typedef ei_bool_t (*ei_canvas_handlefunc_t)(ei_widget_t*		widget,
+					    int				item,
+					    struct ei_event_t*		event,
+					    void*			user_param);
+
+/**
+ * \brief	A widget that keeps the primitives drawn in it: polygons, polylines, texts and
+ *		images. Items are not widgets, they are indexed by their bounds so that drawing
+ *		a part of the canvas, or finding the item under the mouse, only visits the items
+ *		there.
+ */
+typedef struct ei_canvas_t {
+        ei_widget_t widget;
+        ei_color_t* color;
+        ei_canvas_handlefunc_t* handlefunc;
+        void** user_param;
+        ei_rtree_t* index;              ///< The items, by bounds.
+        ei_canvas_item_t** items;       ///< The items, by id. Deleted items are NULL.
+        int next_id;
+        int item_capacity;
+        ei_canvas_item_t** found;       ///< The items to draw, kept from one draw to the next.
+        int found_count;
+        int found_capacity;
+} ei_canvas_t;
+
+extern ei_widgetclass_t canvasclass;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "canvas".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget. Defaults to the size needed by
+ *				the items of the canvas when this function is called.
+ * @param	color		The color of the background. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	handlefunc	The function called for mouse events over the canvas. Defaults to NULL.
+ * @param	user_param	A parameter passed to handlefunc. Defaults to NULL.
+ */
+void ei_canvas_configure (ei_widget_t* widget,
+                          ei_size_t* requested_size,
+                          const ei_color_t* color,
+                          ei_canvas_handlefunc_t* handlefunc,
+                          void** user_param);
+
+/**
+ * \brief	Adds a filled polygon to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	first_point	The points of the polygon, see \ref ei_draw_polygon. They are copied.
+ * @param	color		The color of the polygon.
+ *
+ * @return			The item, or 0 if there is no point.
+ */
+int ei_canvas_add_polygon(ei_widget_t* widget, const ei_linked_point_t* first_point, ei_color_t color);
+
+/**
+ * \brief	Adds a polyline to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	first_point	The points of the line, see \ref ei_draw_polyline. They are copied.
+ * @param	color		The color of the line.
+ *
+ * @return			The item, or 0 if there is no point.
+ */
+int ei_canvas_add_polyline(ei_widget_t* widget, const ei_linked_point_t* first_point, ei_color_t color);
+
+/**
+ * \brief	Adds a text to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	where		The top left corner of the text.
+ * @param	text		The text. It is copied.
+ * @param	font		The font, or NULL for \ref ei_default_font.
+ * @param	color		The color of the text.
+ *
+ * @return			The item.
+ */
+int ei_canvas_add_text(ei_widget_t* widget, const ei_point_t* where, const char* text, ei_font_t font,
+                       ei_color_t color);
+
+/**
+ * \brief	Adds an image to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	where		The top left corner of the image.
+ * @param	image		The surface of the image. It is not copied: it must stay valid as long
+ *				as the item exists.
+ * @param	img_rect	The part of the surface to draw, or NULL for all of it.
+ *
+ * @return			The item.
+ */
+int ei_canvas_add_image(ei_widget_t* widget, const ei_point_t* where, ei_surface_t image,
+                        const ei_rect_t* img_rect);
+
+/**
+ * \brief	Moves an item of a canvas.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item.
+ * @param	dx, dy		The offset.
+ */
+void ei_canvas_move(ei_widget_t* widget, int item, int dx, int dy);
+
+/**
+ * \brief	Removes an item from a canvas.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item.
+ */
+void ei_canvas_delete(ei_widget_t* widget, int item);
+
+/**
+ * \brief	Finds the top-most item of a canvas at a given location on screen. Polygons and
+ *		polylines are only found on their pixels, texts and images in all their bounds.
+ *
+ * @param	widget		The canvas.
+ * @param	where		The location, in the root window coordinates.
+ *
+ * @return			The item, or 0 if there is none.
+ */
+int ei_canvas_item_at(ei_widget_t* widget, const ei_point_t* where);
+
+/**
+ * \brief	Tells which part of a canvas is opaque: all of it.
+ *
+ * @param	widget		The canvas.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t canvas_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
+#endif //EI_CANVAS_H
@@ -0,0 +1,100 @@
+#ifndef EI_CHART_H
+#define EI_CHART_H
+
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_event.h"
+#include "ei_occlusion.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "ei_widgetclass.h"
+
+/**
+ * \brief	The samples of a chart shown in one column of pixels.
+ */
+typedef struct ei_chart_column_t {
+        float min;
+        float max;
+        float last;                     ///< The last sample of the column, joined to the next one.
+} ei_chart_column_t;
+
+/**
+ * \brief	A trace of the last samples of a stream of values, the most recent on the right.
+ *
+ *		Each column of pixels shows the minimum and the maximum of its samples, kept as
+ *		the samples are appended: drawing the chart costs as much as its width, not as
+ *		the number of samples. When samples are appended, the trace is scrolled by moving
+ *		the pixels already drawn, and only the new columns are drawn.
+ */
+typedef struct ei_chart_t {
+        ei_widget_t widget;
+        ei_color_t* color;
+        ei_color_t* trace_color;
+        int* capacity;
+        int* samples_per_column;
+        float* min_value;
+        float* max_value;
+        float* samples;                 ///< The last samples, by number modulo the capacity.
+        int sample_capacity;            ///< The size of samples.
+        long total;                     ///< The number of samples appended since the chart was cleared.
+        ei_chart_column_t* columns;     ///< The columns on screen, by number modulo their count.
+        int column_capacity;            ///< The size of columns: the width of the chart.
+        ei_bool_t columns_valid;        ///< EI_FALSE if the columns must be computed from the samples.
+} ei_chart_t;
+
+extern ei_widgetclass_t chartclass;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "chart".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget			The widget to configure.
+ * @param	requested_size		The size requested for this widget. Defaults to 300x100.
+ * @param	color			The color of the background. Defaults to
+ *					\ref ei_default_background_color.
+ * @param	trace_color		The color of the trace. Defaults to black.
+ * @param	capacity		The number of samples kept. The older ones are dropped.
+ *					Defaults to 4096.
+ * @param	samples_per_column	The number of samples shown in a column of pixels.
+ *					Defaults to 1.
+ * @param	min_value, max_value	The values shown at the bottom and at the top of the chart.
+ *					Default to 0 and 1.
+ */
+void ei_chart_configure (ei_widget_t* widget,
+                         ei_size_t* requested_size,
+                         const ei_color_t* color,
+                         const ei_color_t* trace_color,
+                         int* capacity,
+                         int* samples_per_column,
+                         float* min_value,
+                         float* max_value);
+
+/**
+ * \brief	Appends samples to a chart. The trace scrolls to the left by the number of
+ *		columns they start.
+ *
+ * @param	widget		The chart.
+ * @param	samples		The samples, the oldest first. They are copied.
+ * @param	count		The number of samples.
+ */
+void ei_chart_append(ei_widget_t* widget, const float* samples, int count);
+
+/**
+ * \brief	Removes all the samples of a chart.
+ *
+ * @param	widget		The chart.
+ */
+void ei_chart_clear(ei_widget_t* widget);
+
+/**
+ * \brief	Tells which part of a chart is opaque: all of it.
+ *
+ * @param	widget		The chart.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t chart_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
+#endif //EI_CHART_H
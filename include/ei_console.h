@@ -0,0 +1,86 @@
+#ifndef EI_CONSOLE_H
+#define EI_CONSOLE_H
+
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_event.h"
+#include "ei_occlusion.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "ei_widgetclass.h"
+
+/**
+ * \brief	A line of a console.
+ */
+typedef struct ei_console_line_t {
+        char* text;
+        ei_surface_t surface;           ///< The rendered text, NULL until the line is drawn.
+} ei_console_line_t;
+
+/**
+ * \brief	A log of lines of text, the most recent at the bottom.
+ *
+ *		The last lines are kept in a ring, with the rendered text of the ones on screen.
+ *		Appending lines moves the pixels already drawn up, and only draws the new rows.
+ */
+typedef struct ei_console_t {
+        ei_widget_t widget;
+        ei_color_t* color;
+        ei_color_t* text_color;
+        ei_font_t* text_font;
+        int* capacity;
+        ei_console_line_t* lines;       ///< The last lines, by number modulo the capacity.
+        int line_capacity;              ///< The size of lines.
+        long total;                     ///< The number of lines appended since the console was cleared.
+        int line_height;
+} ei_console_t;
+
+extern ei_widgetclass_t consoleclass;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "console".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget. Defaults to 400x200.
+ * @param	color		The color of the background. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	text_color	The color of the text. Defaults to \ref ei_font_default_color.
+ * @param	text_font	The font of the text. Defaults to \ref ei_default_font.
+ * @param	capacity	The number of lines kept. The older ones are dropped. Defaults to 1000.
+ */
+void ei_console_configure (ei_widget_t* widget,
+                           ei_size_t* requested_size,
+                           const ei_color_t* color,
+                           const ei_color_t* text_color,
+                           ei_font_t* text_font,
+                           int* capacity);
+
+/**
+ * \brief	Appends lines to a console. The lines already there are scrolled up once for all
+ *		the lines of the text: a burst of lines is faster to append in one call.
+ *
+ * @param	widget		The console.
+ * @param	text		The lines, separated by '\n'. They are copied.
+ */
+void ei_console_append(ei_widget_t* widget, const char* text);
+
+/**
+ * \brief	Removes all the lines of a console.
+ *
+ * @param	widget		The console.
+ */
+void ei_console_clear(ei_widget_t* widget);
+
+/**
+ * \brief	Tells which part of a console is opaque: all of it.
+ *
+ * @param	widget		The console.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t console_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
+#endif //EI_CONSOLE_H
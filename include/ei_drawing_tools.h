@@ -4,6 +4,7 @@
 #include <math.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include "ei_arena.h"
 #include "ei_draw.h"
 #include "ei_event.h"
 #include "ei_frame.h"
@@ -39,7 +40,8 @@ ei_color_t get_dark_color_variation(const ei_color_t* color);
  *                              This function uses anticlockwise direction and fin_angle needs
  *                              to be higher than init_angle.
  *
- * @return			The list of points describing the arc.
+ * @return			The list of points describing the arc, allocated in the frame arena:
+ *				it must not be freed.
  */
 ei_linked_point_t *arc(ei_point_t centre,int radius,float angle_init,float angle_fin);
 
@@ -50,7 +52,8 @@ ei_linked_point_t *arc(ei_point_t centre,int radius,float angle_init,float angle
  * @param	radius          Radius of the rounded corners.
  * @param	part 	        The part to describe.
  *
- * @return			The list of points describing the rounded frame.
+ * @return			The list of points describing the rounded frame, allocated in the
+ *				frame arena: it must not be freed.
  */
 ei_linked_point_t *rounded_frame(ei_rect_t rectangle, int radius, char partie);
 
@@ -66,6 +69,37 @@ ei_linked_point_t *rounded_frame(ei_rect_t rectangle, int radius, char partie);
  */
 ei_rect_t rectangle_intersect(ei_rect_t* first_rect, ei_rect_t* sec_rect);
 
+/**
+ * \brief	Returns the smallest rectangle that contains two rectangles.
+ *
+ * @param	first_rect  	The first rectangle. If NULL, returns sec_rect.
+ * @param	sec_rect        The second rectangle.
+ *
+ * @return			A rectangle which contains both first_rect and sec_rect.
+ */
+ei_rect_t rectangle_union(ei_rect_t* first_rect, ei_rect_t* sec_rect);
+
+/**
+ * \brief	Blends a translucent color over a rectangle of a surface: unlike \ref ei_fill, the
+ *		pixels below show through.
+ *
+ * @param	surface		The surface, *locked* by \ref hw_surface_lock.
+ * @param	rect		The rectangle, which must be inside the surface.
+ * @param	color		The color. Its alpha channel is the opacity of the blend.
+ */
+void blend_rect(ei_surface_t surface, const ei_rect_t* rect, ei_color_t color);
+
+/**
+ * \brief	Moves the pixels of a rectangle of a surface by an offset, in place. Only the
+ *		pixels that stay in the rectangle are moved: the strips that the move exposes
+ *		keep their old pixels.
+ *
+ * @param	surface		The surface, *locked* by \ref hw_surface_lock.
+ * @param	rect		The rectangle, which must be inside the surface.
+ * @param	dx, dy		The offset, smaller than the size of the rectangle.
+ */
+void move_rect(ei_surface_t surface, const ei_rect_t* rect, int dx, int dy);
+
 /**
  * \brief	Sets the coordinates of a topleft point regarding the anchor and the size of
  *              the object to anchor.
@@ -77,4 +111,21 @@ ei_rect_t rectangle_intersect(ei_rect_t* first_rect, ei_rect_t* sec_rect);
  */
 void anchoring(ei_anchor_t anchor, ei_point_t* where, ei_rect_t* screen_loc, ei_size_t* object_size);
 
+/**
+ * \brief	Returns the offscreen surface used to rasterize polygons, at least as big as the
+ *		requested size and cleared to transparent over that size. The same surface is
+ *		reused from one polygon to the next, it is only re-created when it is too small.
+ *
+ * @param	surface		The surface the polygon will be copied to, provides the channels order.
+ * @param	size		The size of the polygon.
+ *
+ * @return			The offscreen surface, *locked* by \ref hw_surface_lock.
+ */
+ei_surface_t get_polygon_offscreen(ei_surface_t surface, ei_size_t size);
+
+/**
+ * \brief	Releases the offscreen surface used to rasterize polygons.
+ */
+void free_polygon_offscreen(void);
+
 #endif //EI_DRAWING_TOOLS_H
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef EI_FLASH_H
+#define EI_FLASH_H
+
+#include <stdio.h>
+#include "ei_event.h"
+#include "ei_types.h"
+#include "hw_interface.h"
+
+/**
+ * \brief	Starts or stops the repaint flash mode, to debug what is redrawn: every rectangle
+ *		added to the list of rectangles to update is tinted with a translucent color,
+ *		which fades out in half a second, and the place in the source of the call to
+ *		\ref ei_app_invalidate_rect is logged. The color depends on this place. Off by
+ *		default.
+ *
+ * @param	enabled		EI_TRUE to flash the repainted rectangles.
+ */
+void ei_flash_set_enabled(ei_bool_t enabled);
+
+/**
+ * \brief	Tells if the repaint flash mode is on.
+ *
+ * @return			EI_TRUE if the repainted rectangles are flashed.
+ */
+ei_bool_t ei_flash_is_enabled(void);
+
+/**
+ * \brief	Sets where the repaint flash mode logs the invalidated rectangles.
+ *
+ * @param	log		The stream to write to, or NULL to log nothing. Defaults to stderr.
+ */
+void ei_flash_set_log(FILE* log);
+
+/**
+ * \brief	Records an invalidated rectangle, if the repaint flash mode is on. Called by
+ *		\ref ei_app_invalidate_rect_at.
+ *
+ * @param	rect		The rectangle, clipped to the root window.
+ * @param	file, line	Where the rectangle was invalidated, or NULL and 0 if unknown.
+ * @param	batched		EI_TRUE if the rectangle is merged into a batch (see
+ *				\ref ei_app_batch_begin): it is only logged, the merged
+ *				rectangle is flashed when the batch ends.
+ */
+void ei_flash_record(const ei_rect_t* rect, const char* file, int line, ei_bool_t batched);
+
+/**
+ * \brief	Handles the events the repaint flash mode schedules to fade out the flashes.
+ *		Called by the main loop for every event.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event was one of these events, and must not be handled.
+ */
+ei_bool_t ei_flash_handle_event(ei_event_t* event);
+
+/**
+ * \brief	Tints the flashes that are not faded out yet, within the rectangles drawn in this
+ *		frame. Called by the main loop after the widgets are drawn, before the screen is
+ *		updated.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rects		The rectangles drawn in this frame.
+ */
+void ei_flash_draw(ei_surface_t surface, const ei_linked_rect_t* rects);
+
+/**
+ * \brief	Forgets the flashes, and turns the repaint flash mode off.
+ */
+void ei_flash_free(void);
+
+#endif //EI_FLASH_H
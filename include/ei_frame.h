@@ -2,6 +2,8 @@
 #define EI_FRAME_H
 
 #include "ei_drawing_tools.h"
+#include "ei_occlusion.h"
+#include "ei_skin.h"
 #include "ei_types.h"
 #include "ei_widget.h"
 #include "ei_widgetclass.h"
@@ -22,4 +24,14 @@ typedef struct ei_frame_t {
 
 extern ei_widgetclass_t frameclass;
 
+/**
+ * \brief	Tells which part of a frame is opaque: all of it.
+ *
+ * @param	widget		The frame.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t frame_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
 #endif // EI_FRAME_H
@@ -0,0 +1,134 @@
+#ifndef EI_GRID_H
+#define EI_GRID_H
+
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_event.h"
+#include "ei_occlusion.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "ei_widgetclass.h"
+
+/**
+ * \brief	A function that draws one cell of a grid.
+ *
+ * @param	widget		The grid.
+ * @param	row, col	The cell to draw.
+ * @param	surface		Where to draw the cell, *locked* by \ref hw_surface_lock.
+ * @param	cell_rect	The location of the cell on screen.
+ * @param	clipper		The drawing must be restricted within this rectangle.
+ * @param	user_param	The cell data model given to \ref ei_grid_configure.
+ */
+typedef void	(*ei_grid_drawfunc_t)	(ei_widget_t*		widget,
+					 int			row,
+					 int			col,
+					 ei_surface_t		surface,
+					 const ei_rect_t*	cell_rect,
+					 const ei_rect_t*	clipper,
+					 void*			user_param);
+
+/**
+ * \brief	A function that is called in response to a mouse event over a cell of a grid.
+ *
+ * @param	widget		The grid.
+ * @param	row, col	The cell under the mouse.
+ * @param	event		The event.
+ * @param	user_param	The cell data model given to \ref ei_grid_configure.
+ *
+ * @return			EI_TRUE if the event was consumed.
+ */
+typedef ei_bool_t (*ei_grid_handlefunc_t)(ei_widget_t*		widget,
+					 int			row,
+					 int			col,
+					 struct ei_event_t*	event,
+					 void*			user_param);
+
+/**
+ * \brief	A grid of cells, all of the same size. Cells are not widgets: the grid calls
+ *		back the programmer to draw the cells that need it and to handle the events
+ *		over a cell, found from the mouse position.
+ */
+typedef struct ei_grid_t {
+        ei_widget_t widget;
+        int* rows;
+        int* cols;
+        ei_size_t* cell_size;
+        int* spacing;
+        ei_color_t* color;
+        ei_grid_drawfunc_t* drawfunc;
+        ei_grid_handlefunc_t* handlefunc;
+        void** user_param;
+} ei_grid_t;
+
+extern ei_widgetclass_t gridclass;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "grid".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget. Defaults to the size of all the
+ *				cells and their spacing.
+ * @param	rows, cols	The number of rows and columns of cells. Default to 0.
+ * @param	cell_size	The size of every cell. Defaults to 16x16.
+ * @param	spacing		The space in pixels between the cells and around them. Defaults to 1.
+ * @param	color		The color of the space between the cells. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	drawfunc	The function called to draw a cell. Defaults to NULL (cells are
+ *				not drawn).
+ * @param	handlefunc	The function called for mouse events over a cell. Defaults to NULL.
+ * @param	user_param	The cell data model, passed to drawfunc and handlefunc. Defaults to NULL.
+ */
+void ei_grid_configure (ei_widget_t* widget,
+                        ei_size_t* requested_size,
+                        int* rows,
+                        int* cols,
+                        ei_size_t* cell_size,
+                        int* spacing,
+                        const ei_color_t* color,
+                        ei_grid_drawfunc_t* drawfunc,
+                        ei_grid_handlefunc_t* handlefunc,
+                        void** user_param);
+
+/**
+ * \brief	Returns the location on screen of a cell of a grid.
+ *
+ * @param	widget		The grid.
+ * @param	row, col	The cell.
+ *
+ * @return			The rectangle of the cell, in the root window coordinates.
+ */
+ei_rect_t ei_grid_cell_rect(ei_widget_t* widget, int row, int col);
+
+/**
+ * \brief	Finds the cell of a grid at a given location on screen.
+ *
+ * @param	widget		The grid.
+ * @param	where		The location, in the root window coordinates.
+ * @param	row, col	Where to store the cell.
+ *
+ * @return			EI_FALSE if the location is outside of the cells (including
+ *				the spacing between them).
+ */
+ei_bool_t ei_grid_cell_at(ei_widget_t* widget, const ei_point_t* where, int* row, int* col);
+
+/**
+ * \brief	Tells the grid a cell has changed: only this cell is redrawn.
+ *
+ * @param	widget		The grid.
+ * @param	row, col	The cell.
+ */
+void ei_grid_invalidate_cell(ei_widget_t* widget, int row, int col);
+
+/**
+ * \brief	Tells which part of a grid is opaque: all of it.
+ *
+ * @param	widget		The grid.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t grid_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
+#endif //EI_GRID_H
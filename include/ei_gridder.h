@@ -0,0 +1,129 @@
+#ifndef EI_GRIDDER_H
+#define EI_GRIDDER_H
+
+#include "ei_types.h"
+
+struct ei_widget_t;
+
+/**
+ * \brief	The parameters of a widget managed by the "gridder" geometry manager: the cell
+ *		of its parent where it is placed.
+ */
+typedef struct ei_gridder_params_t {
+        int row;                        ///< The row of the cell.
+        int column;                     ///< The column of the cell.
+        int padding;                    ///< The space in pixels kept around the widget in its cell.
+        ei_bool_t fill;                 ///< If EI_TRUE, the widget takes the whole cell.
+        ei_anchor_t anchor;             ///< Where the widget is in its cell when it does not fill it.
+} ei_gridder_params_t;
+
+/**
+ * \brief	A row or a column of the cells of a parent.
+ */
+typedef struct ei_gridder_line_t {
+        int weight;                     ///< The share of the extra space given to the line.
+        int min_size;                   ///< The minimum size of the line, in pixels.
+        int size;                       ///< The computed size of the line.
+        int offset;                     ///< The computed position of the line in the content rect.
+} ei_gridder_line_t;
+
+/**
+ * \brief	The rows and columns of the cells of a parent, computed once for all its
+ *		children, and kept until they have to be computed again.
+ */
+typedef struct ei_gridder_t {
+        ei_gridder_line_t* rows;        ///< The rows, allocated for row_capacity of them.
+        int row_count;
+        int row_capacity;
+        ei_gridder_line_t* columns;     ///< The columns, allocated for column_capacity of them.
+        int column_count;
+        int column_capacity;
+        ei_bool_t dirty;                ///< EI_TRUE if the lines must be computed again.
+        ei_size_t solved_size;          ///< The size of the content rect the lines were computed for.
+} ei_gridder_t;
+
+/**
+ * \brief	Configures the geometry of a widget using the "gridder" geometry manager: the
+ *		content rect of the parent is split into rows and columns, and the widget is put
+ *		in one of the cells.
+ *
+ *		A row is as high as the highest widget placed in it, padding included, and at
+ *		least as its minimum size. The same goes for the width of a column. The space left
+ *		in the parent is shared between the rows and the columns according to their
+ *		weights, see \ref ei_gridder_configure_row.
+ *
+ *		If the widget was already managed by the "gridder", then arguments that are not
+ *		NULL replace previous values. Otherwise, the widget stops being managed by the
+ *		"placer".
+ *
+ * @param	widget		The widget to place.
+ * @param	row		The row of the cell (defaults to 0).
+ * @param	column		The column of the cell (defaults to 0).
+ * @param	padding		The space in pixels kept around the widget in its cell (defaults to 0).
+ * @param	fill		If EI_TRUE, the widget takes the whole cell. If EI_FALSE, it keeps its
+ *				requested size (defaults to EI_TRUE).
+ * @param	anchor		Where the widget is in its cell when it does not fill it (defaults
+ *				to ei_anc_center).
+ */
+void ei_gridder_place(struct ei_widget_t* widget, int* row, int* column, int* padding, ei_bool_t* fill,
+                      ei_anchor_t* anchor);
+
+/**
+ * \brief	Configures a row of the cells of a widget.
+ *
+ * @param	parent		The widget which children are placed by the "gridder".
+ * @param	row		The row.
+ * @param	weight		If not NULL, the share of the extra space given to the row. Rows all
+ *				have a weight of 0 by default: they keep the size they need.
+ * @param	min_size	If not NULL, the minimum height of the row (defaults to 0).
+ */
+void ei_gridder_configure_row(struct ei_widget_t* parent, int row, int* weight, int* min_size);
+
+/**
+ * \brief	Configures a column of the cells of a widget.
+ *
+ * @param	parent		The widget which children are placed by the "gridder".
+ * @param	column		The column.
+ * @param	weight		If not NULL, the share of the extra space given to the column. Columns
+ *				all have a weight of 0 by default: they keep the size they need.
+ * @param	min_size	If not NULL, the minimum width of the column (defaults to 0).
+ */
+void ei_gridder_configure_column(struct ei_widget_t* parent, int column, int* weight, int* min_size);
+
+/**
+ * \brief	Computes the geometry of a widget managed by the "gridder", without moving the
+ *		widget. The rows and columns of its parent are only computed again if they have
+ *		changed, so that placing all the children takes a single pass. Called by
+ *		\ref ei_placer_rect.
+ *
+ * @param	widget		The widget which geometry must be computed.
+ *
+ * @return			The geometry, in the root window coordinates.
+ */
+ei_rect_t ei_gridder_rect(struct ei_widget_t* widget);
+
+/**
+ * \brief	Tells the "gridder" that the requested size of a widget has changed, so that the
+ *		rows and columns of its parent are computed again.
+ *
+ * @param	widget		The widget. Nothing is done if it is not managed by the "gridder".
+ */
+void ei_gridder_child_changed(struct ei_widget_t* widget);
+
+/**
+ * \brief	Tells the "gridder" to remove a widget from the screen and forget about it.
+ *		Note: the widget is not destroyed and still exists in memory.
+ *
+ * @param	widget		The widget to remove from screen.
+ */
+void ei_gridder_forget(struct ei_widget_t* widget);
+
+/**
+ * \brief	Releases the "gridder" data of a widget, both as a child and as a parent. Called
+ *		when the widget is destroyed.
+ *
+ * @param	widget		The widget.
+ */
+void ei_gridder_release(struct ei_widget_t* widget);
+
+#endif //EI_GRIDDER_H
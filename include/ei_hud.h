@@ -0,0 +1,69 @@
+#ifndef EI_HUD_H
+#define EI_HUD_H
+
+#include "ei_draw.h"
+#include "ei_event.h"
+#include "ei_types.h"
+#include "hw_interface.h"
+
+/**
+ * \brief	Shows or hides the performance overlay: a small panel drawn over the top right
+ *		corner of the root window, on top of all the widgets. It shows the time spent
+ *		drawing the last frame, the frames and events per second, the number and area of
+ *		the rectangles drawn, the memory reserved by the frame arena, and the time of the
+ *		last frames as a sparkline. Hidden by default.
+ *
+ * @param	visible		EI_TRUE to show the overlay.
+ */
+void ei_hud_set_visible(ei_bool_t visible);
+
+/**
+ * \brief	Tells if the performance overlay is shown.
+ *
+ * @return			EI_TRUE if the overlay is shown.
+ */
+ei_bool_t ei_hud_is_visible(void);
+
+/**
+ * \brief	Sets a key that shows or hides the performance overlay. The key press is not
+ *		given to the widgets nor to the default handle function.
+ *
+ * @param	key_code	The key, or 0 for no key (the default).
+ */
+void ei_hud_set_toggle_key(int key_code);
+
+/**
+ * \brief	Counts an event for the statistics of the overlay, and toggles the overlay if
+ *		it is the toggle key. Called by the main loop for every event.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event was the toggle key, and must not be handled.
+ */
+ei_bool_t ei_hud_handle_event(ei_event_t* event);
+
+/**
+ * \brief	Draws the overlay, if it is shown, over all the widgets. Called by the main loop
+ *		at the end of each frame, before the screen is updated.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rect		Where to store the rectangle of the overlay, to update on screen.
+ *
+ * @return			EI_FALSE if the overlay is hidden and nothing was drawn.
+ */
+ei_bool_t ei_hud_draw(ei_surface_t surface, ei_rect_t* rect);
+
+/**
+ * \brief	Records the statistics of a frame. Called by the main loop after each frame.
+ *
+ * @param	rects		The rectangles that were drawn.
+ * @param	frame_time	The time spent drawing the frame, in seconds.
+ */
+void ei_hud_frame_done(const ei_linked_rect_t* rects, double frame_time);
+
+/**
+ * \brief	Releases the resources of the overlay.
+ */
+void ei_hud_free(void);
+
+#endif //EI_HUD_H
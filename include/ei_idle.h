@@ -0,0 +1,25 @@
+#ifndef EI_IDLE_H
+#define EI_IDLE_H
+
+#include "ei_application.h"
+
+/**
+ * \brief	Runs the idle tasks, by order of priority, until they are all done or the idle
+ *		budget of the iteration is spent. Called by \ref ei_app_step once the ready events
+ *		are processed and the screen is up to date.
+ */
+void ei_idle_run(void);
+
+/**
+ * \brief	Tells if some idle tasks are waiting to run.
+ *
+ * @return			EI_TRUE if at least one idle task is queued.
+ */
+ei_bool_t ei_idle_pending(void);
+
+/**
+ * \brief	Releases all the idle tasks, without running them.
+ */
+void ei_idle_free(void);
+
+#endif //EI_IDLE_H
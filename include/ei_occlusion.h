@@ -0,0 +1,71 @@
+#ifndef EI_OCCLUSION_H
+#define EI_OCCLUSION_H
+
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "ei_widgetclass.h"
+#include "hw_interface.h"
+
+/**
+ * \brief	A function that tells which part of a widget is opaque, i.e. which pixels are
+ *		entirely overwritten by its draw function whatever was drawn below.
+ *
+ * @param	widget		The widget, already placed by its geometry manager.
+ * @param	opaque		Where to store the opaque rectangle, in the root window coordinates.
+ *
+ * @return			EI_TRUE if the widget has an opaque rectangle, EI_FALSE otherwise.
+ */
+typedef ei_bool_t (*ei_occlusion_opaquefunc_t)(struct ei_widget_t* widget, ei_rect_t* opaque);
+
+/**
+ * \brief	The result of the occlusion culling of the children of a widget: which part of
+ *		the clipper each child has to draw, and which part no opaque child covers.
+ */
+typedef struct ei_occlusion_t {
+        int count;                      ///< The number of children in the clipper.
+        struct ei_widget_t** children;  ///< The children in the clipper, placed, from back to front.
+        ei_linked_rect_t** visible;     ///< The rectangles where each child is visible, within its outer rectangle.
+        ei_linked_rect_t* uncovered;    ///< The rectangles of the clipper no opaque child covers.
+} ei_occlusion_t;
+
+/**
+ * \brief	Declares the opaque region of a class of widgets. Classes without an opaque
+ *		region are considered transparent: they never hide what is below them.
+ *
+ * @param	widgetclass	The class of widget.
+ * @param	opaquefunc	The function computing the opaque rectangle of a widget of this class.
+ */
+void ei_occlusion_register(ei_widgetclass_t* widgetclass, ei_occlusion_opaquefunc_t opaquefunc);
+
+/**
+ * \brief	Culls the children of a widget outside of the clipper, and runs the geometry
+ *		manager of the others, then walks them from front to back, subtracting their
+ *		opaque rectangles from the visible region. Each child is given the part of the
+ *		region it covers, with adjacent bands merged.
+ *
+ *		Culled children are not placed: their screen location is the one they had when
+ *		last drawn, until they are drawn again.
+ *
+ * @param	occlusion	Where to store the result, allocated in the frame arena.
+ * @param	parent		The widget which children are culled.
+ * @param	clipper		The region to draw.
+ */
+void ei_occlusion_compute(ei_occlusion_t* occlusion, struct ei_widget_t* parent, const ei_rect_t* clipper);
+
+/**
+ * \brief	Draws the children of a widget from back to front, each one only where it is
+ *		visible, from its record if it has one. Hidden children are skipped.
+ *
+ * @param	occlusion	The result of \ref ei_occlusion_compute.
+ * @param	surface		Where to draw the children.
+ * @param	pick_surface	The picking offscreen.
+ */
+void ei_occlusion_draw_children(const ei_occlusion_t* occlusion, ei_surface_t surface,
+                                ei_surface_t pick_surface);
+
+/**
+ * \brief	Forgets all the opaque functions declared by \ref ei_occlusion_register.
+ */
+void ei_occlusion_unregister_all(void);
+
+#endif //EI_OCCLUSION_H
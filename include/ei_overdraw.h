@@ -0,0 +1,80 @@
+#ifndef EI_OVERDRAW_H
+#define EI_OVERDRAW_H
+
+#include "ei_types.h"
+#include "hw_interface.h"
+
+/**
+ * \brief	EI_TRUE while the writes to the pixels are counted. Read by \ref ei_overdraw_count,
+ *		so that it only costs a test when the counting is off: use
+ *		\ref ei_overdraw_set_enabled to change it.
+ */
+extern ei_bool_t ei_overdraw_enabled;
+
+/**
+ * \brief	Counts a write to every pixel of a rectangle. Use \ref ei_overdraw_count instead.
+ *
+ * @param	surface		The surface written to. Only the writes to the root surface and to
+ *				the picking surface are counted, in the same counters.
+ * @param	rect		The rectangle written, or NULL for the whole surface.
+ */
+void ei_overdraw_record(ei_surface_t surface, const ei_rect_t* rect);
+
+/**
+ * \brief	Counts a write to every pixel of a rectangle, if the counting is on. Called by the
+ *		drawing functions of \ref ei_draw.h.
+ *
+ * @param	surface		The surface written to.
+ * @param	rect		The rectangle written, or NULL for the whole surface.
+ */
+static inline void ei_overdraw_count(ei_surface_t surface, const ei_rect_t* rect)
+{
+	if (ei_overdraw_enabled) ei_overdraw_record(surface, rect);
+}
+
+/**
+ * \brief	Starts or stops counting how many times each pixel is written in a frame, to
+ *		measure the overdraw. The counting is off by default.
+ *
+ * @param	enabled		EI_TRUE to count the writes.
+ */
+void ei_overdraw_set_enabled(ei_bool_t enabled);
+
+/**
+ * \brief	Shows or hides the overdraw heatmap: each pixel drawn in a frame is tinted with a
+ *		color that depends on how many times it was written, from blue (once) to red
+ *		(five times or more). Showing the heatmap starts the counting.
+ *
+ * @param	visible		EI_TRUE to show the heatmap.
+ */
+void ei_overdraw_set_heatmap(ei_bool_t visible);
+
+/**
+ * \brief	Returns the overdraw of the last frame.
+ *
+ * @param	average		Where to store the average number of writes per pixel, among the
+ *				pixels written at least once. Can be NULL.
+ * @param	maximum		Where to store the highest number of writes to a pixel. Can be NULL.
+ */
+void ei_overdraw_get_stats(double* average, int* maximum);
+
+/**
+ * \brief	Sets all the counters to 0. Called by the main loop before drawing a frame.
+ */
+void ei_overdraw_begin_frame(void);
+
+/**
+ * \brief	Computes the overdraw of the frame, and draws the heatmap if it is shown. Called by
+ *		the main loop after the widgets are drawn, before the screen is updated.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rects		The rectangles drawn in this frame.
+ */
+void ei_overdraw_end_frame(ei_surface_t surface, const ei_linked_rect_t* rects);
+
+/**
+ * \brief	Releases the counters, and stops the counting.
+ */
+void ei_overdraw_free(void);
+
+#endif //EI_OVERDRAW_H
@@ -1,8 +1,28 @@
 #ifndef EI_PICKING_H
 #define EI_PICKING_H
 
+#include <stdint.h>
+#include "ei_types.h"
 #include "hw_interface.h"
 
+#define EI_PICK_ID_MAX	0xffffff	///< The largest pick ID, the most a pick color can encode.
+
+/**
+ * \brief	The picking offscreen: the pick ID of the widget drawn at each pixel of the root
+ *		window. IDs are stored on 16 bits, and on 32 bits while a widget has an ID that
+ *		does not fit. The IDs of destroyed widgets are given to new ones, so the depth
+ *		depends on the number of widgets alive, not on the number ever created.
+ *
+ *		It is given to the draw functions of the widget classes as their pick_surface.
+ *		It is not a surface of the hardware layer: only \ref ei_fill, \ref ei_draw_polygon
+ *		and \ref ei_skin_draw_mask can draw in it, with the pick_color of the widget.
+ */
+typedef struct ei_pick_buffer_t {
+        ei_size_t size;                 ///< The size of the root window.
+        int depth;                      ///< Bytes per ID: 2, or 4.
+        void* ids;                      ///< The IDs, row by row.
+} ei_pick_buffer_t;
+
 /**
  * Returns the picking surface currently being used.
  *
@@ -11,10 +31,88 @@
 ei_surface_t* ei_picking_get_picking_surface (void);
 
 /**
- * Sets a picking surface.
+ * \brief	Creates the picking offscreen, which becomes the picking surface.
+ *
+ * @param	size		The size of the root window.
+ */
+void ei_picking_create (ei_size_t size);
+
+/**
+ * \brief	Releases the picking offscreen.
+ */
+void ei_picking_free (void);
+
+/**
+ * \brief	Tells if a surface is the picking offscreen, to draw pick IDs instead of colors.
+ *
+ * @param	surface		The surface.
+ *
+ * @return			EI_TRUE if surface is the picking offscreen.
+ */
+ei_bool_t ei_picking_is_buffer (ei_surface_t surface);
+
+/**
+ * \brief	Gives a pick ID to a new widget: the smallest ID released by a destroyed widget,
+ *		or a new one. The picking offscreen switches to 32 bits IDs if it does not fit
+ *		on 16 bits.
+ *
+ * @param	id		Where to store the ID.
+ *
+ * @return			EI_FALSE if all the IDs up to \ref EI_PICK_ID_MAX are used.
+ */
+ei_bool_t ei_picking_acquire_id (uint32_t* id);
+
+/**
+ * \brief	Releases the pick ID of a destroyed widget, to give it to a new one. The picking
+ *		offscreen switches back to 16 bits IDs when no ID in use needs 32 bits.
+ *
+ * @param	id		The ID.
+ */
+void ei_picking_release_id (uint32_t id);
+
+/**
+ * \brief	Stores an ID in a rectangle of the picking offscreen.
+ *
+ * @param	rect		The rectangle, clipped to the offscreen. If NULL, the whole offscreen.
+ * @param	id		The ID.
+ */
+void ei_picking_fill (const ei_rect_t* rect, uint32_t id);
+
+/**
+ * \brief	Stores an ID in the pixels of a rectangle of the picking offscreen where a mask
+ *		is not transparent.
+ *
+ * @param	dst_rect	The rectangle of the offscreen.
+ * @param	mask		The mask, *locked*: a surface with an alpha channel.
+ * @param	src_rect	The rectangle of the mask, of the same size as dst_rect.
+ * @param	id		The ID.
+ */
+void ei_picking_fill_mask (const ei_rect_t* dst_rect, ei_surface_t mask, const ei_rect_t* src_rect,
+                           uint32_t id);
+
+/**
+ * \brief	Moves the IDs of a rectangle of the picking offscreen by an offset, in place, as
+ *		\ref move_rect does with the pixels of the root window.
+ *
+ * @param	rect		The rectangle, which must be inside the offscreen.
+ * @param	dx, dy		The offset, smaller than the size of the rectangle.
+ */
+void ei_picking_move (const ei_rect_t* rect, int dx, int dy);
+
+/**
+ * \brief	Returns the ID stored at a location of the picking offscreen.
+ *
+ * @param	where		The location, in the root window coordinates.
+ *
+ * @return			The ID, or 0 outside of the offscreen.
+ */
+uint32_t ei_picking_get_id (const ei_point_t* where);
+
+/**
+ * \brief	Returns the rectangle of the picking offscreen.
  *
- * @param	widget		The widget to declare as the picking surface.
+ * @return			The rectangle of the root window.
  */
-void ei_picking_set_picking_surface (ei_surface_t *surface);
+ei_rect_t ei_picking_get_rect (void);
 
 #endif //EI_PICKING_H
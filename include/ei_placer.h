@@ -14,6 +14,8 @@
 #include "ei_types.h"
 
 struct ei_widget_t;
+struct ei_gridder_params_t;
+struct ei_gridder_t;
 
 
 
@@ -47,6 +49,9 @@ typedef struct ei_placer_params_t {
 	float			rw_data;
 	float*			rh;		///< The requested relative height.
 	float			rh_data;
+
+	struct ei_gridder_params_t*	grid;		///< If not NULL, the widget is managed by the "gridder" instead, see \ref ei_gridder_place.
+	struct ei_gridder_t*		gridder;	///< If not NULL, the rows and columns of the children managed by the "gridder".
 } ei_placer_params_t;
 
 
@@ -64,6 +69,8 @@ typedef struct ei_placer_params_t {
  *		relative), then either the requested size of the widget is used if one was provided,
  *		or the default size is used.
  *
+ *		If the widget was managed by the "gridder", it stops being.
+ *
  * @param	widget		The widget to place.
  * @param	anchor		How to anchor the widget to the position defined by the placer
  *				(defaults to ei_anc_northwest).
@@ -96,6 +103,19 @@ void		ei_place	(struct ei_widget_t*	widget,
 
 
 
+/**
+ * \brief	Computes the geometry the placer gives to a widget, without moving the widget,
+ *		e.g. to know if it is visible before placing it.
+ *		Widgets managed by the "gridder" are computed by \ref ei_gridder_rect instead.
+ *
+ * @param	widget		The widget, previously placed by a call to \ref ei_place.
+ *
+ * @return			The geometry, in the root window coordinates.
+ */
+ei_rect_t ei_placer_rect(struct ei_widget_t* widget);
+
+
+
 /**
  * \brief	Tells the placer to recompute the geometry of a widget.
  *		The widget must have been previsouly placed by a call to \ref ei_place.
@@ -0,0 +1,156 @@
+#ifndef EI_RECORD_H
+#define EI_RECORD_H
+
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "hw_interface.h"
+
+#define EI_RECORD_MAX_COMMANDS	256	///< Widgets that draw more commands are always drawn by their class.
+
+struct ei_skin_t;
+
+/**
+ * \brief	EI_TRUE while the draw function of a widget is recorded. Read by
+ *		\ref ei_record_capturing, so that it only costs a test when nothing is recorded.
+ */
+extern ei_bool_t ei_recording;
+
+/**
+ * \brief	Tells if a surface is one the widget being recorded is drawn in. Use
+ *		\ref ei_record_capturing instead.
+ *
+ * @param	surface		The surface.
+ *
+ * @return			EI_TRUE if the drawing in this surface must be recorded.
+ */
+ei_bool_t ei_record_captures(ei_surface_t surface);
+
+/**
+ * \brief	Tells if a drawing must be recorded instead of drawn. Called first by the drawing
+ *		functions of \ref ei_draw.h and \ref ei_skin.h, which add a command to the record
+ *		of the widget when it is the case. The drawings in other surfaces, e.g. the
+ *		offscreens of the widget, are done right away.
+ *
+ * @param	surface		The surface drawn in.
+ *
+ * @return			EI_TRUE if the drawing must be recorded.
+ */
+static inline ei_bool_t ei_record_capturing(ei_surface_t surface)
+{
+	return ei_recording && ei_record_captures(surface);
+}
+
+/**
+ * \brief	Declares that the widgets of a class can be recorded. Their class must redraw
+ *		them all when their appearance changes, with \ref ei_widget_invalidate or by
+ *		configuring them. Widgets of other classes are always drawn by their class.
+ *
+ * @param	widgetclass	The class of widget.
+ */
+void ei_record_register(ei_widgetclass_t* widgetclass);
+
+/**
+ * \brief	Forgets all the classes declared by \ref ei_record_register.
+ */
+void ei_record_unregister_all(void);
+
+/**
+ * \brief	Draws a widget from its record: the commands drawn by its class the last time it
+ *		was recorded, with their bounds, are replayed where they intersect the clipper.
+ *		The class is only called again to record the widget when it has been invalidated,
+ *		when its size has changed, or when it has moved to where it was not recorded.
+ *		Widgets of classes not declared by \ref ei_record_register, widgets with
+ *		children, and the ones drawing too many commands, are always drawn by their class.
+ *
+ * @param	widget		The widget.
+ * @param	surface		Where to draw the widget.
+ * @param	pick_surface	The picking offscreen.
+ * @param	clipper		The drawing is restricted within this rectangle.
+ */
+void ei_record_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+                    ei_rect_t* clipper);
+
+/**
+ * \brief	Forgets the record of a widget, because its appearance has changed: it is drawn
+ *		by its class the next time. Called by \ref ei_widget_invalidate and when a widget
+ *		is configured.
+ *
+ * @param	widget		The widget.
+ */
+void ei_record_discard(ei_widget_t* widget);
+
+/**
+ * \brief	Releases the record of a widget that is destroyed.
+ *
+ * @param	widget		The widget.
+ */
+void ei_record_release(ei_widget_t* widget);
+
+/**
+ * \brief	Turns the recording on or off. When it is off, the widgets are always drawn by
+ *		their class. It is on by default.
+ *
+ * @param	enabled		EI_TRUE to record the widgets.
+ */
+void ei_record_set_enabled(ei_bool_t enabled);
+
+/**
+ * \brief	Releases all the records.
+ */
+void ei_record_free(void);
+
+/**
+ * \brief	Records \ref ei_fill.
+ */
+void ei_record_fill(ei_surface_t surface, const ei_color_t* color, const ei_rect_t* clipper);
+
+/**
+ * \brief	Records \ref ei_fill_with_pick.
+ */
+void ei_record_fill_with_pick(ei_surface_t surface, const ei_color_t* color, ei_surface_t pick_surface,
+                              const ei_color_t* pick_color, const ei_rect_t* clipper);
+
+/**
+ * \brief	Records \ref ei_draw_polyline.
+ */
+void ei_record_polyline(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                        const ei_rect_t* clipper);
+
+/**
+ * \brief	Records \ref ei_draw_polygon and \ref ei_draw_polygon_with_pick.
+ */
+void ei_record_polygon(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                       ei_surface_t pick_surface, const ei_color_t* pick_color, const ei_rect_t* clipper);
+
+/**
+ * \brief	Records \ref ei_draw_text. The text is rendered once, when it is recorded.
+ */
+void ei_record_text(ei_surface_t surface, const ei_point_t* where, const char* text, ei_font_t font,
+                    ei_color_t color, const ei_rect_t* clipper);
+
+/**
+ * \brief	Records \ref ei_copy_surface. The source surface is read when the command is
+ *		replayed: it must stay valid until the widget is invalidated.
+ *
+ * @return			1 if the source and destination areas have different sizes, like
+ *				\ref ei_copy_surface, 0 otherwise.
+ */
+int ei_record_copy(ei_surface_t destination, const ei_rect_t* dst_rect, ei_surface_t source,
+                   const ei_rect_t* src_rect, ei_bool_t alpha);
+
+/**
+ * \brief	Records \ref ei_skin_draw, \ref ei_skin_draw_mask and \ref ei_skin_draw_with_pick.
+ *
+ * @param	surface		Where the skin is drawn.
+ * @param	skin		The skin.
+ * @param	rect		Where to draw the skin.
+ * @param	mask_color	The color of the shape for \ref ei_skin_draw_mask, NULL otherwise.
+ * @param	pick_surface	The picking offscreen for \ref ei_skin_draw_with_pick, NULL otherwise.
+ * @param	pick_color	The pick color for \ref ei_skin_draw_with_pick.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_record_skin(ei_surface_t surface, const struct ei_skin_t* skin, const ei_rect_t* rect,
+                    const ei_color_t* mask_color, ei_surface_t pick_surface, const ei_color_t* pick_color,
+                    const ei_rect_t* clipper);
+
+#endif //EI_RECORD_H
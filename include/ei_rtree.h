@@ -0,0 +1,105 @@
+#ifndef EI_RTREE_H
+#define EI_RTREE_H
+
+#include <stddef.h>
+#include "ei_types.h"
+
+#define EI_RTREE_MAX_ENTRIES	16	///< The maximum number of entries of a node.
+#define EI_RTREE_MIN_ENTRIES	6	///< The minimum number of entries of a node, except the root.
+
+/**
+ * \brief	A rectangle of an R-tree, as its bounds: x0 and y0 included, x1 and y1 excluded.
+ */
+typedef struct ei_rtree_box_t {
+        int x0, y0, x1, y1;
+} ei_rtree_box_t;
+
+/**
+ * \brief	A node of an R-tree. The entries of a leaf are the data stored in the tree, the
+ *		entries of the other nodes are their children. Each entry has the box of all
+ *		that it contains.
+ */
+typedef struct ei_rtree_node_t {
+        ei_bool_t leaf;
+        int count;                      ///< The number of entries.
+        ei_rtree_box_t boxes[EI_RTREE_MAX_ENTRIES + 1];
+        void* entries[EI_RTREE_MAX_ENTRIES + 1];        ///< One more to split a node that overflows.
+        struct ei_rtree_node_t* parent;
+} ei_rtree_node_t;
+
+/**
+ * \brief	A spatial index: data stored with a rectangle, found from the rectangles they
+ *		intersect in a time proportional to the number of data found, not to the size of
+ *		the tree.
+ */
+typedef struct ei_rtree_t {
+        ei_rtree_node_t* root;
+        size_t count;                   ///< The number of data in the tree.
+} ei_rtree_t;
+
+/**
+ * \brief	A function called for each data found by \ref ei_rtree_search.
+ *
+ * @param	data		The data.
+ * @param	rect		Its rectangle.
+ * @param	user_param	The parameter given to \ref ei_rtree_search.
+ */
+typedef void (*ei_rtree_visit_t) (void* data, const ei_rect_t* rect, void* user_param);
+
+/**
+ * \brief	Creates an empty R-tree.
+ *
+ * @return			The tree, to release with \ref ei_rtree_free.
+ */
+ei_rtree_t* ei_rtree_create(void);
+
+/**
+ * \brief	Releases an R-tree. The data stored in it are not released.
+ *
+ * @param	tree		The tree.
+ */
+void ei_rtree_free(ei_rtree_t* tree);
+
+/**
+ * \brief	Stores a data in an R-tree.
+ *
+ * @param	tree		The tree.
+ * @param	rect		The rectangle of the data. Empty rectangles are never found.
+ * @param	data		The data.
+ */
+void ei_rtree_insert(ei_rtree_t* tree, const ei_rect_t* rect, void* data);
+
+/**
+ * \brief	Removes a data from an R-tree.
+ *
+ * @param	tree		The tree.
+ * @param	rect		The rectangle the data was inserted with.
+ * @param	data		The data.
+ *
+ * @return			EI_FALSE if the data was not found.
+ */
+ei_bool_t ei_rtree_remove(ei_rtree_t* tree, const ei_rect_t* rect, void* data);
+
+/**
+ * \brief	Finds the data of an R-tree which rectangle intersects a rectangle. The data are
+ *		found in no particular order.
+ *
+ * @param	tree		The tree.
+ * @param	rect		The rectangle.
+ * @param	visit		The function called for each data found.
+ * @param	user_param	A parameter passed to visit.
+ *
+ * @return			The number of data found.
+ */
+size_t ei_rtree_search(const ei_rtree_t* tree, const ei_rect_t* rect, ei_rtree_visit_t visit, void* user_param);
+
+/**
+ * \brief	Returns the rectangle that contains all the data of an R-tree.
+ *
+ * @param	tree		The tree.
+ *
+ * @return			The rectangle, empty if the tree is.
+ */
+ei_rect_t ei_rtree_get_bounds(const ei_rtree_t* tree);
+
+#endif //EI_RTREE_H
@@ -0,0 +1,83 @@
+#ifndef EI_SCROLLFRAME_H
+#define EI_SCROLLFRAME_H
+
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_event.h"
+#include "ei_occlusion.h"
+#include "ei_types.h"
+#include "ei_widget.h"
+#include "ei_widgetclass.h"
+
+/**
+ * \brief	A viewport over a content larger than itself. The children are placed in the
+ *		content, and only the part of it under the viewport is visible.
+ *
+ *		Scrolling moves the pixels already drawn instead of drawing the viewport again:
+ *		only the strip of content that comes into view is drawn.
+ */
+typedef struct ei_scrollframe_t {
+        ei_widget_t widget;
+        ei_color_t* color;
+        ei_size_t* content_size;
+        ei_point_t scroll;              ///< The point of the content at the top left of the viewport.
+        ei_point_t grab;                ///< Where the mouse was when dragging the content.
+        ei_rect_t content_data;         ///< The content, in the root window coordinates.
+} ei_scrollframe_t;
+
+extern ei_widgetclass_t scrollframeclass;
+
+/**
+ * @brief	Configures the attributes of widgets of the class "scrollframe".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for the viewport. Defaults to the size of the content.
+ * @param	color		The color of the background of the content. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	content_size	The size of the content where the children are placed. It is never
+ *				smaller than the viewport. Defaults to 0x0.
+ */
+void ei_scrollframe_configure (ei_widget_t* widget,
+                               ei_size_t* requested_size,
+                               const ei_color_t* color,
+                               ei_size_t* content_size);
+
+/**
+ * \brief	Scrolls a scrollframe so that a point of its content is at the top left of the
+ *		viewport. The point is clamped so that the viewport stays inside the content.
+ *
+ * @param	widget		The scrollframe.
+ * @param	x, y		The point of the content.
+ */
+void ei_scrollframe_scroll_to(ei_widget_t* widget, int x, int y);
+
+/**
+ * \brief	Scrolls a scrollframe by an offset, see \ref ei_scrollframe_scroll_to.
+ *
+ * @param	widget		The scrollframe.
+ * @param	dx, dy		The offset, positive to show the right and bottom of the content.
+ */
+void ei_scrollframe_scroll_by(ei_widget_t* widget, int dx, int dy);
+
+/**
+ * \brief	Returns the point of the content of a scrollframe at the top left of its viewport.
+ *
+ * @param	widget		The scrollframe.
+ *
+ * @return			The point, relative to the top left of the content.
+ */
+ei_point_t ei_scrollframe_get_scroll(ei_widget_t* widget);
+
+/**
+ * \brief	Tells which part of a scrollframe is opaque: all of its viewport.
+ *
+ * @param	widget		The scrollframe.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t scrollframe_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
+#endif //EI_SCROLLFRAME_H
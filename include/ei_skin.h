@@ -0,0 +1,113 @@
+#ifndef EI_SKIN_H
+#define EI_SKIN_H
+
+#include "ei_types.h"
+#include "hw_interface.h"
+
+#define EI_SKIN_CACHE_MAX	256	///< The least recently used skins are released above this count.
+
+/**
+ * \brief	The description of a relief, which identifies a skin in the cache.
+ */
+typedef struct ei_skin_key_t {
+        ei_color_t color;               ///< The face color of the relief.
+        int border_width;               ///< The width of the relief border.
+        int corner_radius;              ///< The radius of the rounded corners, 0 if not rounded.
+        ei_relief_t relief;             ///< The kind of relief.
+        ei_bool_t rounded;              ///< Button-like (polygons) or frame-like (bars) relief.
+} ei_skin_key_t;
+
+/**
+ * \brief	A pre-rendered relief: a small nine-slice bitmap that can be stretched to any
+ *		widget size. The bitmap is (2 * corner + 2) pixels wide and high: the four corner
+ *		squares are blitted as they are, a middle row and column are repeated to draw
+ *		the edges and the face.
+ */
+typedef struct ei_skin_t {
+        ei_skin_key_t key;              ///< The relief drawn by the skin.
+        int corner;                     ///< Size of the corner squares of the nine-slice.
+        int side;                       ///< Width and height of the bitmap.
+        ei_surface_t bitmap;            ///< The rendered relief, transparent outside the shape.
+        uint32_t hash;                  ///< The hash of the key.
+        struct ei_skin_t* next;         ///< Next skin of the same bucket of the cache.
+        struct ei_skin_t* older;        ///< Skin of the cache used less recently.
+        struct ei_skin_t* newer;        ///< Skin of the cache used more recently.
+} ei_skin_t;
+
+/**
+ * \brief	Returns the skin matching a relief description, rendering it the first time
+ *		it is requested.
+ *
+ * @param	color		The face color.
+ * @param	border_width	The width of the relief border.
+ * @param	corner_radius	The radius of the rounded corners (ignored for frame-like reliefs).
+ * @param	relief		The kind of relief.
+ * @param	rounded		If true, the relief is drawn like a button: rounded corners and
+ *				light and dark parts split along the diagonal. If false, it is drawn
+ *				like a frame: light top and left bars, dark bottom and right bars.
+ *
+ * @return			The cached skin. It is owned by the cache and must not be freed. It
+ *				stays valid until the next call, which may release the least
+ *				recently used skins: it must not be kept.
+ */
+ei_skin_t* ei_skin_get(const ei_color_t* color, int border_width, int corner_radius,
+                       ei_relief_t relief, ei_bool_t rounded);
+
+/**
+ * \brief	Tells if a skin can be stretched to a rectangle, i.e. if the rectangle is at
+ *		least as big as the nine-slice bitmap.
+ *
+ * @param	skin		The skin.
+ * @param	rect		The rectangle where the skin would be drawn.
+ *
+ * @return			EI_TRUE if \ref ei_skin_draw can be used for this rectangle.
+ */
+ei_bool_t ei_skin_fits(const ei_skin_t* skin, const ei_rect_t* rect);
+
+/**
+ * \brief	Draws a skin stretched to a rectangle: corner blits, edge and face span fills.
+ *
+ * @param	surface		Where to draw. The surface must be *locked* by \ref hw_surface_lock
+ *				and have the channel ordering of the root surface.
+ * @param	skin		The skin to draw.
+ * @param	rect		Where to draw the skin, must satisfy \ref ei_skin_fits.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_skin_draw(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                  const ei_rect_t* clipper);
+
+/**
+ * \brief	Fills the shape of a skin with a single color, e.g. in the picking surface.
+ *
+ * @param	surface		Where to draw. The surface must be *locked* by \ref hw_surface_lock,
+ *				or be the picking offscreen.
+ * @param	skin		The skin which shape is used.
+ * @param	rect		Where to draw the shape, must satisfy \ref ei_skin_fits.
+ * @param	color		The color of the shape.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_skin_draw_mask(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                       const ei_color_t* color, const ei_rect_t* clipper);
+
+/**
+ * \brief	Draws a skin stretched to a rectangle like \ref ei_skin_draw, and fills its shape
+ *		in the picking offscreen like \ref ei_skin_draw_mask, in one pass over the rows.
+ *
+ * @param	surface		Where to draw. The surface must be *locked* by \ref hw_surface_lock
+ *				and have the channel ordering of the root surface.
+ * @param	skin		The skin to draw.
+ * @param	rect		Where to draw the skin, must satisfy \ref ei_skin_fits.
+ * @param	pick_surface	The picking offscreen, or NULL to only draw in surface.
+ * @param	pick_color	The pick color of the widget, which encodes its pick ID.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_skin_draw_with_pick(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                            ei_surface_t pick_surface, const ei_color_t* pick_color,
+                            const ei_rect_t* clipper);
+
+/**
+ * \brief	Releases all the skins of the cache.
+ */
+void ei_skin_cache_free(void);
+
+#endif //EI_SKIN_H
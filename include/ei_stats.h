@@ -0,0 +1,77 @@
+#ifndef EI_STATS_H
+#define EI_STATS_H
+
+#include <stddef.h>
+
+/**
+ * \brief	Counters of the work done by the library. They are always counted: each one
+ *		only costs an addition where the work is done.
+ */
+typedef struct ei_stats_t {
+        unsigned long pixels_filled;    ///< Pixels written by \ref ei_fill.
+        unsigned long pixels_copied;    ///< Pixels copied as they are by \ref ei_copy_surface.
+        unsigned long pixels_blended;   ///< Pixels blended with the pixels below them.
+        unsigned long polygons;         ///< Polygons rasterized by \ref ei_draw_polygon.
+        unsigned long polygon_edges;    ///< Sides of these polygons that were not horizontal.
+        unsigned long polyline_pixels;  ///< Pixels written by \ref ei_draw_polyline.
+        unsigned long text_surfaces;    ///< Surfaces created by \ref hw_text_create_surface.
+        unsigned long surfaces_created; ///< Surfaces created by \ref hw_surface_create.
+        unsigned long mallocs;          ///< Blocks of memory allocated by the library.
+        unsigned long widgets_recorded; ///< Draw functions of widgets recorded, see \ref ei_record_draw.
+        unsigned long commands_replayed;        ///< Recorded drawing commands drawn again.
+} ei_stats_t;
+
+/**
+ * \brief	The counters of the frame being drawn. The library adds to them directly: read
+ *		them with \ref ei_stats_get_frame or \ref ei_stats_get_total instead.
+ */
+extern ei_stats_t ei_stats;
+
+/**
+ * \brief	Returns the counters of the last frame: the work done since the frame before it
+ *		was drawn, including the events handled in-between.
+ *
+ * @param	stats		Where to store the counters.
+ */
+void ei_stats_get_frame(ei_stats_t* stats);
+
+/**
+ * \brief	Returns the counters since the last call to \ref ei_stats_reset, or since the
+ *		start of the program.
+ *
+ * @param	stats		Where to store the counters.
+ */
+void ei_stats_get_total(ei_stats_t* stats);
+
+/**
+ * \brief	Sets all the counters to 0, both the total and the ones of the last frame.
+ */
+void ei_stats_reset(void);
+
+/**
+ * \brief	Ends the counting of a frame. Called by the main loop after each frame is drawn.
+ */
+void ei_stats_frame_done(void);
+
+/**
+ * \brief	Allocates memory like malloc, and counts the allocation. Used by the library
+ *		instead of malloc.
+ *
+ * @param	size		The number of bytes to allocate.
+ *
+ * @return			The memory, to release with free.
+ */
+void* ei_malloc(size_t size);
+
+/**
+ * \brief	Allocates memory set to 0 like calloc, and counts the allocation. Used by the
+ *		library instead of calloc.
+ *
+ * @param	count		The number of elements.
+ * @param	size		The size of an element.
+ *
+ * @return			The memory, to release with free.
+ */
+void* ei_calloc(size_t count, size_t size);
+
+#endif //EI_STATS_H
@@ -1,7 +1,9 @@
 #ifndef EI_TOOLS_H
 #define EI_TOOLS_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include "ei_stats.h"
 #include "ei_types.h"
 #include "hw_interface.h"
 
@@ -61,4 +63,27 @@ uint32_t  color_to_id(ei_color_t color);
  */
 void free_linked_points(ei_linked_point_t* point);
 
+/**
+ * \brief	Copies a value into a field of a widget, only if it is given and different.
+ *
+ * @param	field    	The field to update.
+ * @param	value    	The new value, or NULL to keep the current one.
+ * @param	size     	The size of the field, in bytes.
+ *
+ * @return	        	EI_TRUE if the field has changed.
+ */
+ei_bool_t update_field(void* field, const void* value, size_t size);
+
+/**
+ * \brief	Replaces the text of a widget by a copy of a new text, only if it is given and
+ *		different.
+ *
+ * @param	field    	The text of the widget, allocated with malloc, or NULL.
+ * @param	text     	A pointer to the new text (which can be NULL), or NULL to keep the
+ *				current one.
+ *
+ * @return	        	EI_TRUE if the text has changed.
+ */
+ei_bool_t update_text(char** field, char** text);
+
 #endif //EI_TOOLS_H
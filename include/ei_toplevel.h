@@ -5,6 +5,7 @@
 #include "ei_application.h"
 #include "ei_drawing_tools.h"
 #include "ei_event.h"
+#include "ei_occlusion.h"
 #include "ei_placer.h"
 #include "ei_types.h"
 #include "ei_widget.h"
@@ -19,8 +20,31 @@ typedef struct ei_toplevel_t {
         ei_bool_t *closable;
         ei_axis_set_t *resizable;
         ei_size_t **min_size;
+        ei_rect_t content_data;
 } ei_toplevel_t;
 
 extern ei_widgetclass_t toplevelclass;
 
+/**
+ * \brief	Tells which part of a toplevel is opaque: its border and content, the rounded
+ *		title bar is left out.
+ *
+ * @param	widget		The toplevel.
+ * @param	opaque		Where to store the opaque rectangle.
+ *
+ * @return			Always EI_TRUE.
+ */
+ei_bool_t toplevel_opaque(ei_widget_t* widget, ei_rect_t* opaque);
+
+/**
+ * \brief	Returns the resize icon of a toplevel, drawn over the bottom right corner of
+ *		its content.
+ *
+ * @param	widget		The toplevel.
+ * @param	rect		Where to store the rectangle of the icon.
+ *
+ * @return			EI_FALSE if the toplevel is not resizable, and has no icon.
+ */
+ei_bool_t ei_toplevel_resize_rect(ei_widget_t* widget, ei_rect_t* rect);
+
 #endif //EI_TOPLEVEL_H
@@ -0,0 +1,82 @@
+#ifndef EI_TRACE_H
+#define EI_TRACE_H
+
+#include "ei_types.h"
+
+/**
+ * \brief	EI_TRUE while spans are recorded. Read by \ref ei_trace_begin and \ref ei_trace_end,
+ *		so that they only cost a test when the recording is off: use
+ *		\ref ei_trace_set_enabled to change it.
+ */
+extern ei_bool_t ei_trace_enabled;
+
+/**
+ * \brief	Records the beginning or the end of a span in the trace ring buffer. Use
+ *		\ref ei_trace_begin and \ref ei_trace_end instead.
+ *
+ * @param	name		The name of the span. Must stay valid until the trace is exported.
+ * @param	phase		'B' for the beginning of the span, 'E' for its end.
+ */
+void ei_trace_record(const char* name, char phase);
+
+/**
+ * \brief	Starts or stops the recording of spans. The recording is off by default.
+ *
+ * @param	enabled		EI_TRUE to record the spans.
+ */
+void ei_trace_set_enabled(ei_bool_t enabled);
+
+/**
+ * \brief	Marks the beginning of a span, if the recording is on.
+ *
+ * @param	name		The name of the span, usually a string literal.
+ */
+static inline void ei_trace_begin(const char* name)
+{
+	if (ei_trace_enabled) ei_trace_record(name, 'B');
+}
+
+/**
+ * \brief	Marks the end of the span started by the last \ref ei_trace_begin with the same
+ *		name, if the recording is on.
+ *
+ * @param	name		The name of the span.
+ */
+static inline void ei_trace_end(const char* name)
+{
+	if (ei_trace_enabled) ei_trace_record(name, 'E');
+}
+
+/**
+ * \brief	Writes the recorded spans as a Chrome trace (JSON "traceEvents" format), which can
+ *		be opened in chrome://tracing or in Perfetto. Only the most recent spans are kept
+ *		in the ring buffer.
+ *
+ * @param	path		The file to write.
+ *
+ * @return			EI_FALSE if the file could not be written.
+ */
+ei_bool_t ei_trace_export(const char* path);
+
+/**
+ * \brief	Exports the trace when the program exits.
+ *
+ * @param	path		The file to write. Must stay valid until the program exits.
+ */
+void ei_trace_export_at_exit(const char* path);
+
+/**
+ * \brief	Exports the trace each time a signal is received (for example SIGUSR1). The file
+ *		is written by the main loop, in the iteration that follows the signal.
+ *
+ * @param	signum		The signal.
+ * @param	path		The file to write. Must stay valid until the program exits.
+ */
+void ei_trace_export_on_signal(int signum, const char* path);
+
+/**
+ * \brief	Writes the trace if a signal asked for it. Called by \ref ei_app_step.
+ */
+void ei_trace_poll(void);
+
+#endif //EI_TRACE_H
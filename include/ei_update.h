@@ -0,0 +1,35 @@
+#ifndef EI_UPDATE_H
+#define EI_UPDATE_H
+
+#include "ei_application.h"
+#include "ei_event.h"
+
+/**
+ * \brief	Applies all the updates posted by \ref ei_app_post_update, in the order they were
+ *		posted, except the superseded ones. Called by \ref ei_app_step before drawing.
+ */
+void ei_update_run(void);
+
+/**
+ * \brief	Tells if some updates are waiting to be applied.
+ *
+ * @return			EI_TRUE if at least one update is queued.
+ */
+ei_bool_t ei_update_pending(void);
+
+/**
+ * \brief	Tells if an event is the one posted to wake up the main loop when updates are
+ *		posted. It must not be given to the widgets.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event wakes up the main loop for the updates.
+ */
+ei_bool_t ei_update_is_wakeup(ei_event_t* event);
+
+/**
+ * \brief	Releases the pending updates: they are all called as superseded.
+ */
+void ei_update_free(void);
+
+#endif //EI_UPDATE_H
@@ -109,6 +109,103 @@ void			ei_widget_destroy		(ei_widget_t*		widget);
 ei_widget_t*		ei_widget_pick			(ei_point_t*		where);
 
 
+/**
+ * @brief	Tells the application that the appearance of a widget has changed: only the
+ *		visible part of its screen location is redrawn, not the whole parent.
+ *
+ * @param	widget		The widget whose appearance has changed.
+ */
+void			ei_widget_invalidate		(ei_widget_t*		widget);
+
+/**
+ * @brief	Tells the application that a part of a widget has changed, e.g. a cell of a grid:
+ *		only this part is redrawn, where the widget is visible.
+ *
+ * @param	widget		The widget whose appearance has changed.
+ * @param	rect		The part of the widget, in the root window coordinates.
+ */
+void			ei_widget_invalidate_rect	(ei_widget_t*		widget,
+							 const ei_rect_t*	rect);
+
+/**
+ * @brief	Moves the pixels of a part of a widget already on screen, e.g. to scroll its
+ *		content, where they are visible. Only the rest of the part must then be redrawn.
+ *		When other widgets are drawn over the part, it is redrawn instead.
+ *
+ * @param	widget		The widget whose appearance has changed.
+ * @param	rect		The part of the widget, in the root window coordinates.
+ * @param	dx, dy		The offset of the pixels.
+ */
+void			ei_widget_scroll_rect		(ei_widget_t*		widget,
+							 const ei_rect_t*	rect,
+							 int			dx,
+							 int			dy);
+
+/**
+ * @brief	Returns the rectangle where a widget draws: its screen location, and the
+ *		decorations around it for a toplevel.
+ *
+ * @param	widget		The widget, placed by its geometry manager.
+ *
+ * @return			The rectangle, in the root window coordinates.
+ */
+ei_rect_t		ei_widget_outer_rect		(ei_widget_t*		widget);
+
+/**
+ * @brief	Puts a widget above its siblings: it is drawn after them, and picked where they
+ *		overlap. Takes a constant time, whatever the number of siblings.
+ *
+ * @param	widget		The widget. Nothing is done for the root widget.
+ */
+void			ei_widget_raise			(ei_widget_t*		widget);
+
+/**
+ * @brief	Puts a widget below its siblings: it is drawn before them, and they are picked
+ *		where they overlap. Takes a constant time, whatever the number of siblings.
+ *
+ * @param	widget		The widget. Nothing is done for the root widget.
+ */
+void			ei_widget_lower			(ei_widget_t*		widget);
+
+/**
+ * @brief	Releases the table of the previous siblings. Called when the application is
+ *		released, after the widgets.
+ */
+void			ei_widget_siblings_free		(void);
+
+/**
+ * @brief	Ends a configure function of a widget class: redraws the widget if it has changed,
+ *		or counts the call as elided if nothing has changed.
+ *
+ *		When the requested size has changed, the placer may move the widget and its
+ *		siblings, so the parent is redrawn. It is also the case for a toplevel, whose
+ *		decorations are outside of its screen location.
+ *
+ * @param	widget			The configured widget.
+ * @param	changed			EI_TRUE if an attribute of the widget has changed.
+ * @param	old_requested_size	The requested size of the widget before the call.
+ */
+void			ei_widget_configured		(ei_widget_t*		widget,
+							 ei_bool_t		changed,
+							 ei_size_t		old_requested_size);
+
+/**
+ * @brief	Returns the number of calls to the configure functions since the application
+ *		was started.
+ *
+ * @return			The number of calls.
+ */
+unsigned long		ei_widget_configure_count	(void);
+
+/**
+ * @brief	Returns the number of calls to the configure functions which have been elided
+ *		because they did not change anything: nothing was copied nor redrawn.
+ *
+ * @return			The number of elided calls.
+ */
+unsigned long		ei_widget_configure_elided_count(void);
+
+
 
 
 /**
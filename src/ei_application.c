@@ -1,16 +1,45 @@
+#include <string.h>
 #include "ei_application.h"
+#include "ei_arena.h"
 #include "ei_button.h"
+#include "ei_canvas.h"
+#include "ei_chart.h"
+#include "ei_console.h"
 #include "ei_event.h"
+#include "ei_flash.h"
 #include "ei_frame.h"
+#include "ei_grid.h"
+#include "ei_hud.h"
+#include "ei_idle.h"
+#include "ei_occlusion.h"
+#include "ei_overdraw.h"
 #include "ei_picking.h"
 #include "ei_placer.h"
+#include "ei_record.h"
+#include "ei_scrollframe.h"
+#include "ei_skin.h"
+#include "ei_stats.h"
 #include "ei_toplevel.h"
+#include "ei_trace.h"
+#include "ei_update.h"
+
+#define WAKEUP_TOKENS 256                       // Steps before a wakeup token is used again
 
 static ei_surface_t *root_surface = NULL;
 static ei_widget_t *root_widget = NULL;
 static ei_surface_t *picking_surface = NULL;
 static ei_bool_t quit_request = EI_FALSE;
 static ei_linked_rect_t *invalidate_list = NULL;
+static ei_linked_rect_t *invalidate_tail = NULL;        // Last rectangle of invalidate_list
+static ei_linked_rect_t *moved_list = NULL;             // Rectangles scrolled in place, only updated on screen
+static int batch_depth = 0;                             // Number of nested batches
+static ei_bool_t batch_damaged = EI_FALSE;
+static ei_rect_t batch_damage;                          // Union of the rectangles invalidated in the batch
+static ei_bool_t first_step = EI_TRUE;
+static ei_bool_t drain_posted = EI_FALSE;               // The drain marker is in the event queue
+static char wakeup_markers[WAKEUP_TOKENS];             // Parameters of the events that end the wait of a step
+static unsigned int wakeup_sequence = 0;                // Number of wakeups scheduled, gives each its token
+static char drain_marker;                               // Parameter of the event posted after the ready events
 
 /**
  * \brief	Creates an application.
@@ -38,6 +67,28 @@ void ei_app_create(ei_size_t main_window_size, ei_bool_t fullscreen)
         ei_widgetclass_register(&frameclass);
         ei_widgetclass_register(&buttonclass);
         ei_widgetclass_register(&toplevelclass);
+        ei_widgetclass_register(&gridclass);
+        ei_widgetclass_register(&scrollframeclass);
+        ei_widgetclass_register(&canvasclass);
+        ei_widgetclass_register(&chartclass);
+        ei_widgetclass_register(&consoleclass);
+
+        // Declare the opaque parts of the widgets, used to skip hidden widgets while drawing
+        ei_occlusion_register(&frameclass, &frame_opaque);
+        ei_occlusion_register(&buttonclass, &button_opaque);
+        ei_occlusion_register(&toplevelclass, &toplevel_opaque);
+        ei_occlusion_register(&gridclass, &grid_opaque);
+        ei_occlusion_register(&scrollframeclass, &scrollframe_opaque);
+        ei_occlusion_register(&canvasclass, &canvas_opaque);
+        ei_occlusion_register(&chartclass, &chart_opaque);
+        ei_occlusion_register(&consoleclass, &console_opaque);
+
+        // Declare the classes whose drawings are recorded and replayed on repaint. The
+        // others redraw parts of their widgets themselves, a record would be drawn over
+        // the whole parent content for nothing
+        ei_record_register(&frameclass);
+        ei_record_register(&buttonclass);
+        ei_record_register(&toplevelclass);
 
         // Create the root window
         root_surface = hw_create_window(main_window_size, fullscreen);
@@ -46,8 +97,8 @@ void ei_app_create(ei_size_t main_window_size, ei_bool_t fullscreen)
         root_widget = ei_widget_create("frame", NULL, NULL, NULL);
         root_widget->screen_location = hw_surface_get_rect(root_surface);
 
-        // Create an offscreen surface for the picking
-        ei_picking_set_picking_surface(hw_surface_create(root_surface, main_window_size, EI_TRUE));
+        // Create the offscreen of pick IDs
+        ei_picking_create(hw_surface_get_size(root_surface));
         picking_surface = ei_picking_get_picking_surface();
 }
 
@@ -57,76 +108,234 @@ void ei_app_create(ei_size_t main_window_size, ei_bool_t fullscreen)
  */
 void ei_app_free(void)
 {
-        ei_linked_rect_t *to_free = invalidate_list;
-        ei_linked_rect_t *temp = NULL;
-        while (to_free) {
-                temp = to_free->next;
-                free(to_free);
-                to_free = temp;
-        }
+        invalidate_list = NULL;
+        invalidate_tail = NULL;
+        moved_list = NULL;
+        first_step = EI_TRUE;
+        drain_posted = EI_FALSE;
+        ei_update_free();
         ei_widget_destroy(root_widget);
+        ei_widget_siblings_free();
+        ei_record_free();
         hw_surface_free(root_surface);
-        hw_surface_free(picking_surface);
+        ei_picking_free();
+        picking_surface = NULL;
+        ei_skin_cache_free();
+        ei_idle_free();
+        ei_hud_free();
+        ei_flash_free();
+        ei_overdraw_free();
+        ei_occlusion_unregister_all();
+        ei_record_unregister_all();
+        free_polygon_offscreen();
+        ei_arena_free();
         hw_quit();
 }
 
 /**
- * \brief	Runs the application: enters the main event loop. Exits when
- *		\ref ei_app_quit_request is called.
+ * @brief	Draws the invalidated rectangles and updates them on screen, then releases them
+ *		with all the drawing data of the frame.
  */
-void ei_app_run(void)
+static void draw_invalidated(void)
 {
-        ei_event_t *event = calloc(1, sizeof(ei_event_t));
-        ei_widget_t *active_widget = NULL;
-        ei_default_handle_func_t default_handle_func = ei_event_get_default_handle_func();
-        ei_bool_t handled = EI_FALSE;
-        ei_linked_rect_t *first_inv_rect = calloc(1, sizeof(ei_linked_rect_t));
-        first_inv_rect->rect = root_widget->screen_location;
-        first_inv_rect->next = NULL;
-        invalidate_list = first_inv_rect;
-
-        while (!quit_request) {
-                if (invalidate_list != NULL) {
-                        hw_surface_lock(root_surface);
-                        ei_linked_rect_t* curr_rect = invalidate_list;
-                        while (curr_rect != NULL) {
-                                root_widget->wclass->drawfunc(root_widget, root_surface, picking_surface,
-                                                              &curr_rect->rect);
-                                ei_widget_t *widget = root_widget->children_head;
-                                while (widget != NULL) {
-                                        ei_placer_run(widget);
-                                        widget->wclass->drawfunc(widget, root_surface, picking_surface,
-                                                                 &curr_rect->rect);
-                                        widget = widget->next_sibling;
-                                }
-                                curr_rect = curr_rect->next;
+        if (invalidate_list != NULL) {
+                ei_trace_begin("paint");
+                double start = hw_now();
+                hw_surface_lock(root_surface);
+                ei_overdraw_begin_frame();
+                ei_linked_rect_t* curr_rect = invalidate_list;
+                while (curr_rect != NULL) {
+                        ei_occlusion_t occlusion;
+                        ei_occlusion_compute(&occlusion, root_widget, &curr_rect->rect);
+                        // The root is only drawn where no opaque toplevel hides it
+                        ei_linked_rect_t *uncovered = occlusion.uncovered;
+                        while (uncovered != NULL) {
+                                ei_trace_begin(root_widget->wclass->name);
+                                ei_record_draw(root_widget, root_surface, picking_surface, &uncovered->rect);
+                                ei_trace_end(root_widget->wclass->name);
+                                uncovered = uncovered->next;
                         }
-                        hw_surface_unlock(root_surface);
-                        hw_surface_update_rects(root_surface, invalidate_list);
+                        ei_occlusion_draw_children(&occlusion, root_surface, picking_surface);
+                        curr_rect = curr_rect->next;
                 }
+                ei_hud_frame_done(invalidate_list, hw_now() - start);
+                ei_overdraw_end_frame(root_surface, invalidate_list);
+                ei_flash_draw(root_surface, invalidate_list);
 
-                ei_linked_rect_t *to_free = invalidate_list;
-                ei_linked_rect_t *temp = NULL;
-                while (to_free) {
-                        temp = to_free->next;
-                        free(to_free);
-                        to_free = temp;
+                // The overlay is drawn last, over the widgets, and only updates its own rectangle
+                ei_linked_rect_t *hud_rect = ei_arena_alloc(sizeof(ei_linked_rect_t));
+                if (ei_hud_draw(root_surface, &hud_rect->rect)) {
+                        invalidate_tail->next = hud_rect;
+                        invalidate_tail = hud_rect;
+                }
+                // The scrolled rectangles are not drawn again, but their pixels have changed
+                if (moved_list != NULL) {
+                        invalidate_tail->next = moved_list;
+                        while (invalidate_tail->next != NULL) invalidate_tail = invalidate_tail->next;
                 }
-                invalidate_list = NULL;
+                hw_surface_unlock(root_surface);
+                hw_surface_update_rects(root_surface, invalidate_list);
+                ei_stats_frame_done();
+                ei_trace_end("paint");
+        }
 
-                hw_event_wait_next(event);
+        // The invalidated rectangles and all the drawing data of the frame are released
+        invalidate_list = NULL;
+        invalidate_tail = NULL;
+        moved_list = NULL;
+        ei_arena_reset();
+}
 
-                if (event->type == ei_ev_mouse_buttondown) ei_event_set_active_widget(ei_widget_pick(&event->param.mouse.where));
+/**
+ * @brief	Sends an event to the active widget, or to the default handle function.
+ *
+ * @param	event		The event.
+ */
+static void dispatch_event(ei_event_t* event)
+{
+        ei_default_handle_func_t default_handle_func = ei_event_get_default_handle_func();
 
-                active_widget = ei_event_get_active_widget();
-                if (active_widget != NULL) {
-                        handled = active_widget->wclass->handlefunc(active_widget, event);
-                        if (!handled) default_handle_func(event);
-                } else if (default_handle_func != NULL) {
-                        default_handle_func(event);
-                }
+        // The updates it announces are applied by ei_app_step
+        if (ei_update_is_wakeup(event)) return;
+        if (ei_hud_handle_event(event)) return;
+        if (ei_flash_handle_event(event)) return;
+
+        // Picking reads the offscreen, which must be up to date with the previous events
+        if (event->type == ei_ev_mouse_buttondown) {
+                if (invalidate_list != NULL) draw_invalidated();
+                ei_event_set_active_widget(ei_widget_pick(&event->param.mouse.where));
+        }
+
+        ei_trace_begin("handlefunc");
+        ei_widget_t *active_widget = ei_event_get_active_widget();
+        if (active_widget != NULL) {
+                ei_bool_t handled = active_widget->wclass->handlefunc(active_widget, event);
+                if (!handled && default_handle_func != NULL) default_handle_func(event);
+        } else if (default_handle_func != NULL) {
+                default_handle_func(event);
+        }
+        ei_trace_end("handlefunc");
+}
+
+/**
+ * @brief	Tells if an event is one of the events used by \ref ei_app_step to wake up.
+ *
+ * @param	event		The event.
+ * @param	marker		The marker to look for.
+ *
+ * @return			EI_TRUE if the event carries this marker.
+ */
+static ei_bool_t is_marker(ei_event_t* event, char* marker)
+{
+        return (event->type == ei_ev_app && event->param.application.user_param == marker);
+}
+
+/**
+ * @brief	Tells if an event is a wakeup scheduled by \ref ei_app_step, by this step or by a
+ *		previous one.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event carries one of the wakeup tokens.
+ */
+static ei_bool_t is_wakeup(ei_event_t* event)
+{
+        if (event->type != ei_ev_app) return EI_FALSE;
+        char *param = event->param.application.user_param;
+        return (ei_bool_t) (param >= wakeup_markers && param < wakeup_markers + WAKEUP_TOKENS);
+}
+
+/**
+ * \brief	Runs one iteration of the main loop, for programs which have their own main loop:
+ *		waits for an event at most timeout_ms milliseconds, processes all the events
+ *		that are ready, then draws what has been invalidated. What has been invalidated
+ *		since the previous step is drawn before waiting. The idle tasks run last, within
+ *		their budget: the step does not wait for an event while some are queued.
+ *
+ * @param	timeout_ms	The maximal time to wait for an event, in milliseconds. 0 only
+ *				processes the events that are already there, a negative value
+ *				waits until an event arrives.
+ *
+ * @return			\ref ei_step_quit if \ref ei_app_quit_request has been called,
+ *				\ref ei_step_pending if some work is left that does not need
+ *				to wait for an event, \ref ei_step_idle otherwise.
+ */
+ei_step_status_t ei_app_step(int timeout_ms)
+{
+        ei_event_t event;
+
+        // The first frame draws the whole window at once, whatever has been created before
+        if (first_step) {
+                ei_linked_rect_t *first_inv_rect = ei_arena_alloc(sizeof(ei_linked_rect_t));
+                first_inv_rect->rect = root_widget->screen_location;
+                first_inv_rect->next = NULL;
+                invalidate_list = first_inv_rect;
+                invalidate_tail = first_inv_rect;
+                first_step = EI_FALSE;
+        }
+        if (quit_request) return ei_step_quit;
+        ei_trace_poll();
+        ei_trace_begin("ei_app_step");
+        draw_invalidated();
+
+        // Updates and idle tasks only wait for the events that are ready
+        if (ei_update_pending() || ei_idle_pending()) timeout_ms = 0;
+
+        if (!drain_posted && timeout_ms != 0) {
+                // The hardware layer can not wait with a timeout: an event is scheduled to wake
+                // up, with a token of its own, as the timer is less precise than hw_now
+                double deadline = hw_now() + timeout_ms / 1000.0;
+                char *token = &wakeup_markers[wakeup_sequence++ % WAKEUP_TOKENS];
+                if (timeout_ms > 0) hw_event_schedule_app(timeout_ms, token);
+                ei_trace_begin("wait");
+                do {
+                        hw_event_wait_next(&event);
+                        // A wakeup scheduled by a previous step that ended sooner is ignored
+                } while (is_wakeup(&event) && event.param.application.user_param != token &&
+                         (timeout_ms < 0 || hw_now() < deadline));
+                ei_trace_end("wait");
+                if (!is_wakeup(&event)) dispatch_event(&event);
+        }
+
+        // Every event posted before the drain marker was ready: they are processed without waiting
+        if (!drain_posted) {
+                hw_event_post_app(&drain_marker);
+                drain_posted = EI_TRUE;
+        }
+        while (drain_posted && !quit_request) {
+                hw_event_wait_next(&event);
+                if (is_marker(&event, &drain_marker)) drain_posted = EI_FALSE;
+                else if (!is_wakeup(&event)) dispatch_event(&event);
         }
-        free(event);
+
+        // Updates posted by other threads are applied at once, and drawn in the same frame
+        if (!quit_request) {
+                ei_trace_begin("ei_update_run");
+                ei_update_run();
+                ei_trace_end("ei_update_run");
+        }
+        draw_invalidated();
+
+        // What the idle tasks invalidate is drawn at the beginning of the next step
+        if (!quit_request) {
+                ei_trace_begin("ei_idle_run");
+                ei_idle_run();
+                ei_trace_end("ei_idle_run");
+        }
+        ei_trace_end("ei_app_step");
+
+        if (quit_request) return ei_step_quit;
+        return (invalidate_list != NULL || ei_update_pending() || ei_idle_pending()) ?
+               ei_step_pending : ei_step_idle;
+}
+
+/**
+ * \brief	Runs the application: enters the main event loop. Exits when
+ *		\ref ei_app_quit_request is called.
+ */
+void ei_app_run(void)
+{
+        while (ei_app_step(-1) != ei_step_quit);
 }
 
 /**
@@ -136,24 +345,153 @@ void ei_app_run(void)
  * @param	rect		The rectangle to add, expressed in the root window coordinates.
  *				A copy is made, so it is safe to release the rectangle on return.
  */
-void ei_app_invalidate_rect(ei_rect_t* rect)
+void (ei_app_invalidate_rect)(ei_rect_t* rect)
+{
+        // Only reached by code compiled without the macro of ei_application.h
+        ei_app_invalidate_rect_at(rect, NULL, 0);
+}
+
+/**
+ * \brief	Same as \ref ei_app_invalidate_rect, also given the place of the call in the source,
+ *		which is logged in the repaint flash mode (see \ref ei_flash_set_enabled).
+ *
+ * @param	rect		The rectangle to add, expressed in the root window coordinates.
+ * @param	file, line	Where the rectangle is invalidated, or NULL and 0 if unknown.
+ */
+void ei_app_invalidate_rect_at(ei_rect_t* rect, const char* file, int line)
 {
         if (rect->size.height == 0 && rect->size.width == 0) return;
         ei_rect_t inside_rect = rectangle_intersect(root_widget->content_rect,rect);
         if (inside_rect.size.height == 0 && inside_rect.size.width == 0) return;
-        ei_linked_rect_t *new_rect = calloc(1, sizeof(ei_linked_rect_t));
+        ei_flash_record(&inside_rect, file, line, batch_depth > 0);
+        if (batch_depth > 0) {
+                batch_damage = rectangle_union(batch_damaged ? &batch_damage : NULL, &inside_rect);
+                batch_damaged = EI_TRUE;
+                return;
+        }
+        ei_linked_rect_t *new_rect = ei_arena_alloc(sizeof(ei_linked_rect_t));
         new_rect->rect = inside_rect;
         if (invalidate_list == NULL) {
                 invalidate_list = new_rect;
         } else {
-                ei_linked_rect_t* explore = invalidate_list;
-                while (explore->next) {
-                        explore = explore->next;
+                invalidate_tail->next = new_rect;
+        }
+        invalidate_tail = new_rect;
+}
+
+/**
+ * \brief	Scrolls the content of a rectangle of the root window: the pixels already drawn,
+ *		and the picking offscreen, are moved in place, and only the strips that the move
+ *		exposes are invalidated. The widgets drawn in the rectangle must already have
+ *		moved by the same offset, and nothing must be drawn over the rectangle.
+ *
+ *		The whole rectangle is invalidated instead when it cannot be moved: in a batch,
+ *		before the first frame, when the offset is larger than the rectangle, or when a
+ *		debugging overlay is drawn over the widgets.
+ *
+ * @param	rect		The rectangle, expressed in the root window coordinates.
+ * @param	dx, dy		The offset of the content, in pixels.
+ */
+void ei_app_scroll_rect(const ei_rect_t* rect, int dx, int dy)
+{
+        ei_rect_t area = *rect;
+        area = rectangle_intersect(root_widget->content_rect, &area);
+        if (area.size.width <= 0 || area.size.height <= 0 || (dx == 0 && dy == 0)) return;
+        if (batch_depth > 0 || first_step || abs(dx) >= area.size.width || abs(dy) >= area.size.height ||
+            ei_hud_is_visible() || ei_flash_is_enabled() || ei_overdraw_enabled) {
+                ei_app_invalidate_rect(&area);
+                return;
+        }
+
+        hw_surface_lock(root_surface);
+        move_rect(root_surface, &area, dx, dy);
+        ei_picking_move(&area, dx, dy);
+        hw_surface_unlock(root_surface);
+
+        // The pixels not drawn yet are still wrong where they have been moved to. The pending
+        // rectangles inside the area move with them, the parts of those across its border are
+        // merged, so that many scrolls in a frame do not multiply the rectangles to draw.
+        ei_bool_t damaged = EI_FALSE;
+        ei_rect_t damage;
+        ei_linked_rect_t *prev = NULL;
+        ei_linked_rect_t *pending = invalidate_list;
+        while (pending != NULL) {
+                ei_linked_rect_t *next = pending->next;
+                ei_rect_t inside = rectangle_intersect(&area, &pending->rect);
+                if (inside.size.width <= 0 || inside.size.height <= 0) {
+                        prev = pending;
+                } else if (memcmp(&inside, &pending->rect, sizeof(ei_rect_t)) != 0) {
+                        damage = rectangle_union(damaged ? &damage : NULL, &inside);
+                        damaged = EI_TRUE;
+                        prev = pending;
+                } else {
+                        pending->rect.top_left.x += dx;
+                        pending->rect.top_left.y += dy;
+                        pending->rect = rectangle_intersect(&area, &pending->rect);
+                        if (pending->rect.size.width > 0 && pending->rect.size.height > 0) {
+                                prev = pending;
+                        } else {
+                                // Moved out of the area: nothing left to draw there
+                                if (prev != NULL) prev->next = next;
+                                else invalidate_list = next;
+                                if (invalidate_tail == pending) invalidate_tail = prev;
+                        }
                 }
-                explore->next = new_rect;
+                pending = next;
+        }
+        if (damaged) {
+                damage.top_left.x += dx;
+                damage.top_left.y += dy;
+                damage = rectangle_intersect(&area, &damage);
+                if (damage.size.width > 0 && damage.size.height > 0) ei_app_invalidate_rect(&damage);
+        }
+
+        if (moved_list == NULL || memcmp(&moved_list->rect, &area, sizeof(ei_rect_t)) != 0) {
+                ei_linked_rect_t *moved_rect = ei_arena_alloc(sizeof(ei_linked_rect_t));
+                moved_rect->rect = area;
+                moved_rect->next = moved_list;
+                moved_list = moved_rect;
+        }
+
+        // The strips of the rectangle which content comes from outside of it
+        if (dy != 0) {
+                ei_rect_t strip = area;
+                strip.size.height = abs(dy);
+                if (dy < 0) strip.top_left.y += area.size.height + dy;
+                ei_app_invalidate_rect(&strip);
+        }
+        if (dx != 0) {
+                ei_rect_t strip = area;
+                strip.size.width = abs(dx);
+                if (dx < 0) strip.top_left.x += area.size.width + dx;
+                ei_app_invalidate_rect(&strip);
         }
 }
 
+/**
+ * \brief	Starts a batch of changes to the widget tree, for example when creating or
+ *		destroying many widgets at once. Until the matching \ref ei_app_batch_commit,
+ *		the invalidated rectangles are merged instead of being added one by one to the
+ *		list of rectangles to update. Batches can be nested.
+ */
+void ei_app_batch_begin(void)
+{
+        batch_depth++;
+}
+
+/**
+ * \brief	Ends a batch started by \ref ei_app_batch_begin. When the outermost batch ends,
+ *		a single rectangle, which contains all the rectangles invalidated during the
+ *		batch, is added to the list of rectangles to update.
+ */
+void ei_app_batch_commit(void)
+{
+        if (batch_depth == 0) return;
+        if (--batch_depth > 0 || !batch_damaged) return;
+        batch_damaged = EI_FALSE;
+        ei_app_invalidate_rect(&batch_damage);
+}
+
 /**
  * \brief	Tells the application to quite. Is usually called by an event handler (for example
  *		when pressing the "Escape" key).
@@ -0,0 +1,136 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ei_arena.h"
+#include "ei_stats.h"
+
+typedef struct ei_arena_block_t {
+        size_t size;                    ///< Usable bytes after the header.
+        size_t used;                    ///< Bytes already handed out.
+        struct ei_arena_block_t* next;  ///< Older block.
+} ei_arena_block_t;
+
+static size_t default_block_size = 64 * 1024;
+static size_t alignment = 16;
+static ei_arena_block_t *current_block = NULL;
+static size_t total_used = 0;   // Bytes handed out since the last reset
+static size_t peak_used = 0;    // Highest value of total_used since the last reset
+
+/**
+ * @brief	Allocates a new block and makes it the current one.
+ *
+ * @param	size		The minimal usable size of the block.
+ */
+static void push_block(size_t size)
+{
+        if (size < default_block_size) size = default_block_size;
+        ei_arena_block_t *block = ei_malloc(sizeof(ei_arena_block_t) + size + alignment);
+        block->size = size;
+        block->used = 0;
+        block->next = current_block;
+        current_block = block;
+}
+
+/**
+ * \brief	Allocates memory in the frame arena. The memory is set to 0 and stays valid
+ *		until the end of the current iteration of the main loop, when the arena is
+ *		reset: it must *not* be freed, and must not be kept from one frame to the next.
+ *		Widget classes can use it for transient drawing data (points, clippers...).
+ *
+ * @param	size		The number of bytes to allocate.
+ *
+ * @return			A block of memory with all bytes set to 0.
+ */
+void* ei_arena_alloc(size_t size)
+{
+        size = (size + alignment - 1) & ~(alignment - 1);
+        if (current_block == NULL || current_block->used + size > current_block->size) push_block(size);
+
+        uintptr_t start = (uintptr_t) (current_block + 1);
+        start = (start + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        void *ptr = (void*) (start + current_block->used);
+        current_block->used += size;
+        total_used += size;
+        if (total_used > peak_used) peak_used = total_used;
+        memset(ptr, 0, size);
+        return ptr;
+}
+
+/**
+ * \brief	Returns the current position in the frame arena.
+ *
+ * @return			The mark, to give to \ref ei_arena_rewind.
+ */
+ei_arena_mark_t ei_arena_get_mark(void)
+{
+        ei_arena_mark_t mark = {current_block, (current_block != NULL) ? current_block->used : 0};
+        return mark;
+}
+
+/**
+ * \brief	Releases everything allocated in the frame arena since a mark was taken. Lets
+ *		a drawing function use the arena for its own scratch data even when it is called
+ *		outside of the main loop.
+ *
+ * @param	mark		A mark returned by \ref ei_arena_get_mark during the current frame.
+ */
+void ei_arena_rewind(ei_arena_mark_t mark)
+{
+        ei_arena_block_t *temp = NULL;
+        while (current_block != NULL && current_block != mark.block) {
+                temp = current_block->next;
+                total_used -= current_block->used;
+                free(current_block);
+                current_block = temp;
+        }
+        if (current_block != NULL) {
+                total_used -= current_block->used - mark.used;
+                current_block->used = mark.used;
+        }
+}
+
+/**
+ * \brief	Releases at once all the memory allocated in the frame arena, which can then be
+ *		reused. Called by \ref ei_app_run at the end of each iteration of the main loop.
+ *		When the last frame needed more than one block, the blocks are merged so that
+ *		the next frames fit in a single block.
+ */
+void ei_arena_reset(void)
+{
+        if (current_block != NULL && (current_block->next != NULL || peak_used > current_block->size)) {
+                size_t needed = peak_used + peak_used / 2;
+                ei_arena_free();
+                push_block(needed);
+        } else if (current_block != NULL) {
+                current_block->used = 0;
+        }
+        total_used = 0;
+        peak_used = 0;
+}
+
+/**
+ * \brief	Returns the memory reserved by the frame arena, whether it is in use or not.
+ *
+ * @return			The size of all the blocks of the arena, in bytes.
+ */
+size_t ei_arena_get_size(void)
+{
+        size_t size = 0;
+        for (ei_arena_block_t *block = current_block; block != NULL; block = block->next) size += block->size;
+        return size;
+}
+
+/**
+ * \brief	Gives back the memory of the frame arena to the system.
+ */
+void ei_arena_free(void)
+{
+        ei_arena_block_t *temp = NULL;
+        while (current_block) {
+                temp = current_block->next;
+                free(current_block);
+                current_block = temp;
+        }
+        total_used = 0;
+        peak_used = 0;
+}
@@ -2,20 +2,20 @@
 
 ei_widget_t* button_alloc(void)
 {
-        ei_button_t *button = (ei_button_t*) calloc(1, sizeof(ei_button_t));
-        button->color = calloc(1, sizeof(ei_color_t));
-        button->border_width = calloc(1, sizeof(int));
-        button->corner_radius = calloc(1, sizeof(int));
-        button->relief = calloc(1, sizeof(ei_relief_t));
-        button->text = calloc(1, sizeof(char*));
-        button->text_font = calloc(1, sizeof(ei_font_t));
-        button->text_color = calloc(1, sizeof(ei_color_t));
-        button->text_anchor = calloc(1, sizeof(ei_anchor_t));
-        button->img = calloc(1, sizeof(ei_surface_t));
-        button->img_rect = calloc(1, sizeof(ei_rect_t*));
-        button->img_anchor = calloc(1, sizeof(ei_anchor_t));
-        button->callback = calloc(1, sizeof(ei_callback_t));
-        button->user_param = calloc(1, sizeof(void*));
+        ei_button_t *button = (ei_button_t*) ei_calloc(1, sizeof(ei_button_t));
+        button->color = ei_calloc(1, sizeof(ei_color_t));
+        button->border_width = ei_calloc(1, sizeof(int));
+        button->corner_radius = ei_calloc(1, sizeof(int));
+        button->relief = ei_calloc(1, sizeof(ei_relief_t));
+        button->text = ei_calloc(1, sizeof(char*));
+        button->text_font = ei_calloc(1, sizeof(ei_font_t));
+        button->text_color = ei_calloc(1, sizeof(ei_color_t));
+        button->text_anchor = ei_calloc(1, sizeof(ei_anchor_t));
+        button->img = ei_calloc(1, sizeof(ei_surface_t));
+        button->img_rect = ei_calloc(1, sizeof(ei_rect_t*));
+        button->img_anchor = ei_calloc(1, sizeof(ei_anchor_t));
+        button->callback = ei_calloc(1, sizeof(ei_callback_t));
+        button->user_param = ei_calloc(1, sizeof(void*));
         return (ei_widget_t*) button;
 }
 
@@ -53,31 +53,38 @@ void button_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_su
         int text_width = 0;
         int text_height = 0;
 
-        ei_color_t light_color = get_light_color_variation(color);
-        ei_color_t dark_color = get_dark_color_variation(color);
+        // Buttons without relief look sunken
+        ei_relief_t skin_relief = (*relief == ei_relief_raised) ? ei_relief_raised : ei_relief_sunken;
+        ei_skin_t *skin = ei_skin_get(color, *border_width, *corner_radius, skin_relief, EI_TRUE);
 
-        struct ei_linked_point_t *upper_part = rounded_frame(rectangle, *corner_radius, 'h');
-        struct ei_linked_point_t *lower_part = rounded_frame(rectangle, *corner_radius, 'l');
-
-        if (*relief == ei_relief_raised){
-                ei_draw_polygon(surface, upper_part, light_color, clipper);
-                ei_draw_polygon(surface, lower_part, dark_color, clipper);
+        if (ei_skin_fits(skin, &rectangle)) {
+                ei_skin_draw_with_pick(surface, skin, &rectangle, pick_surface, button->widget.pick_color,
+                                       clipper);
         } else {
-                ei_draw_polygon(surface, upper_part, dark_color, clipper);
-                ei_draw_polygon(surface, lower_part, light_color, clipper);
+                // Too small for the nine-slice skin: rasterize the relief polygons
+                ei_color_t light_color = get_light_color_variation(color);
+                ei_color_t dark_color = get_dark_color_variation(color);
+
+                struct ei_linked_point_t *upper_part = rounded_frame(rectangle, *corner_radius, 'h');
+                struct ei_linked_point_t *lower_part = rounded_frame(rectangle, *corner_radius, 'l');
+
+                // The pick IDs are stored while the relief is drawn
+                ei_color_t upper_color = (*relief == ei_relief_raised) ? light_color : dark_color;
+                ei_color_t lower_color = (*relief == ei_relief_raised) ? dark_color : light_color;
+                ei_draw_polygon_with_pick(surface, upper_part, upper_color, pick_surface,
+                                          button->widget.pick_color, clipper);
+                ei_draw_polygon_with_pick(surface, lower_part, lower_color, pick_surface,
+                                          button->widget.pick_color, clipper);
+
+                rectangle.size.height -= 2 * *border_width;
+                rectangle.size.width -= 2 * *border_width;
+                rectangle.top_left.y += *border_width;
+                rectangle.top_left.x += *border_width;
+
+                struct ei_linked_point_t *main_part = rounded_frame(rectangle, *corner_radius, 't');
+                ei_draw_polygon(surface, main_part, *color, clipper);
         }
 
-        ei_draw_polygon(pick_surface, upper_part, *(button->widget.pick_color), clipper);
-        ei_draw_polygon(pick_surface, lower_part, *(button->widget.pick_color), clipper);
-
-        rectangle.size.height -= 2 * *border_width;
-        rectangle.size.width -= 2 * *border_width;
-        rectangle.top_left.y += *border_width;
-        rectangle.top_left.x += *border_width;
-
-        struct ei_linked_point_t *main_part = rounded_frame(rectangle, *corner_radius, 't');
-        ei_draw_polygon(surface, main_part, *color, clipper);
-
         if (*button->img != NULL) {
                 ei_rect_t img_clipper = rectangle_intersect(clipper,widget->content_rect);
                 ei_point_t where;
@@ -92,19 +99,9 @@ void button_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_su
                 }
                 anchoring(*button->img_anchor,&where,&widget->screen_location,&img_size);
 
-                ei_rect_t positioned_rect = {where, img_size};
-                ei_rect_t intersection = rectangle_intersect(&img_clipper,&positioned_rect);
-                ei_point_t new_origin_start;
-                new_origin_start.x = (where.x >= img_clipper.top_left.x)? img_top_left.x :
-                                     img_top_left.x -where.x + intersection.top_left.x;
-                new_origin_start.y = (where.y >= img_clipper.top_left.y)? img_top_left.y :
-                                     img_top_left.y + intersection.top_left.y - where.y;
-                ei_rect_t img_intersect = {new_origin_start, intersection.size};
-                hw_surface_lock(*button->img);
-                hw_surface_lock(surface);
-                ei_copy_surface(surface, &intersection, *button->img, &img_intersect, 1);
-                hw_surface_unlock(surface);
-                hw_surface_unlock(*button->img);
+                // The image is clipped, and blended row by row, by the sprite batch
+                ei_sprite_t sprite = {{img_top_left, img_size}, where};
+                ei_draw_sprites(surface, *button->img, &sprite, 1, &img_clipper);
         }
 
         if (*button->text != NULL) {
@@ -118,11 +115,6 @@ void button_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_su
                              &text_clipper);
 
         }
-
-        // Free points
-        free_linked_points(upper_part);
-        free_linked_points(lower_part);
-        free_linked_points(main_part);
 }
 
 void button_setdefault(ei_widget_t* widget)
@@ -148,37 +140,52 @@ void button_geomnotify(ei_widget_t* widget, ei_rect_t rect)
 
 }
 
+/**
+ * @brief	Changes the relief of a button, and only redraws the button if the relief is
+ *		really different.
+ *
+ * @param	widget		The button.
+ * @param	relief		The new relief.
+ *
+ * @return			EI_TRUE if the relief has changed.
+ */
+static ei_bool_t button_set_relief(ei_widget_t* widget, ei_relief_t relief)
+{
+        ei_button_t* button = (ei_button_t*) widget;
+        if (*button->relief == relief) return EI_FALSE;
+        *button->relief = relief;
+        ei_widget_invalidate(widget);
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Tells if a point is over a button.
+ *
+ * @param	widget		The button.
+ * @param	where		The point, in the root window coordinates.
+ *
+ * @return			EI_TRUE if the point is within the screen location of the button.
+ */
+static ei_bool_t button_contains(ei_widget_t* widget, ei_point_t where)
+{
+        ei_rect_t *location = &widget->screen_location;
+        return (where.x >= location->top_left.x && where.x <= location->top_left.x + location->size.width &&
+                where.y >= location->top_left.y && where.y <= location->top_left.y + location->size.height);
+}
+
 ei_bool_t button_handle(ei_widget_t* widget, ei_event_t* event)
 {
         ei_button_t* button = (ei_button_t*) widget;
-        ei_rect_t rect2invalidate = widget->parent->screen_location;
-        if (strcmp(ei_widgetclass_stringname(widget->parent->wclass->name), "toplevel") == 0) {
-                ei_toplevel_t *parent = (ei_toplevel_t*) widget->parent;
-                int title_width = 0;
-                int title_height = 0;
-                hw_text_compute_size(*parent->title, ei_default_font, &title_width, &title_height);
-                rect2invalidate.size.height += title_height + 2 * *parent->border_width;
-                rect2invalidate.size.width += 2 * *parent->border_width;
-        }
 
         if (event->type == ei_ev_mouse_buttondown) {
-                *button->relief = ei_relief_sunken;
-                ei_rect_t rect2add = rectangle_intersect(&rect2invalidate, widget->parent->content_rect);
-                ei_app_invalidate_rect(&rect2add);
+                button_set_relief(widget, ei_relief_sunken);
                 return EI_TRUE;
         } else if (event->type == ei_ev_mouse_buttonup) {
-                if (event->param.mouse.where.x < widget->screen_location.top_left.x ||
-                    event->param.mouse.where.x > (widget->screen_location.top_left.x +
-                    widget->screen_location.size.width) ||
-                    event->param.mouse.where.y < widget->screen_location.top_left.y ||
-                    event->param.mouse.where.y > (widget->screen_location.top_left.y +
-                    widget->screen_location.size.height)) {
+                if (!button_contains(widget, event->param.mouse.where)) {
                         ei_event_set_active_widget(NULL);
                         return EI_TRUE;
                 } else {
-                        *button->relief = ei_relief_raised;
-                        ei_rect_t rect2add = rectangle_intersect(&rect2invalidate, widget->parent->content_rect);
-                        ei_app_invalidate_rect(&rect2add);
+                        button_set_relief(widget, ei_relief_raised);
                         if (*button->callback != NULL) {
                                 ei_callback_t callback = *(button->callback);
                                 callback(widget, event, *button->user_param);
@@ -187,30 +194,35 @@ ei_bool_t button_handle(ei_widget_t* widget, ei_event_t* event)
                         return EI_TRUE;
                 }
         } else if (event->type == ei_ev_mouse_move) {
-                if (event->param.mouse.where.x < widget->screen_location.top_left.x ||
-                    event->param.mouse.where.x > (widget->screen_location.top_left.x +
-                    widget->screen_location.size.width) ||
-                    event->param.mouse.where.y < widget->screen_location.top_left.y ||
-                    event->param.mouse.where.y > (widget->screen_location.top_left.y +
-                    widget->screen_location.size.height)) {
-                        if (button->relief != (ei_relief_t *) ei_relief_raised) {
-                                *button->relief = ei_relief_raised;
-                                ei_rect_t rect2add = rectangle_intersect(&rect2invalidate, widget->parent->content_rect);
-                                ei_app_invalidate_rect(&rect2add);
-                                return EI_TRUE;
-                        }
+                // Only a change of relief needs a redraw, not every move over the button
+                if (!button_contains(widget, event->param.mouse.where)) {
+                        return button_set_relief(widget, ei_relief_raised);
                 } else {
-                        if (button->relief != (ei_relief_t *) ei_relief_sunken) {
-                                *button->relief = ei_relief_sunken;
-                                ei_rect_t rect2add = rectangle_intersect(&rect2invalidate, widget->parent->content_rect);
-                                ei_app_invalidate_rect(&rect2add);
-                                return EI_TRUE;
-                        }
+                        return button_set_relief(widget, ei_relief_sunken);
                 }
         }
         return EI_FALSE;
 }
 
+ei_bool_t button_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        ei_button_t *button = (ei_button_t*) widget;
+        ei_rect_t rectangle = widget->screen_location;
+        int radius = *button->corner_radius;
+
+        // Keep the biggest of the two bands that avoid the rounded corners
+        if (rectangle.size.width < 2 * radius || rectangle.size.height < 2 * radius) return EI_FALSE;
+        if (rectangle.size.width >= rectangle.size.height) {
+                rectangle.top_left.y += radius;
+                rectangle.size.height -= 2 * radius;
+        } else {
+                rectangle.top_left.x += radius;
+                rectangle.size.width -= 2 * radius;
+        }
+        *opaque = rectangle;
+        return EI_TRUE;
+}
+
 ei_widgetclass_t buttonclass = {"button",
                                 &button_alloc,
                                 &button_release,
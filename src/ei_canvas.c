@@ -0,0 +1,545 @@
+#include <string.h>
+#include "ei_arena.h"
+#include "ei_canvas.h"
+#include "ei_trace.h"
+
+ei_widget_t* canvas_alloc(void)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) ei_calloc(1, sizeof(ei_canvas_t));
+        canvas->color = ei_calloc(1, sizeof(ei_color_t));
+        canvas->handlefunc = ei_calloc(1, sizeof(ei_canvas_handlefunc_t));
+        canvas->user_param = ei_calloc(1, sizeof(void*));
+        canvas->index = ei_rtree_create();
+        canvas->next_id = 1;
+        return (ei_widget_t*) canvas;
+}
+
+static void free_item(ei_canvas_item_t* item)
+{
+        free(item->points);
+        free(item->text);
+        free(item);
+}
+
+void canvas_release(ei_widget_t* widget)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        for (int id = 1; id < canvas->next_id; id++) {
+                if (canvas->items[id] != NULL) free_item(canvas->items[id]);
+        }
+        ei_rtree_free(canvas->index);
+        free(canvas->items);
+        free(canvas->found);
+        free(canvas->color);
+        free(canvas->handlefunc);
+        free(canvas->user_param);
+        free(canvas);
+}
+
+/**
+ * @brief	Adds an item found in the index to the items to draw.
+ *
+ * @param	data		The item.
+ * @param	rect		Its bounds.
+ * @param	user_param	The canvas.
+ */
+static void collect_item(void* data, const ei_rect_t* rect, void* user_param)
+{
+        ei_canvas_t *canvas = user_param;
+        if (canvas->found_count == canvas->found_capacity) {
+                int capacity = (canvas->found_capacity > 0) ? 2 * canvas->found_capacity : 64;
+                ei_canvas_item_t **grown = ei_malloc((size_t) capacity * sizeof(ei_canvas_item_t*));
+                if (canvas->found != NULL) memcpy(grown, canvas->found, (size_t) canvas->found_count * sizeof(ei_canvas_item_t*));
+                free(canvas->found);
+                canvas->found = grown;
+                canvas->found_capacity = capacity;
+        }
+        canvas->found[canvas->found_count++] = data;
+}
+
+static int compare_items(const void* first, const void* second)
+{
+        int first_id = (*(ei_canvas_item_t* const*) first)->id;
+        int second_id = (*(ei_canvas_item_t* const*) second)->id;
+        return (first_id > second_id) - (first_id < second_id);
+}
+
+/**
+ * @brief	Draws an item of a canvas, which is not an image.
+ *
+ * @param	item		The item.
+ * @param	surface		Where to draw the item, *locked* by \ref hw_surface_lock.
+ * @param	origin		The top left corner of the canvas on screen.
+ * @param	clipper		The drawing must be restricted within this rectangle.
+ */
+static void draw_item(const ei_canvas_item_t* item, ei_surface_t surface, ei_point_t origin,
+                      ei_rect_t* clipper)
+{
+        if (item->type == ei_canvas_polygon || item->type == ei_canvas_polyline) {
+                // The points are moved on screen in the frame arena
+                ei_linked_point_t *points = ei_arena_alloc((size_t) item->point_count * sizeof(ei_linked_point_t));
+                for (int i = 0; i < item->point_count; i++) {
+                        points[i].point.x = item->points[i].x + origin.x;
+                        points[i].point.y = item->points[i].y + origin.y;
+                        points[i].next = (i + 1 < item->point_count) ? &points[i + 1] : NULL;
+                }
+                if (item->type == ei_canvas_polygon) {
+                        ei_draw_polygon(surface, points, item->color, clipper);
+                } else {
+                        ei_draw_polyline(surface, points, item->color, clipper);
+                }
+        } else {
+                ei_point_t where = ei_point_add(item->bounds.top_left, origin);
+                ei_draw_text(surface, &where, item->text, item->font, item->color, clipper);
+        }
+}
+
+/**
+ * @brief	Draws images of a canvas that are next to each other in the drawing order, and
+ *		are parts of the same surface, with one call to \ref ei_draw_sprites.
+ *
+ * @param	items		The images.
+ * @param	count		The number of images.
+ * @param	surface		Where to draw the images, *locked* by \ref hw_surface_lock.
+ * @param	origin		The top left corner of the canvas on screen.
+ * @param	clipper		The drawing must be restricted within this rectangle.
+ */
+static void draw_images(ei_canvas_item_t** items, int count, ei_surface_t surface, ei_point_t origin,
+                        ei_rect_t* clipper)
+{
+        ei_sprite_t *sprites = ei_arena_alloc((size_t) count * sizeof(ei_sprite_t));
+        for (int i = 0; i < count; i++) {
+                sprites[i].src_rect = ei_rect(items[i]->img_origin, items[i]->bounds.size);
+                sprites[i].where = ei_point_add(items[i]->bounds.top_left, origin);
+        }
+        ei_draw_sprites(surface, items[0]->image, sprites, count, clipper);
+}
+
+void canvas_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+                 ei_rect_t* clipper)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        ei_rect_t canvas_clipper = rectangle_intersect(clipper, &widget->screen_location);
+        if (canvas_clipper.size.width <= 0 || canvas_clipper.size.height <= 0) return;
+
+        // The items are not widgets: the whole canvas picks as one widget
+        ei_fill_with_pick(surface, canvas->color, pick_surface, widget->pick_color, &canvas_clipper);
+
+        // Only the items in the clipper are drawn, in the order they were added
+        ei_trace_begin("ei_canvas_replay");
+        ei_point_t origin = widget->screen_location.top_left;
+        ei_rect_t area = {{canvas_clipper.top_left.x - origin.x, canvas_clipper.top_left.y - origin.y},
+                          canvas_clipper.size};
+        canvas->found_count = 0;
+        ei_rtree_search(canvas->index, &area, collect_item, canvas);
+        qsort(canvas->found, (size_t) canvas->found_count, sizeof(ei_canvas_item_t*), compare_items);
+        ei_arena_mark_t mark = ei_arena_get_mark();
+        for (int i = 0; i < canvas->found_count;) {
+                ei_canvas_item_t **items = &canvas->found[i];
+                int count = 1;
+                if (items[0]->type == ei_canvas_image) {
+                        while (i + count < canvas->found_count && items[count]->type == ei_canvas_image &&
+                               items[count]->image == items[0]->image) count++;
+                        draw_images(items, count, surface, origin, &canvas_clipper);
+                } else {
+                        draw_item(items[0], surface, origin, &canvas_clipper);
+                }
+                ei_arena_rewind(mark);
+                i += count;
+        }
+        ei_trace_end("ei_canvas_replay");
+}
+
+void canvas_setdefaults(ei_widget_t* widget)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        *canvas->color = ei_default_background_color;
+        *canvas->handlefunc = NULL;
+        *canvas->user_param = NULL;
+}
+
+void canvas_geomnotify(ei_widget_t* widget, ei_rect_t rect)
+{
+
+}
+
+ei_bool_t canvas_handle(ei_widget_t* widget, ei_event_t* event)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        ei_bool_t handled = EI_FALSE;
+
+        if (event->type == ei_ev_mouse_buttondown || event->type == ei_ev_mouse_buttonup ||
+            event->type == ei_ev_mouse_move) {
+                if (*canvas->handlefunc != NULL) {
+                        int item = ei_canvas_item_at(widget, &event->param.mouse.where);
+                        handled = (*canvas->handlefunc)(widget, item, event, *canvas->user_param);
+                }
+                if (event->type == ei_ev_mouse_buttonup) {
+                        ei_event_set_active_widget(NULL);
+                        handled = EI_TRUE;
+                }
+        }
+        return handled;
+}
+
+ei_bool_t canvas_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        // The background is filled below the items
+        *opaque = widget->screen_location;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Configures the attributes of widgets of the class "canvas".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget. Defaults to the size needed by
+ *				the items of the canvas when this function is called.
+ * @param	color		The color of the background. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	handlefunc	The function called for mouse events over the canvas. Defaults to NULL.
+ * @param	user_param	A parameter passed to handlefunc. Defaults to NULL.
+ */
+void ei_canvas_configure (ei_widget_t* widget,
+                          ei_size_t* requested_size,
+                          const ei_color_t* color,
+                          ei_canvas_handlefunc_t* handlefunc,
+                          void** user_param)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(canvas->color, color, sizeof(ei_color_t));
+        // The handle function and its parameter are not drawn: changing them needs no redraw
+        update_field(canvas->handlefunc, handlefunc, sizeof(ei_canvas_handlefunc_t));
+        update_field(canvas->user_param, user_param, sizeof(void*));
+        if (requested_size != NULL) {
+                widget->requested_size = *requested_size;
+        } else {
+                ei_rect_t bounds = ei_rtree_get_bounds(canvas->index);
+                widget->requested_size.width = bounds.top_left.x + bounds.size.width;
+                widget->requested_size.height = bounds.top_left.y + bounds.size.height;
+        }
+        ei_widget_configured(widget, changed, old_requested_size);
+}
+
+/**
+ * @brief	Redraws the bounds of an item, where they are visible.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item.
+ */
+static void invalidate_item(ei_widget_t* widget, const ei_canvas_item_t* item)
+{
+        ei_rect_t bounds = {ei_point_add(item->bounds.top_left, widget->screen_location.top_left),
+                            item->bounds.size};
+        ei_widget_invalidate_rect(widget, &bounds);
+}
+
+/**
+ * @brief	Gives an id to a new item, indexes it and draws it.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item, which bounds are set.
+ *
+ * @return			The id of the item.
+ */
+static int add_item(ei_widget_t* widget, ei_canvas_item_t* item)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        if (canvas->next_id >= canvas->item_capacity) {
+                int capacity = (canvas->item_capacity > 0) ? 2 * canvas->item_capacity : 64;
+                ei_canvas_item_t **grown = ei_calloc((size_t) capacity, sizeof(ei_canvas_item_t*));
+                if (canvas->items != NULL) memcpy(grown, canvas->items, (size_t) canvas->item_capacity * sizeof(ei_canvas_item_t*));
+                free(canvas->items);
+                canvas->items = grown;
+                canvas->item_capacity = capacity;
+        }
+        item->id = canvas->next_id++;
+        canvas->items[item->id] = item;
+        ei_rtree_insert(canvas->index, &item->bounds, item);
+        invalidate_item(widget, item);
+        return item->id;
+}
+
+/**
+ * @brief	Creates a polygon or a polyline item.
+ *
+ * @param	widget		The canvas.
+ * @param	type		The kind of item.
+ * @param	first_point	The points, which are copied.
+ * @param	color		The color of the item.
+ *
+ * @return			The item, or 0 if there is no point.
+ */
+static int add_points(ei_widget_t* widget, ei_canvas_item_type_t type, const ei_linked_point_t* first_point,
+                      ei_color_t color)
+{
+        int count = 0;
+        for (const ei_linked_point_t *point = first_point; point != NULL; point = point->next) count++;
+        if (count == 0) return 0;
+
+        ei_canvas_item_t *item = ei_calloc(1, sizeof(ei_canvas_item_t));
+        item->type = type;
+        item->color = color;
+        item->points = ei_malloc((size_t) count * sizeof(ei_point_t));
+        item->point_count = count;
+        int x0 = first_point->point.x, y0 = first_point->point.y, x1 = x0, y1 = y0;
+        int i = 0;
+        for (const ei_linked_point_t *point = first_point; point != NULL; point = point->next) {
+                item->points[i++] = point->point;
+                if (point->point.x < x0) x0 = point->point.x;
+                if (point->point.y < y0) y0 = point->point.y;
+                if (point->point.x > x1) x1 = point->point.x;
+                if (point->point.y > y1) y1 = point->point.y;
+        }
+        // The pixels of the last row and column are included
+        item->bounds = ei_rect(ei_point(x0, y0), ei_size(x1 - x0 + 1, y1 - y0 + 1));
+        return add_item(widget, item);
+}
+
+/**
+ * \brief	Adds a filled polygon to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	first_point	The points of the polygon, see \ref ei_draw_polygon. They are copied.
+ * @param	color		The color of the polygon.
+ *
+ * @return			The item, or 0 if there is no point.
+ */
+int ei_canvas_add_polygon(ei_widget_t* widget, const ei_linked_point_t* first_point, ei_color_t color)
+{
+        return add_points(widget, ei_canvas_polygon, first_point, color);
+}
+
+/**
+ * \brief	Adds a polyline to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	first_point	The points of the line, see \ref ei_draw_polyline. They are copied.
+ * @param	color		The color of the line.
+ *
+ * @return			The item, or 0 if there is no point.
+ */
+int ei_canvas_add_polyline(ei_widget_t* widget, const ei_linked_point_t* first_point, ei_color_t color)
+{
+        return add_points(widget, ei_canvas_polyline, first_point, color);
+}
+
+/**
+ * \brief	Adds a text to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	where		The top left corner of the text.
+ * @param	text		The text. It is copied.
+ * @param	font		The font, or NULL for \ref ei_default_font.
+ * @param	color		The color of the text.
+ *
+ * @return			The item.
+ */
+int ei_canvas_add_text(ei_widget_t* widget, const ei_point_t* where, const char* text, ei_font_t font,
+                       ei_color_t color)
+{
+        ei_canvas_item_t *item = ei_calloc(1, sizeof(ei_canvas_item_t));
+        item->type = ei_canvas_text;
+        item->color = color;
+        item->font = (font != NULL) ? font : ei_default_font;
+        item->text = ei_malloc(strlen(text) + 1);
+        strcpy(item->text, text);
+        int width = 0;
+        int height = 0;
+        hw_text_compute_size(item->text, item->font, &width, &height);
+        item->bounds = ei_rect(*where, ei_size(width, height));
+        return add_item(widget, item);
+}
+
+/**
+ * \brief	Adds an image to a canvas, over the items already there.
+ *
+ * @param	widget		The canvas.
+ * @param	where		The top left corner of the image.
+ * @param	image		The surface of the image. It is not copied: it must stay valid as long
+ *				as the item exists.
+ * @param	img_rect	The part of the surface to draw, or NULL for all of it.
+ *
+ * @return			The item.
+ */
+int ei_canvas_add_image(ei_widget_t* widget, const ei_point_t* where, ei_surface_t image,
+                        const ei_rect_t* img_rect)
+{
+        ei_canvas_item_t *item = ei_calloc(1, sizeof(ei_canvas_item_t));
+        item->type = ei_canvas_image;
+        item->image = image;
+        ei_rect_t source = (img_rect != NULL) ? *img_rect : hw_surface_get_rect(image);
+        item->img_origin = source.top_left;
+        item->bounds = ei_rect(*where, source.size);
+        return add_item(widget, item);
+}
+
+/**
+ * @brief	Returns an item of a canvas from its id.
+ *
+ * @param	canvas		The canvas.
+ * @param	id		The id.
+ *
+ * @return			The item, or NULL if it does not exist.
+ */
+static ei_canvas_item_t* get_item(ei_canvas_t* canvas, int id)
+{
+        return (id > 0 && id < canvas->next_id) ? canvas->items[id] : NULL;
+}
+
+/**
+ * \brief	Moves an item of a canvas.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item.
+ * @param	dx, dy		The offset.
+ */
+void ei_canvas_move(ei_widget_t* widget, int item, int dx, int dy)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        ei_canvas_item_t *moved = get_item(canvas, item);
+        if (moved == NULL || (dx == 0 && dy == 0)) return;
+        invalidate_item(widget, moved);
+        ei_rtree_remove(canvas->index, &moved->bounds, moved);
+        for (int i = 0; i < moved->point_count; i++) {
+                moved->points[i].x += dx;
+                moved->points[i].y += dy;
+        }
+        moved->bounds.top_left.x += dx;
+        moved->bounds.top_left.y += dy;
+        ei_rtree_insert(canvas->index, &moved->bounds, moved);
+        invalidate_item(widget, moved);
+}
+
+/**
+ * \brief	Removes an item from a canvas.
+ *
+ * @param	widget		The canvas.
+ * @param	item		The item.
+ */
+void ei_canvas_delete(ei_widget_t* widget, int item)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        ei_canvas_item_t *deleted = get_item(canvas, item);
+        if (deleted == NULL) return;
+        invalidate_item(widget, deleted);
+        ei_rtree_remove(canvas->index, &deleted->bounds, deleted);
+        canvas->items[item] = NULL;
+        free_item(deleted);
+}
+
+/**
+ * @brief	Tells if the center of a pixel is inside a polygon, with the even-odd rule.
+ *
+ * @param	item		The polygon.
+ * @param	where		The pixel, relative to the canvas.
+ *
+ * @return			EI_TRUE if the pixel is inside.
+ */
+static ei_bool_t polygon_contains(const ei_canvas_item_t* item, ei_point_t where)
+{
+        double x = where.x + 0.5;
+        double y = where.y + 0.5;
+        ei_bool_t inside = EI_FALSE;
+        for (int i = 0, j = item->point_count - 1; i < item->point_count; j = i++) {
+                ei_point_t a = item->points[i];
+                ei_point_t b = item->points[j];
+                if ((a.y > y) != (b.y > y) && x < a.x + (y - a.y) * (b.x - a.x) / (double) (b.y - a.y))
+                        inside = !inside;
+        }
+        return inside;
+}
+
+/**
+ * @brief	Tells if a pixel is on a polyline, give or take a pixel.
+ *
+ * @param	item		The polyline.
+ * @param	where		The pixel, relative to the canvas.
+ *
+ * @return			EI_TRUE if the pixel is on the line.
+ */
+static ei_bool_t polyline_contains(const ei_canvas_item_t* item, ei_point_t where)
+{
+        if (item->point_count == 1)
+                return (abs(where.x - item->points[0].x) <= 1 && abs(where.y - item->points[0].y) <= 1);
+        for (int i = 0; i + 1 < item->point_count; i++) {
+                ei_point_t a = item->points[i];
+                ei_point_t b = item->points[i + 1];
+                double length = (double) (b.x - a.x) * (b.x - a.x) + (double) (b.y - a.y) * (b.y - a.y);
+                double t = (length > 0) ? ((where.x - a.x) * (double) (b.x - a.x) +
+                                           (where.y - a.y) * (double) (b.y - a.y)) / length : 0.0;
+                if (t < 0) t = 0;
+                if (t > 1) t = 1;
+                double dx = a.x + t * (b.x - a.x) - where.x;
+                double dy = a.y + t * (b.y - a.y) - where.y;
+                if (dx * dx + dy * dy <= 2.25) return EI_TRUE;
+        }
+        return EI_FALSE;
+}
+
+/**
+ * @brief	The pixel searched by \ref ei_canvas_item_at, and the top-most item found there.
+ */
+typedef struct hit_t {
+        ei_point_t where;               ///< The pixel, relative to the canvas.
+        int id;                         ///< The item found so far, 0 if none.
+} hit_t;
+
+/**
+ * @brief	Keeps the top-most item found in the index under a pixel.
+ *
+ * @param	data		The item.
+ * @param	rect		Its bounds.
+ * @param	user_param	The \ref hit_t of the search.
+ */
+static void hit_item(void* data, const ei_rect_t* rect, void* user_param)
+{
+        ei_canvas_item_t *item = data;
+        hit_t *hit = user_param;
+        if (item->id < hit->id) return;
+        ei_bool_t inside;
+        if (item->type == ei_canvas_polygon) {
+                inside = polygon_contains(item, hit->where);
+        } else if (item->type == ei_canvas_polyline) {
+                inside = polyline_contains(item, hit->where);
+        } else {
+                inside = (hit->where.x >= rect->top_left.x && hit->where.x < rect->top_left.x + rect->size.width &&
+                          hit->where.y >= rect->top_left.y && hit->where.y < rect->top_left.y + rect->size.height);
+        }
+        if (inside) hit->id = item->id;
+}
+
+/**
+ * \brief	Finds the top-most item of a canvas at a given location on screen. Polygons and
+ *		polylines are only found on their pixels, texts and images in all their bounds.
+ *
+ * @param	widget		The canvas.
+ * @param	where		The location, in the root window coordinates.
+ *
+ * @return			The item, or 0 if there is none.
+ */
+int ei_canvas_item_at(ei_widget_t* widget, const ei_point_t* where)
+{
+        ei_canvas_t *canvas = (ei_canvas_t*) widget;
+        hit_t hit;
+        hit.where.x = where->x - widget->screen_location.top_left.x;
+        hit.where.y = where->y - widget->screen_location.top_left.y;
+        hit.id = 0;
+        // Polylines are found a pixel around them
+        ei_rect_t area = {{hit.where.x - 1, hit.where.y - 1}, {3, 3}};
+        ei_rtree_search(canvas->index, &area, hit_item, &hit);
+        return hit.id;
+}
+
+ei_widgetclass_t canvasclass = {"canvas",
+                                &canvas_alloc,
+                                &canvas_release,
+                                &canvas_draw,
+                                &canvas_setdefaults,
+                                &canvas_geomnotify,
+                                &canvas_handle,
+                                NULL};
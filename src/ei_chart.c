@@ -0,0 +1,344 @@
+#include "ei_chart.h"
+
+ei_widget_t* chart_alloc(void)
+{
+        ei_chart_t *chart = (ei_chart_t*) ei_calloc(1, sizeof(ei_chart_t));
+        chart->color = ei_calloc(1, sizeof(ei_color_t));
+        chart->trace_color = ei_calloc(1, sizeof(ei_color_t));
+        chart->capacity = ei_calloc(1, sizeof(int));
+        chart->samples_per_column = ei_calloc(1, sizeof(int));
+        chart->min_value = ei_calloc(1, sizeof(float));
+        chart->max_value = ei_calloc(1, sizeof(float));
+        return (ei_widget_t*) chart;
+}
+
+void chart_release(ei_widget_t* widget)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        free(chart->samples);
+        free(chart->columns);
+        free(chart->color);
+        free(chart->trace_color);
+        free(chart->capacity);
+        free(chart->samples_per_column);
+        free(chart->min_value);
+        free(chart->max_value);
+        free(chart);
+}
+
+/**
+ * @brief	Returns the number of the oldest sample kept by a chart.
+ *
+ * @param	chart		The chart.
+ *
+ * @return			The number of the sample, or the number of samples if there is none.
+ */
+static long first_sample(const ei_chart_t* chart)
+{
+        return (chart->total > chart->sample_capacity) ? chart->total - chart->sample_capacity : 0;
+}
+
+/**
+ * @brief	Returns the number of the column of the most recent sample of a chart: the one on
+ *		the right edge.
+ *
+ * @param	chart		The chart.
+ *
+ * @return			The number of the column, -1 if there is no sample.
+ */
+static long last_column(const ei_chart_t* chart)
+{
+        return (chart->total > 0) ? (chart->total - 1) / *chart->samples_per_column : -1;
+}
+
+/**
+ * @brief	Returns the number of the oldest column of a chart which has all its samples:
+ *		the columns before it are not shown.
+ *
+ * @param	chart		The chart.
+ *
+ * @return			The number of the column.
+ */
+static long first_column(const ei_chart_t* chart)
+{
+        int samples_per_column = *chart->samples_per_column;
+        return (first_sample(chart) + samples_per_column - 1) / samples_per_column;
+}
+
+/**
+ * @brief	Adds a sample to a column.
+ *
+ * @param	column		The column.
+ * @param	value		The sample.
+ * @param	first		EI_TRUE if it is the first sample of the column.
+ */
+static void add_to_column(ei_chart_column_t* column, float value, ei_bool_t first)
+{
+        if (first || value < column->min) column->min = value;
+        if (first || value > column->max) column->max = value;
+        column->last = value;
+}
+
+/**
+ * @brief	Makes the columns of a chart match its width, and computes them from the samples
+ *		if they are not valid. The column before the left edge is kept too, since the
+ *		trace joins it.
+ *
+ * @param	chart		The chart.
+ */
+static void update_columns(ei_chart_t* chart)
+{
+        int width = chart->widget.screen_location.size.width;
+        if (width <= 0) return;
+        if (width + 1 != chart->column_capacity) {
+                free(chart->columns);
+                chart->column_capacity = width + 1;
+                chart->columns = ei_malloc((size_t) chart->column_capacity * sizeof(ei_chart_column_t));
+                chart->columns_valid = EI_FALSE;
+        }
+        if (chart->columns_valid) return;
+
+        int samples_per_column = *chart->samples_per_column;
+        long first = first_column(chart);
+        long last = last_column(chart);
+        if (first < last - width) first = last - width;
+        for (long column = first; column <= last; column++) {
+                long end = (column + 1) * samples_per_column;
+                if (end > chart->total) end = chart->total;
+                for (long sample = column * samples_per_column; sample < end; sample++) {
+                        add_to_column(&chart->columns[column % chart->column_capacity],
+                                      chart->samples[sample % chart->sample_capacity],
+                                      sample == column * samples_per_column);
+                }
+        }
+        chart->columns_valid = EI_TRUE;
+}
+
+/**
+ * @brief	Changes the number of samples kept by a chart, keeping the most recent ones.
+ *
+ * @param	chart		The chart.
+ */
+static void resize_samples(ei_chart_t* chart)
+{
+        float *samples = ei_malloc((size_t) *chart->capacity * sizeof(float));
+        long first = (chart->total > *chart->capacity) ? chart->total - *chart->capacity : 0;
+        if (first < first_sample(chart)) first = first_sample(chart);
+        for (long sample = first; sample < chart->total; sample++)
+                samples[sample % *chart->capacity] = chart->samples[sample % chart->sample_capacity];
+        free(chart->samples);
+        chart->samples = samples;
+        chart->sample_capacity = *chart->capacity;
+        chart->columns_valid = EI_FALSE;
+}
+
+/**
+ * @brief	Returns the row of the chart where a value is shown.
+ *
+ * @param	chart		The chart.
+ * @param	value		The value.
+ *
+ * @return			The row, in the root window coordinates, clamped to the chart.
+ */
+static int value_row(const ei_chart_t* chart, float value)
+{
+        const ei_rect_t *rect = &chart->widget.screen_location;
+        float range = *chart->max_value - *chart->min_value;
+        float ratio = (range != 0) ? (value - *chart->min_value) / range : 0.5f;
+        if (!(ratio >= 0)) ratio = 0;
+        if (ratio > 1) ratio = 1;
+        return rect->top_left.y + rect->size.height - 1 - (int) (ratio * (float) (rect->size.height - 1) + 0.5f);
+}
+
+void chart_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+                ei_rect_t* clipper)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        ei_rect_t chart_clipper = rectangle_intersect(clipper, &widget->screen_location);
+        if (chart_clipper.size.width <= 0 || chart_clipper.size.height <= 0) return;
+
+        // The trace is not picked apart from the background
+        ei_fill_with_pick(surface, chart->color, pick_surface, widget->pick_color, &chart_clipper);
+        update_columns(chart);
+        if (chart->total == 0) return;
+
+        // Only the columns in the clipper are drawn, each as a line from its minimum to its
+        // maximum, joined to the last sample of the column before
+        int right = widget->screen_location.top_left.x + widget->screen_location.size.width - 1;
+        long last = last_column(chart);
+        long first = first_column(chart);
+        for (int x = chart_clipper.top_left.x; x < chart_clipper.top_left.x + chart_clipper.size.width; x++) {
+                long column = last - (right - x);
+                if (column < first) continue;
+                const ei_chart_column_t *shown = &chart->columns[column % chart->column_capacity];
+                float min = shown->min;
+                float max = shown->max;
+                if (column > first) {
+                        float joined = chart->columns[(column - 1) % chart->column_capacity].last;
+                        if (joined < min) min = joined;
+                        if (joined > max) max = joined;
+                }
+                int top = value_row(chart, max);
+                ei_rect_t line = {{x, top}, {1, value_row(chart, min) - top + 1}};
+                line = rectangle_intersect(&line, &chart_clipper);
+                if (line.size.height > 0) ei_fill(surface, chart->trace_color, &line);
+        }
+}
+
+void chart_setdefaults(ei_widget_t* widget)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        ei_color_t black = {0x00, 0x00, 0x00, 0xff};
+        widget->requested_size = ei_size(300, 100);
+        *chart->color = ei_default_background_color;
+        *chart->trace_color = black;
+        *chart->capacity = 4096;
+        *chart->samples_per_column = 1;
+        *chart->min_value = 0;
+        *chart->max_value = 1;
+        resize_samples(chart);
+}
+
+void chart_geomnotify(ei_widget_t* widget, ei_rect_t rect)
+{
+
+}
+
+ei_bool_t chart_handle(ei_widget_t* widget, ei_event_t* event)
+{
+        return EI_FALSE;
+}
+
+ei_bool_t chart_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        *opaque = widget->screen_location;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Configures the attributes of widgets of the class "chart".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget			The widget to configure.
+ * @param	requested_size		The size requested for this widget. Defaults to 300x100.
+ * @param	color			The color of the background. Defaults to
+ *					\ref ei_default_background_color.
+ * @param	trace_color		The color of the trace. Defaults to black.
+ * @param	capacity		The number of samples kept. The older ones are dropped.
+ *					Defaults to 4096.
+ * @param	samples_per_column	The number of samples shown in a column of pixels.
+ *					Defaults to 1.
+ * @param	min_value, max_value	The values shown at the bottom and at the top of the chart.
+ *					Default to 0 and 1.
+ */
+void ei_chart_configure (ei_widget_t* widget,
+                         ei_size_t* requested_size,
+                         const ei_color_t* color,
+                         const ei_color_t* trace_color,
+                         int* capacity,
+                         int* samples_per_column,
+                         float* min_value,
+                         float* max_value)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(chart->color, color, sizeof(ei_color_t));
+        changed |= update_field(chart->trace_color, trace_color, sizeof(ei_color_t));
+        changed |= update_field(chart->min_value, min_value, sizeof(float));
+        changed |= update_field(chart->max_value, max_value, sizeof(float));
+        if (update_field(chart->capacity, capacity, sizeof(int))) {
+                if (*chart->capacity < 1) *chart->capacity = 1;
+                resize_samples(chart);
+                changed = EI_TRUE;
+        }
+        if (update_field(chart->samples_per_column, samples_per_column, sizeof(int))) {
+                if (*chart->samples_per_column < 1) *chart->samples_per_column = 1;
+                chart->columns_valid = EI_FALSE;
+                changed = EI_TRUE;
+        }
+        if (requested_size != NULL) widget->requested_size = *requested_size;
+        ei_widget_configured(widget, changed, old_requested_size);
+}
+
+/**
+ * @brief	Redraws some columns of a chart, where they are visible.
+ *
+ * @param	widget		The chart.
+ * @param	first, last	The numbers of the first and the last column.
+ */
+static void invalidate_columns(ei_widget_t* widget, long first, long last)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        ei_rect_t *rect = &widget->screen_location;
+        long right = rect->top_left.x + rect->size.width - 1;
+        long x0 = right - (last_column(chart) - first);
+        long x1 = right - (last_column(chart) - last);
+        if (x0 < rect->top_left.x) x0 = rect->top_left.x;
+        if (x1 < x0) return;
+        ei_rect_t columns_rect = {{(int) x0, rect->top_left.y}, {(int) (x1 - x0 + 1), rect->size.height}};
+        ei_widget_invalidate_rect(widget, &columns_rect);
+}
+
+/**
+ * \brief	Appends samples to a chart. The trace scrolls to the left by the number of
+ *		columns they start.
+ *
+ * @param	widget		The chart.
+ * @param	samples		The samples, the oldest first. They are copied.
+ * @param	count		The number of samples.
+ */
+void ei_chart_append(ei_widget_t* widget, const float* samples, int count)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        if (count <= 0) return;
+        int samples_per_column = *chart->samples_per_column;
+        long old_first = first_column(chart);
+        long old_last = last_column(chart);
+
+        // The columns on screen are kept up to date, the others are computed when drawn
+        for (int i = 0; i < count; i++) {
+                long sample = chart->total++;
+                chart->samples[sample % chart->sample_capacity] = samples[i];
+                if (chart->columns_valid) {
+                        long column = sample / samples_per_column;
+                        add_to_column(&chart->columns[column % chart->column_capacity], samples[i],
+                                      sample % samples_per_column == 0);
+                }
+        }
+
+        // The columns already drawn are moved, only the new ones, which the move exposes,
+        // and the one that was not complete are drawn
+        long shift = last_column(chart) - old_last;
+        if (old_last < 0 || shift >= widget->screen_location.size.width) {
+                ei_widget_invalidate(widget);
+                return;
+        }
+        if (shift > 0) ei_widget_scroll_rect(widget, &widget->screen_location, (int) -shift, 0);
+        invalidate_columns(widget, old_last, old_last);
+        // The columns whose samples are dropped are removed
+        if (first_column(chart) > old_first) invalidate_columns(widget, old_first, first_column(chart));
+}
+
+/**
+ * \brief	Removes all the samples of a chart.
+ *
+ * @param	widget		The chart.
+ */
+void ei_chart_clear(ei_widget_t* widget)
+{
+        ei_chart_t *chart = (ei_chart_t*) widget;
+        chart->total = 0;
+        chart->columns_valid = EI_FALSE;
+        ei_widget_invalidate(widget);
+}
+
+ei_widgetclass_t chartclass = {"chart",
+                               &chart_alloc,
+                               &chart_release,
+                               &chart_draw,
+                               &chart_setdefaults,
+                               &chart_geomnotify,
+                               &chart_handle,
+                               NULL};
@@ -0,0 +1,331 @@
+#include <string.h>
+#include "ei_console.h"
+#include "ei_stats.h"
+
+#define CONSOLE_MARGIN 2
+
+ei_widget_t* console_alloc(void)
+{
+        ei_console_t *console = (ei_console_t*) ei_calloc(1, sizeof(ei_console_t));
+        console->color = ei_calloc(1, sizeof(ei_color_t));
+        console->text_color = ei_calloc(1, sizeof(ei_color_t));
+        console->text_font = ei_calloc(1, sizeof(ei_font_t));
+        console->capacity = ei_calloc(1, sizeof(int));
+        return (ei_widget_t*) console;
+}
+
+/**
+ * @brief	Releases the text of a line and its rendered text.
+ *
+ * @param	line		The line.
+ */
+static void free_line(ei_console_line_t* line)
+{
+        free(line->text);
+        if (line->surface != NULL) hw_surface_free(line->surface);
+        line->text = NULL;
+        line->surface = NULL;
+}
+
+/**
+ * @brief	Returns the number of the oldest line kept by a console.
+ *
+ * @param	console		The console.
+ *
+ * @return			The number of the line, or the number of lines if there is none.
+ */
+static long first_line(const ei_console_t* console)
+{
+        return (console->total > console->line_capacity) ? console->total - console->line_capacity : 0;
+}
+
+void console_release(ei_widget_t* widget)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        for (long line = first_line(console); line < console->total; line++)
+                free_line(&console->lines[line % console->line_capacity]);
+        free(console->lines);
+        free(console->color);
+        free(console->text_color);
+        free(console->text_font);
+        free(console->capacity);
+        free(console);
+}
+
+/**
+ * @brief	Releases the rendered text of all the lines of a console, which is rendered again
+ *		when the lines are drawn.
+ *
+ * @param	console		The console.
+ */
+static void release_surfaces(ei_console_t* console)
+{
+        for (long line = first_line(console); line < console->total; line++) {
+                ei_console_line_t *kept = &console->lines[line % console->line_capacity];
+                if (kept->surface != NULL) hw_surface_free(kept->surface);
+                kept->surface = NULL;
+        }
+}
+
+/**
+ * @brief	Changes the number of lines kept by a console, keeping the most recent ones.
+ *
+ * @param	console		The console.
+ */
+static void resize_lines(ei_console_t* console)
+{
+        ei_console_line_t *lines = ei_calloc((size_t) *console->capacity, sizeof(ei_console_line_t));
+        long first = (console->total > *console->capacity) ? console->total - *console->capacity : 0;
+        for (long line = first_line(console); line < console->total; line++) {
+                ei_console_line_t *kept = &console->lines[line % console->line_capacity];
+                if (line < first) {
+                        free_line(kept);
+                } else {
+                        lines[line % *console->capacity] = *kept;
+                }
+        }
+        free(console->lines);
+        console->lines = lines;
+        console->line_capacity = *console->capacity;
+}
+
+/**
+ * @brief	Returns the number of rows of lines a console shows, the top one may be cut.
+ *
+ * @param	console		The console.
+ *
+ * @return			The number of rows.
+ */
+static long visible_rows(const ei_console_t* console)
+{
+        int height = console->widget.screen_location.size.height;
+        return (height > 0) ? (height + console->line_height - 1) / console->line_height : 0;
+}
+
+/**
+ * @brief	Draws a line of a console, rendering its text if it is not already.
+ *
+ * @param	console		The console.
+ * @param	line		The line.
+ * @param	where		The top left corner of the text.
+ * @param	surface		Where to draw the line, *locked* by \ref hw_surface_lock.
+ * @param	clipper		The drawing must be restricted within this rectangle.
+ */
+static void draw_line(ei_console_t* console, ei_console_line_t* line, ei_point_t where,
+                      ei_surface_t surface, ei_rect_t* clipper)
+{
+        if (line->text[0] == '\0') return;
+        if (line->surface == NULL) {
+                line->surface = hw_text_create_surface(line->text, *console->text_font, *console->text_color);
+                ei_stats.text_surfaces++;
+                if (line->surface == NULL) return;
+        }
+        ei_rect_t text_rect = {where, hw_surface_get_size(line->surface)};
+        ei_rect_t dst_rect = rectangle_intersect(clipper, &text_rect);
+        if (dst_rect.size.width <= 0 || dst_rect.size.height <= 0) return;
+        ei_rect_t src_rect = {{dst_rect.top_left.x - where.x, dst_rect.top_left.y - where.y}, dst_rect.size};
+        hw_surface_lock(line->surface);
+        ei_copy_surface(surface, &dst_rect, line->surface, &src_rect, EI_TRUE);
+        hw_surface_unlock(line->surface);
+}
+
+void console_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+                  ei_rect_t* clipper)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        ei_rect_t console_clipper = rectangle_intersect(clipper, &widget->screen_location);
+        if (console_clipper.size.width <= 0 || console_clipper.size.height <= 0) return;
+
+        ei_fill_with_pick(surface, console->color, pick_surface, widget->pick_color, &console_clipper);
+
+        // Only the lines in the clipper are drawn, the last one at the bottom
+        int bottom = widget->screen_location.top_left.y + widget->screen_location.size.height;
+        int clipper_bottom = console_clipper.top_left.y + console_clipper.size.height;
+        long first = console->total - (bottom - console_clipper.top_left.y + console->line_height - 1) /
+                                      console->line_height;
+        long last = console->total - 1 - (bottom - clipper_bottom) / console->line_height;
+        if (first < first_line(console)) first = first_line(console);
+        for (long line = first; line <= last; line++) {
+                ei_point_t where = {widget->screen_location.top_left.x + CONSOLE_MARGIN,
+                                    bottom - (int) (console->total - line) * console->line_height};
+                // A line never draws over the next one, which may be drawn apart
+                ei_rect_t row = {{widget->screen_location.top_left.x, where.y},
+                                 {widget->screen_location.size.width, console->line_height}};
+                ei_rect_t row_clipper = rectangle_intersect(&console_clipper, &row);
+                draw_line(console, &console->lines[line % console->line_capacity], where, surface,
+                          &row_clipper);
+        }
+}
+
+/**
+ * @brief	Computes the height of the lines of a console from its font.
+ *
+ * @param	console		The console.
+ */
+static void update_line_height(ei_console_t* console)
+{
+        int width = 0;
+        int height = 0;
+        hw_text_compute_size("Mg", *console->text_font, &width, &height);
+        console->line_height = (height > 0) ? height : 1;
+}
+
+void console_setdefaults(ei_widget_t* widget)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        widget->requested_size = ei_size(400, 200);
+        *console->color = ei_default_background_color;
+        *console->text_color = ei_font_default_color;
+        *console->text_font = ei_default_font;
+        *console->capacity = 1000;
+        update_line_height(console);
+        resize_lines(console);
+}
+
+void console_geomnotify(ei_widget_t* widget, ei_rect_t rect)
+{
+
+}
+
+ei_bool_t console_handle(ei_widget_t* widget, ei_event_t* event)
+{
+        return EI_FALSE;
+}
+
+ei_bool_t console_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        *opaque = widget->screen_location;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Configures the attributes of widgets of the class "console".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget. Defaults to 400x200.
+ * @param	color		The color of the background. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	text_color	The color of the text. Defaults to \ref ei_font_default_color.
+ * @param	text_font	The font of the text. Defaults to \ref ei_default_font.
+ * @param	capacity	The number of lines kept. The older ones are dropped. Defaults to 1000.
+ */
+void ei_console_configure (ei_widget_t* widget,
+                           ei_size_t* requested_size,
+                           const ei_color_t* color,
+                           const ei_color_t* text_color,
+                           ei_font_t* text_font,
+                           int* capacity)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(console->color, color, sizeof(ei_color_t));
+        // The lines are rendered again with a new color or font
+        ei_bool_t text_changed = EI_FALSE;
+        text_changed |= update_field(console->text_color, text_color, sizeof(ei_color_t));
+        text_changed |= update_field(console->text_font, text_font, sizeof(ei_font_t));
+        if (text_changed) {
+                release_surfaces(console);
+                update_line_height(console);
+                changed = EI_TRUE;
+        }
+        if (update_field(console->capacity, capacity, sizeof(int))) {
+                if (*console->capacity < 1) *console->capacity = 1;
+                resize_lines(console);
+                changed = EI_TRUE;
+        }
+        if (requested_size != NULL) widget->requested_size = *requested_size;
+        ei_widget_configured(widget, changed, old_requested_size);
+}
+
+/**
+ * @brief	Redraws the rows of some lines of a console, where they are visible.
+ *
+ * @param	widget		The console.
+ * @param	first, last	The numbers of the first and the last line.
+ */
+static void invalidate_lines(ei_widget_t* widget, long first, long last)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        ei_rect_t *rect = &widget->screen_location;
+        long bottom = rect->top_left.y + rect->size.height;
+        long y0 = bottom - (console->total - first) * console->line_height;
+        long y1 = bottom - (console->total - last - 1) * console->line_height;
+        if (y0 < rect->top_left.y) y0 = rect->top_left.y;
+        if (y1 <= y0) return;
+        ei_rect_t lines_rect = {{rect->top_left.x, (int) y0}, {rect->size.width, (int) (y1 - y0)}};
+        ei_widget_invalidate_rect(widget, &lines_rect);
+}
+
+/**
+ * \brief	Appends lines to a console. The lines already there are scrolled up once for all
+ *		the lines of the text: a burst of lines is faster to append in one call.
+ *
+ * @param	widget		The console.
+ * @param	text		The lines, separated by '\n'. They are copied.
+ */
+void ei_console_append(ei_widget_t* widget, const char* text)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        long old_total = console->total;
+        long old_first = first_line(console);
+        const char *start = text;
+        for (;;) {
+                const char *end = strchr(start, '\n');
+                size_t length = (end != NULL) ? (size_t) (end - start) : strlen(start);
+                // The oldest line is dropped
+                ei_console_line_t *line = &console->lines[console->total % console->line_capacity];
+                free_line(line);
+                line->text = ei_malloc(length + 1);
+                memcpy(line->text, start, length);
+                line->text[length] = '\0';
+                console->total++;
+                if (end == NULL) break;
+                start = end + 1;
+        }
+
+        // The lines scrolled out of the console do not keep their rendered text
+        long rows = visible_rows(console);
+        long hidden = old_total - rows;
+        if (hidden < first_line(console)) hidden = first_line(console);
+        for (; hidden < console->total - rows; hidden++) {
+                ei_console_line_t *line = &console->lines[hidden % console->line_capacity];
+                if (line->surface != NULL) hw_surface_free(line->surface);
+                line->surface = NULL;
+        }
+
+        // The lines already drawn are moved up, only the new rows, which the move exposes,
+        // are drawn, and the rows of the lines dropped are cleared
+        long height = (console->total - old_total) * console->line_height;
+        if (height >= widget->screen_location.size.height) {
+                ei_widget_invalidate(widget);
+                return;
+        }
+        ei_widget_scroll_rect(widget, &widget->screen_location, 0, (int) -height);
+        if (first_line(console) > old_first) invalidate_lines(widget, old_first, first_line(console) - 1);
+}
+
+/**
+ * \brief	Removes all the lines of a console.
+ *
+ * @param	widget		The console.
+ */
+void ei_console_clear(ei_widget_t* widget)
+{
+        ei_console_t *console = (ei_console_t*) widget;
+        for (long line = first_line(console); line < console->total; line++)
+                free_line(&console->lines[line % console->line_capacity]);
+        console->total = 0;
+        ei_widget_invalidate(widget);
+}
+
+ei_widgetclass_t consoleclass = {"console",
+                                 &console_alloc,
+                                 &console_release,
+                                 &console_draw,
+                                 &console_setdefaults,
+                                 &console_geomnotify,
+                                 &console_handle,
+                                 NULL};
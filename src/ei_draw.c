@@ -1,7 +1,28 @@
+#include <string.h>
+#include "ei_application.h"
 #include "ei_draw.h"
 #include "ei_drawing_tools.h"
+#include "ei_overdraw.h"
+#include "ei_picking.h"
+#include "ei_record.h"
+#include "ei_stats.h"
+#include "ei_trace.h"
 #include "ei_utils.h"
 
+/**
+ * @brief	Counts a write to one pixel for the overdraw measure, if the counting is on.
+ *
+ * @param	surface		The surface written to.
+ * @param	offset		The offset of the pixel in the buffer of the surface.
+ * @param	width		The width of the surface.
+ */
+static inline void count_pixel(ei_surface_t surface, long offset, int width)
+{
+        if (!ei_overdraw_enabled) return;
+        ei_rect_t pixel = {{(int) (offset % width), (int) (offset / width)}, {1, 1}};
+        ei_overdraw_record(surface, &pixel);
+}
+
 /**
  * \brief	Draws a line that can be made of many line segments.
  *
@@ -16,6 +37,10 @@
  */
 void ei_draw_polyline(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
                       const ei_rect_t* clipper){
+        if (ei_record_capturing(surface)) {
+                ei_record_polyline(surface, first_point, color, clipper);
+                return;
+        }
         const ei_linked_point_t *head = first_point;
         ei_size_t surf_size = hw_surface_get_size(surface);
         uint32_t *rst_pixel_ptr = (uint32_t *) hw_surface_get_buffer(surface);
@@ -41,11 +66,13 @@ void ei_draw_polyline(ei_surface_t surface, const ei_linked_point_t* first_point
                                                 i += surf_size.width;
                                         }
                                         if (!clipper ||
-                                            (clipper->top_left.y <(pixel_ptr-rst_pixel_ptr)/surf_size.width &&
+                                            (clipper->top_left.y <= (pixel_ptr-rst_pixel_ptr)/surf_size.width &&
                                              (pixel_ptr-rst_pixel_ptr)/surf_size.width< clipper->top_left.y+clipper->size.height &&
-                                             clipper->top_left.x <(pixel_ptr-rst_pixel_ptr)%surf_size.width&&
+                                             clipper->top_left.x <= (pixel_ptr-rst_pixel_ptr)%surf_size.width&&
                                              (pixel_ptr-rst_pixel_ptr)%surf_size.width< clipper->top_left.x+clipper->size.width)){
                                                 *pixel_ptr = ei_map_rgba(surface, color);
+                                                ei_stats.polyline_pixels++;
+                                                count_pixel(surface, pixel_ptr - rst_pixel_ptr, surf_size.width);
                                         }
                                 }
                         } else {
@@ -58,11 +85,13 @@ void ei_draw_polyline(ei_surface_t surface, const ei_linked_point_t* first_point
                                                 i++;
                                         }
                                         if (!clipper ||
-                                            (clipper->top_left.y <(pixel_ptr-rst_pixel_ptr)/surf_size.width &&
+                                            (clipper->top_left.y <= (pixel_ptr-rst_pixel_ptr)/surf_size.width &&
                                              (pixel_ptr-rst_pixel_ptr)/surf_size.width< clipper->top_left.y+clipper->size.height &&
-                                             clipper->top_left.x <(pixel_ptr-rst_pixel_ptr)%surf_size.width&&
+                                             clipper->top_left.x <= (pixel_ptr-rst_pixel_ptr)%surf_size.width&&
                                              (pixel_ptr-rst_pixel_ptr)%surf_size.width< clipper->top_left.x+clipper->size.width)){
                                                 *pixel_ptr = ei_map_rgba(surface, color);
+                                                ei_stats.polyline_pixels++;
+                                                count_pixel(surface, pixel_ptr - rst_pixel_ptr, surf_size.width);
                                         }
                                 }
                         }
@@ -70,6 +99,8 @@ void ei_draw_polyline(ei_surface_t surface, const ei_linked_point_t* first_point
                 } while(first_point->next && first_point!=head);
         } else if (first_point) {
                 *rst_pixel_ptr = ei_map_rgba(surface, color);
+                ei_stats.polyline_pixels++;
+                count_pixel(surface, 0, surf_size.width);
         }
 
 }
@@ -104,14 +135,12 @@ static void update_ast(struct side_table** ast, struct side_table** st, int32_t
                 if (!prev) {
                         if ((*ast)->y_max<=y) {
                                 head = tmp;
-                                free(*ast);
                         } else {
                                 prev = *ast;
                         }
                 } else {
                         if ((*ast)->y_max <= y) {
                                 (prev)->next = tmp;
-                                free(*ast);
                         } else {
                                 prev = *ast;
                         }
@@ -148,26 +177,104 @@ static void update_ast(struct side_table** ast, struct side_table** st, int32_t
 }
 
 /**
- * \brief	Draws a filled polygon.
+ * @brief	Copies a polygon rasterized in the offscreen to a surface and stores its pick ID
+ *		in the picking offscreen, in one pass over the pixels.
  *
- * @param	surface 	Where to draw the polygon. The surface must be *locked* by
- *				\ref hw_surface_lock.
- * @param	first_point 	The head of a linked list of the points of the line. It is either
- *				NULL (i.e. draws nothing), or has more than 2 points. The last point
- *				is implicitly connected to the first point, i.e. polygons are
- *				closed, it is not necessary to repeat the first point.
- * @param	color		The color used to draw the polygon. The alpha channel is managed.
- * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ * @param	surface		The surface of the polygon.
+ * @param	dst_rect	Where to copy the polygon in the surface.
+ * @param	offscreen	The offscreen where the polygon was rasterized.
+ * @param	src_rect	The polygon in the offscreen.
+ * @param	id		The pick ID to store where the polygon is.
  */
-void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
-                     const ei_rect_t* clipper)
+static void copy_polygon_with_id(ei_surface_t surface, const ei_rect_t* dst_rect, ei_surface_t offscreen,
+                                 const ei_rect_t* src_rect, uint32_t id)
 {
+        int ir, ig, ib, ia;
+        hw_surface_get_channel_indices(offscreen, &ir, &ig, &ib, &ia);
+        uint32_t alpha_mask = (uint32_t) 0xff << (ia * 8);
+        int dst_width = hw_surface_get_size(surface).width;
+        int src_width = hw_surface_get_size(offscreen).width;
+        uint32_t *dst_pixels = (uint32_t*) hw_surface_get_buffer(surface);
+        uint32_t *src_pixels = (uint32_t*) hw_surface_get_buffer(offscreen);
+
+        // The offscreen is either transparent or opaque: the same result as a blended copy
+        for (int32_t j = 0; j < dst_rect->size.height; j++) {
+                int y = dst_rect->top_left.y + j;
+                uint32_t *dst_row = dst_pixels + y * dst_width + dst_rect->top_left.x;
+                uint32_t *src_row = src_pixels + (src_rect->top_left.y + j) * src_width + src_rect->top_left.x;
+                int run_start = -1;
+                for (int32_t i = 0; i <= dst_rect->size.width; i++) {
+                        ei_bool_t inside = (i < dst_rect->size.width && (src_row[i] & alpha_mask));
+                        if (inside) {
+                                dst_row[i] = src_row[i] & ~alpha_mask;
+                                if (run_start < 0) run_start = i;
+                                continue;
+                        }
+                        if (i < dst_rect->size.width) dst_row[i] &= ~alpha_mask;
+                        if (run_start >= 0) {
+                                ei_rect_t run = {{dst_rect->top_left.x + run_start, y}, {i - run_start, 1}};
+                                ei_picking_fill(&run, id);
+                                run_start = -1;
+                        }
+                }
+        }
+}
+
+/**
+ * @brief	Copies a polygon rasterized in the offscreen to its surface, where it is not
+ *		transparent. In the picking offscreen, the ID of the color is stored instead.
+ *
+ * @param	surface		The surface of the polygon.
+ * @param	dst_rect	Where to copy the polygon in the surface.
+ * @param	offscreen	The offscreen where the polygon was rasterized.
+ * @param	src_rect	The polygon in the offscreen.
+ * @param	color		The color of the polygon.
+ * @param	pick_surface	If not NULL, the picking offscreen, where the polygon is also drawn.
+ * @param	pick_color	The pick color of the polygon in pick_surface.
+ */
+static void copy_polygon(ei_surface_t surface, const ei_rect_t* dst_rect, ei_surface_t offscreen,
+                         const ei_rect_t* src_rect, ei_color_t color, ei_surface_t pick_surface,
+                         const ei_color_t* pick_color)
+{
+        if (ei_picking_is_buffer(surface)) {
+                ei_stats.pixels_blended += (unsigned long) dst_rect->size.width * dst_rect->size.height;
+                ei_overdraw_count(surface, dst_rect);
+                ei_picking_fill_mask(dst_rect, offscreen, src_rect, color_to_id(color));
+        } else if (pick_surface != NULL && ei_picking_is_buffer(pick_surface)) {
+                ei_stats.pixels_blended += (unsigned long) dst_rect->size.width * dst_rect->size.height;
+                ei_overdraw_count(surface, dst_rect);
+                ei_overdraw_count(pick_surface, dst_rect);
+                copy_polygon_with_id(surface, dst_rect, offscreen, src_rect, color_to_id(*pick_color));
+        } else {
+                ei_copy_surface(surface, dst_rect, offscreen, src_rect, 1);
+                if (pick_surface != NULL) copy_polygon(pick_surface, dst_rect, offscreen, src_rect,
+                                                       *pick_color, NULL, NULL);
+        }
+}
+
+/**
+ * @brief	Rasterizes a polygon, see \ref ei_draw_polygon and \ref ei_draw_polygon_with_pick.
+ */
+static void draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                         ei_surface_t pick_surface, const ei_color_t* pick_color, const ei_rect_t* clipper)
+{
+        if (ei_record_capturing(surface)) {
+                ei_record_polygon(surface, first_point, color, pick_surface, pick_color, clipper);
+                return;
+        }
+        ei_trace_begin("ei_draw_polygon");
         if (first_point && first_point->next && first_point->next->next) {
+                ei_stats.polygons++;
                 const struct ei_linked_point_t *loop_first_p = first_point;
-                ei_size_t surf_size = hw_surface_get_size(surface);
+                // The picking offscreen is not a surface: the polygon is rasterized like for the root
+                ei_bool_t picking = ei_picking_is_buffer(surface);
+                ei_surface_t model = picking ? ei_app_root_surface() : surface;
+                ei_size_t surf_size = hw_surface_get_size(model);
 
                 // INIT side_table
-                struct side_table **st = calloc(sizeof(struct side_table *), surf_size.height);
+                // The side table and its sides live in the frame arena, until the end of the call
+                ei_arena_mark_t arena_mark = ei_arena_get_mark();
+                struct side_table **st = ei_arena_alloc(sizeof(struct side_table *) * (size_t) surf_size.height);
                 int32_t glob_y_min = surf_size.height; int32_t glob_x_min = surf_size.width;
                 int32_t glob_y_max = 0; int32_t glob_x_max = 0;
 
@@ -181,7 +288,7 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
                                 continue;
                         }
 
-                        struct side_table *curr_st = calloc(1, sizeof(struct side_table));
+                        struct side_table *curr_st = ei_arena_alloc(sizeof(struct side_table));
                         int32_t y_min, y_max, x_min, x_max;
 
                         if (second_point->point.y > first_point->point.y) {
@@ -204,7 +311,6 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
 
                         if (y_max < 1 || y_min >= surf_size.height) {
                                 first_point = first_point->next;
-                                free(curr_st);
                                 continue;
                         }
                         // get the global max and min to compute the size
@@ -213,6 +319,7 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
                         glob_x_min = (x_min < glob_x_min) ? x_min : glob_x_min;
                         glob_x_max = (x_max > glob_x_max) ? x_max : glob_x_max;
 
+                        ei_stats.polygon_edges++;
                         curr_st->y_max = y_max;
                         curr_st->args[0] = 0;
                         curr_st->args[1] = second_point->point.x - first_point->point.x;
@@ -278,8 +385,8 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
                 if (glob_y_max > 0) offscreen_size = ei_size(glob_x_max - glob_x_min, glob_y_max - glob_y_min);
                 else offscreen_size = ei_size(0,0);
 
-                ei_surface_t offscreen = hw_surface_create(surface, offscreen_size, 1);
-                hw_surface_lock(offscreen);
+                ei_surface_t offscreen = get_polygon_offscreen(model, offscreen_size);
+                int32_t offscreen_width = hw_surface_get_size(offscreen).width;
                 uint32_t *rst_pixel_ptr = (uint32_t *) hw_surface_get_buffer(offscreen);
                 // as we use the transparency channel, verify that the color to draw has a max alpha
                 // channel
@@ -295,8 +402,7 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
                         struct side_table *curr_ast = ast;
                         while (curr_ast) {
                                 int32_t x = curr_ast->xk_min-glob_x_min;
-                                uint32_t *pixel_ptr = rst_pixel_ptr + (y-glob_y_min)*offscreen_size
-                                        .width + x;
+                                uint32_t *pixel_ptr = rst_pixel_ptr + (y-glob_y_min)*offscreen_width + x;
                                 for (; x <
                                        curr_ast->next->xk_min-glob_x_min; pixel_ptr++, x++) {
                                         *pixel_ptr = ei_map_rgba(offscreen, offscreen_color);
@@ -346,13 +452,7 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
                         ast = head;
                 }
 
-                struct side_table *tmp;
-                while (ast != NULL) {
-                        tmp = ast->next;
-                        free(ast);
-                        ast = tmp;
-                }
-                free(st);
+                ei_arena_rewind(arena_mark);
 
                 // copy the surface drawn on the offscreen to the main surface thanks to transparency
                 ei_rect_t offscreen_rect = {{glob_x_min,glob_y_min}, offscreen_size};
@@ -360,21 +460,61 @@ void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point,
                 if (clipper) {
                         intersection = rectangle_intersect(clipper, &offscreen_rect);
 
+                        // The clipper can cut the polygon on any side, not only on the far one
                         ei_point_t new_origin_start;
-                        new_origin_start.x = (glob_x_min > clipper->top_left.x) ? 0 :
-                                             offscreen_size.width - intersection.size.width;
-                        new_origin_start.y = (glob_y_min > clipper->top_left.y) ? 0 :
-                                             offscreen_size.height - intersection.size.height;
+                        new_origin_start.x = intersection.top_left.x - glob_x_min;
+                        new_origin_start.y = intersection.top_left.y - glob_y_min;
                         ei_rect_t zero_intersect = {new_origin_start, intersection.size};
-                        ei_copy_surface(surface, &intersection, offscreen, &zero_intersect, 1);
+                        copy_polygon(surface, &intersection, offscreen, &zero_intersect, color,
+                                     pick_surface, pick_color);
                 } else {
                         intersection = offscreen_rect;
                         ei_rect_t zero_intersect = {ei_point_zero(), intersection.size};
-                        ei_copy_surface(surface, &intersection, offscreen, &zero_intersect, 1);
+                        copy_polygon(surface, &intersection, offscreen, &zero_intersect, color,
+                                     pick_surface, pick_color);
                 }
                 hw_surface_unlock(offscreen);
-                hw_surface_free(offscreen);
         }
+        ei_trace_end("ei_draw_polygon");
+}
+
+/**
+ * \brief	Draws a filled polygon.
+ *
+ * @param	surface 	Where to draw the polygon. The surface must be *locked* by
+ *				\ref hw_surface_lock. It can also be the picking offscreen, where the
+ *				pick ID encoded in the color is stored.
+ * @param	first_point 	The head of a linked list of the points of the line. It is either
+ *				NULL (i.e. draws nothing), or has more than 2 points. The last point
+ *				is implicitly connected to the first point, i.e. polygons are
+ *				closed, it is not necessary to repeat the first point.
+ * @param	color		The color used to draw the polygon. The alpha channel is managed.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_draw_polygon(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                     const ei_rect_t* clipper)
+{
+        draw_polygon(surface, first_point, color, NULL, NULL, clipper);
+}
+
+/**
+ * \brief	Draws a filled polygon in a surface and in the picking offscreen at once: the
+ *		polygon is rasterized once, and the pick ID is stored in the same pass as the
+ *		color. Same as \ref ei_draw_polygon in both, but faster.
+ *
+ * @param	surface 	Where to draw the polygon. The surface must be *locked* by
+ *				\ref hw_surface_lock.
+ * @param	first_point 	The points of the polygon, see \ref ei_draw_polygon.
+ * @param	color		The color used to draw the polygon in surface.
+ * @param	pick_surface	The picking offscreen, or NULL to only draw in surface.
+ * @param	pick_color	The pick color of the widget, which encodes its pick ID.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_draw_polygon_with_pick(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                               ei_surface_t pick_surface, const ei_color_t* pick_color,
+                               const ei_rect_t* clipper)
+{
+        draw_polygon(surface, first_point, color, pick_surface, pick_color, clipper);
 }
 
 /**
@@ -401,15 +541,31 @@ uint32_t ei_map_rgba (ei_surface_t surface, ei_color_t color)
  * \brief	Fills the surface with the specified color.
  *
  * @param	surface		The surface to be filled. The surface must be *locked* by
- *				\ref hw_surface_lock.
+ *				\ref hw_surface_lock. It can also be the picking offscreen, where the
+ *				pick ID encoded in the color is stored.
  * @param	color		The color used to fill the surface. If NULL, it means that the
  *				caller want it painted black (opaque).
  * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
  */
 void ei_fill (ei_surface_t surface, const ei_color_t* color, const ei_rect_t* clipper)
 {
+        if (ei_record_capturing(surface)) {
+                ei_record_fill(surface, color, clipper);
+                return;
+        }
+        ei_overdraw_count(surface, clipper);
+        // The picking offscreen stores the ID, decoded once from the pick color
+        if (ei_picking_is_buffer(surface)) {
+                ei_rect_t pick_rect = ei_picking_get_rect();
+                const ei_rect_t *area = (clipper != NULL) ? clipper : &pick_rect;
+                ei_stats.pixels_filled += (unsigned long) area->size.width * area->size.height;
+                ei_picking_fill(clipper, (color != NULL) ? color_to_id(*color) : 0);
+                return;
+        }
+
         ei_size_t surf_size = hw_surface_get_size(surface);
         if (clipper) {
+                ei_stats.pixels_filled += (unsigned long) clipper->size.width * clipper->size.height;
                 uint32_t *rst_pixel_ptr = (uint32_t*) hw_surface_get_buffer(surface);
                 for (int32_t j=0; j<clipper->size.height;j++) {
                         uint32_t *pixel_ptr = rst_pixel_ptr + clipper->top_left.x +
@@ -418,6 +574,7 @@ void ei_fill (ei_surface_t surface, const ei_color_t* color, const ei_rect_t* cl
                                 *pixel_ptr = ei_map_rgba(surface, *color);
                 }
         } else {
+                ei_stats.pixels_filled += (unsigned long) surf_size.width * surf_size.height;
                 uint32_t *pixel_ptr = (uint32_t*) hw_surface_get_buffer(surface);
                 for (int32_t i = 0; i < (surf_size.width * surf_size.height); i++) {
                         *pixel_ptr = ei_map_rgba(surface, *color);
@@ -427,28 +584,52 @@ void ei_fill (ei_surface_t surface, const ei_color_t* color, const ei_rect_t* cl
 }
 
 /**
- * \brief	Copies pixels from a source surface to a destination surface.
- *		The source and destination areas of the copy (either the entire surfaces, or
- *		subparts) must have the same size before considering clipping.
- *		Both surfaces must be *locked* by \ref hw_surface_lock.
+ * \brief	Fills a rectangle of a surface and of the picking offscreen at once: the clipper
+ *		is read once, and each row of pick IDs is stored after the row of colors. Same
+ *		as \ref ei_fill in both.
  *
- * @param	destination	The surface on which to copy pixels.
- * @param	dst_rect	If NULL, the entire destination surface is used. If not NULL,
- *				defines the rectangle on the destination surface where to copy
- *				the pixels.
- * @param	source		The surface from which to copy pixels.
- * @param	src_rect	If NULL, the entire source surface is used. If not NULL, defines the
- *				rectangle on the source surface from which to copy the pixels.
- * @param	alpha		If true, the final pixels are a combination of source and
- *				destination pixels weighted by the source alpha channel and
- *				the transparency of the final pixels is set to opaque.
- *				If false, the final pixels are an exact copy of the source pixels,
- 				including the alpha channel.
- *
- * @return			Returns 0 on success, 1 on failure (different sizes between source and destination).
+ * @param	surface		The surface to be filled. The surface must be *locked* by
+ *				\ref hw_surface_lock.
+ * @param	color		The color used to fill the surface.
+ * @param	pick_surface	The picking offscreen, or NULL to only fill surface.
+ * @param	pick_color	The pick color of the widget, which encodes its pick ID.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
  */
-int ei_copy_surface (ei_surface_t destination, const ei_rect_t* dst_rect, ei_surface_t source,
-                     const ei_rect_t* src_rect, ei_bool_t alpha)
+void ei_fill_with_pick (ei_surface_t surface, const ei_color_t* color, ei_surface_t pick_surface,
+                        const ei_color_t* pick_color, const ei_rect_t* clipper)
+{
+        if (ei_record_capturing(surface)) {
+                ei_record_fill_with_pick(surface, color, pick_surface, pick_color, clipper);
+                return;
+        }
+        if (!ei_picking_is_buffer(pick_surface)) {
+                ei_fill(surface, color, clipper);
+                if (pick_surface != NULL) ei_fill(pick_surface, pick_color, clipper);
+                return;
+        }
+
+        ei_size_t surf_size = hw_surface_get_size(surface);
+        ei_rect_t area = (clipper != NULL) ? *clipper : ei_rect(ei_point_zero(), surf_size);
+        ei_overdraw_count(surface, &area);
+        ei_overdraw_count(pick_surface, &area);
+        ei_stats.pixels_filled += 2 * (unsigned long) area.size.width * area.size.height;
+
+        uint32_t pixel = ei_map_rgba(surface, *color);
+        uint32_t id = color_to_id(*pick_color);
+        uint32_t *rst_pixel_ptr = (uint32_t*) hw_surface_get_buffer(surface);
+        for (int32_t j = 0; j < area.size.height; j++) {
+                uint32_t *pixel_ptr = rst_pixel_ptr + area.top_left.x + (j + area.top_left.y) * surf_size.width;
+                for (int32_t i = 0; i < area.size.width; i++, pixel_ptr++) *pixel_ptr = pixel;
+                ei_rect_t row = {{area.top_left.x, area.top_left.y + j}, {area.size.width, 1}};
+                ei_picking_fill(&row, id);
+        }
+}
+
+/**
+ * @brief	Copies pixels, see \ref ei_copy_surface.
+ */
+static int copy_surface(ei_surface_t destination, const ei_rect_t* dst_rect, ei_surface_t source,
+                        const ei_rect_t* src_rect, ei_bool_t alpha)
 {
         ei_size_t true_dest_size = hw_surface_get_size(destination);
         ei_size_t dest_size = true_dest_size;
@@ -466,6 +647,8 @@ int ei_copy_surface (ei_surface_t destination, const ei_rect_t* dst_rect, ei_sur
                 src_size = src_rect->size;
         }
         if (dest_size.width != src_size.width || dest_size.height != src_size.height) return 1;
+        if (alpha) ei_stats.pixels_blended += (unsigned long) dest_size.width * dest_size.height;
+        else ei_stats.pixels_copied += (unsigned long) dest_size.width * dest_size.height;
 
         for (int32_t j = 0; j < dest_size.height; j++) {
                 uint32_t *pst_pixel_ptr = dest_pixel_ptr + j * true_dest_size.width;
@@ -496,6 +679,160 @@ int ei_copy_surface (ei_surface_t destination, const ei_rect_t* dst_rect, ei_sur
         return 0;
 }
 
+/**
+ * \brief	Copies pixels from a source surface to a destination surface.
+ *		The source and destination areas of the copy (either the entire surfaces, or
+ *		subparts) must have the same size before considering clipping.
+ *		Both surfaces must be *locked* by \ref hw_surface_lock.
+ *
+ * @param	destination	The surface on which to copy pixels.
+ * @param	dst_rect	If NULL, the entire destination surface is used. If not NULL,
+ *				defines the rectangle on the destination surface where to copy
+ *				the pixels.
+ * @param	source		The surface from which to copy pixels.
+ * @param	src_rect	If NULL, the entire source surface is used. If not NULL, defines the
+ *				rectangle on the source surface from which to copy the pixels.
+ * @param	alpha		If true, the final pixels are a combination of source and
+ *				destination pixels weighted by the source alpha channel and
+ *				the transparency of the final pixels is set to opaque.
+ *				If false, the final pixels are an exact copy of the source pixels,
+ 				including the alpha channel.
+ *
+ * @return			Returns 0 on success, 1 on failure (different sizes between source and destination).
+ */
+int ei_copy_surface (ei_surface_t destination, const ei_rect_t* dst_rect, ei_surface_t source,
+                     const ei_rect_t* src_rect, ei_bool_t alpha)
+{
+        if (ei_record_capturing(destination)) return ei_record_copy(destination, dst_rect, source, src_rect, alpha);
+        ei_trace_begin("ei_copy_surface");
+        int result = copy_surface(destination, dst_rect, source, src_rect, alpha);
+        if (result == 0) ei_overdraw_count(destination, dst_rect);
+        ei_trace_end("ei_copy_surface");
+        return result;
+}
+
+/**
+ * @brief	Clips a sprite to its image and to the area drawn.
+ *
+ * @param	sprite		The sprite.
+ * @param	atlas_rect	The rectangle of the image.
+ * @param	area		The area drawn.
+ * @param	dst_rect	Where to store the rectangle drawn.
+ * @param	src_origin	Where to store the top left corner of the pixels of the image drawn there.
+ *
+ * @return			EI_FALSE if nothing is drawn.
+ */
+static ei_bool_t clip_sprite(const ei_sprite_t* sprite, ei_rect_t* atlas_rect, ei_rect_t* area,
+                             ei_rect_t* dst_rect, ei_point_t* src_origin)
+{
+        ei_rect_t src_rect = sprite->src_rect;
+        ei_rect_t in_atlas = rectangle_intersect(atlas_rect, &src_rect);
+        ei_rect_t placed = {{sprite->where.x + in_atlas.top_left.x - src_rect.top_left.x,
+                             sprite->where.y + in_atlas.top_left.y - src_rect.top_left.y}, in_atlas.size};
+        *dst_rect = rectangle_intersect(area, &placed);
+        if (in_atlas.size.width <= 0 || in_atlas.size.height <= 0 ||
+            dst_rect->size.width <= 0 || dst_rect->size.height <= 0) return EI_FALSE;
+        src_origin->x = in_atlas.top_left.x + dst_rect->top_left.x - placed.top_left.x;
+        src_origin->y = in_atlas.top_left.y + dst_rect->top_left.y - placed.top_left.y;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Blends a row of pixels as \ref ei_copy_surface does, but only computes the
+ *		pixels that are neither transparent nor opaque.
+ *
+ * @param	dst		The pixels of the destination.
+ * @param	src		The pixels of the source.
+ * @param	width		The number of pixels.
+ * @param	ir, ig, ib, ia	The channel indices of the source.
+ */
+static void blend_row(uint32_t* dst, const uint32_t* src, int width, int ir, int ig, int ib, int ia)
+{
+        uint32_t alpha_mask = (uint32_t) 0xff << (ia * 8);
+        for (int i = 0; i < width; i++) {
+                uint32_t alpha_src = (src[i] >> (ia * 8)) & 0xff;
+                if (alpha_src == 0xff) {
+                        dst[i] = src[i] & ~alpha_mask;
+                } else if (alpha_src == 0) {
+                        dst[i] &= ~alpha_mask;
+                } else {
+                        uint32_t red = (((src[i] >> (ir * 8)) & 0xff) * alpha_src +
+                                        ((dst[i] >> (ir * 8)) & 0xff) * (255 - alpha_src)) / 255;
+                        uint32_t green = (((src[i] >> (ig * 8)) & 0xff) * alpha_src +
+                                          ((dst[i] >> (ig * 8)) & 0xff) * (255 - alpha_src)) / 255;
+                        uint32_t blue = (((src[i] >> (ib * 8)) & 0xff) * alpha_src +
+                                         ((dst[i] >> (ib * 8)) & 0xff) * (255 - alpha_src)) / 255;
+                        dst[i] = (red << (ir * 8)) + (green << (ig * 8)) + (blue << (ib * 8));
+                }
+        }
+}
+
+/**
+ * \brief	Draws many parts of the same image at once, e.g. the icons of a board. The image
+ *		is locked once, and the sprites are clipped and drawn in one pass, in the order
+ *		given. Where the image has an alpha channel, the sprites are blended as by
+ *		\ref ei_copy_surface, the transparent and opaque pixels being only copied or
+ *		skipped. Otherwise, their rows are copied.
+ *
+ * @param	surface		Where to draw the sprites. The surface must be *locked* by
+ *				\ref hw_surface_lock.
+ * @param	atlas		The image the sprites are taken from, with the same channel order
+ *				as surface. It must not be locked.
+ * @param	sprites		The sprites.
+ * @param	count		The number of sprites.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_draw_sprites(ei_surface_t surface, ei_surface_t atlas, const ei_sprite_t* sprites, int count,
+                     const ei_rect_t* clipper)
+{
+        ei_rect_t area = hw_surface_get_rect(surface);
+        if (clipper != NULL) {
+                ei_rect_t clip = *clipper;
+                area = rectangle_intersect(&area, &clip);
+        }
+        if (count <= 0 || area.size.width <= 0 || area.size.height <= 0) return;
+        ei_rect_t atlas_rect = {ei_point_zero(), hw_surface_get_size(atlas)};
+        int ir, ig, ib, ia;
+        hw_surface_get_channel_indices(atlas, &ir, &ig, &ib, &ia);
+        ei_rect_t dst_rect;
+        ei_point_t src_origin;
+
+        if (ei_record_capturing(surface)) {
+                for (int i = 0; i < count; i++) {
+                        if (!clip_sprite(&sprites[i], &atlas_rect, &area, &dst_rect, &src_origin)) continue;
+                        ei_rect_t src_rect = {src_origin, dst_rect.size};
+                        ei_record_copy(surface, &dst_rect, atlas, &src_rect, ia != -1);
+                }
+                return;
+        }
+
+        ei_trace_begin("ei_draw_sprites");
+        hw_surface_lock(atlas);
+        int surface_width = hw_surface_get_size(surface).width;
+        uint32_t *surface_pixels = (uint32_t*) hw_surface_get_buffer(surface);
+        uint32_t *atlas_pixels = (uint32_t*) hw_surface_get_buffer(atlas);
+        for (int i = 0; i < count; i++) {
+                if (!clip_sprite(&sprites[i], &atlas_rect, &area, &dst_rect, &src_origin)) continue;
+                ei_overdraw_count(surface, &dst_rect);
+                uint32_t *dst = surface_pixels + dst_rect.top_left.y * surface_width + dst_rect.top_left.x;
+                uint32_t *src = atlas_pixels + src_origin.y * atlas_rect.size.width + src_origin.x;
+                unsigned long pixels = (unsigned long) dst_rect.size.width * dst_rect.size.height;
+                if (ia == -1) {
+                        ei_stats.pixels_copied += pixels;
+                        for (int j = 0; j < dst_rect.size.height; j++)
+                                memcpy(dst + j * surface_width, src + j * atlas_rect.size.width,
+                                       (size_t) dst_rect.size.width * sizeof(uint32_t));
+                } else {
+                        ei_stats.pixels_blended += pixels;
+                        for (int j = 0; j < dst_rect.size.height; j++)
+                                blend_row(dst + j * surface_width, src + j * atlas_rect.size.width,
+                                          dst_rect.size.width, ir, ig, ib, ia);
+                }
+        }
+        hw_surface_unlock(atlas);
+        ei_trace_end("ei_draw_sprites");
+}
+
 /**
  * \brief	Draws text by calling \ref hw_text_create_surface.
  *
@@ -512,9 +849,15 @@ int ei_copy_surface (ei_surface_t destination, const ei_rect_t* dst_rect, ei_sur
 void ei_draw_text (ei_surface_t	surface, const ei_point_t* where, const char* text, ei_font_t font,
                    ei_color_t color, const ei_rect_t* clipper)
 {
+        if (ei_record_capturing(surface)) {
+                ei_record_text(surface, where, text, font, color, clipper);
+                return;
+        }
         if (text == NULL) return;
         if (font == NULL) font = ei_default_font;
+        ei_trace_begin("ei_draw_text");
         ei_surface_t text_surface = hw_text_create_surface(text, font, color);
+        ei_stats.text_surfaces++;
         ei_size_t text_size = hw_surface_get_size(text_surface);
         ei_rect_t positioned_rect = {*where, text_size};
         // Find the intersection of two rectangles
@@ -533,4 +876,5 @@ void ei_draw_text (ei_surface_t	surface, const ei_point_t* where, const char* te
                 ei_copy_surface(surface,&positioned_rect, text_surface, &text_rect, 1);
         }
         hw_surface_free(text_surface);
+        ei_trace_end("ei_draw_text");
 }
\ No newline at end of file
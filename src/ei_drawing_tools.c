@@ -1,5 +1,8 @@
+#include <string.h>
 #include "ei_drawing_tools.h"
 
+static ei_surface_t polygon_offscreen = NULL;
+
 /**
  * Returns a lighter version of the color passed as argument.
  *
@@ -40,11 +43,11 @@ ei_color_t get_dark_color_variation(const ei_color_t* color)
  *                              This function uses anticlockwise direction and fin_angle needs
  *                              to be higher than init_angle.
  *
- * @return			The list of points describing the arc.
+ * @return			The list of points describing the arc, allocated in the frame arena.
  */
 ei_linked_point_t *arc(ei_point_t center, int radius, float init_angle, float fin_angle)
 {
-        ei_linked_point_t *new_arc = malloc(sizeof(struct ei_linked_point_t));
+        ei_linked_point_t *new_arc = ei_arena_alloc(sizeof(struct ei_linked_point_t));
         ei_point_t first_point = ei_point((int) floorf((float) center.x + (float) radius * cosf(init_angle)),
                                           (int) floorf((float) center.y - (float) radius * sinf(init_angle)));
         new_arc->point = first_point;
@@ -56,7 +59,7 @@ ei_linked_point_t *arc(ei_point_t center, int radius, float init_angle, float fi
         while (angle < fin_angle) {
                 ei_point_t new_point = ei_point((int) floorf((float) center.x + (float) radius * cosf(angle)),
                                                 (int) floorf((float) center.y - (float) radius * sinf(angle)));
-                struct ei_linked_point_t *next = malloc(sizeof(struct ei_linked_point_t));
+                struct ei_linked_point_t *next = ei_arena_alloc(sizeof(struct ei_linked_point_t));
                 next->point = new_point;
                 sent->next = next;
                 sent = sent->next;
@@ -65,7 +68,7 @@ ei_linked_point_t *arc(ei_point_t center, int radius, float init_angle, float fi
 
         ei_point_t final_point = ei_point((int)floorf((float) center.x + (float) radius * cosf(fin_angle)),
                                           (int)floorf((float) center.y - (float) radius * sinf(fin_angle)));
-        struct ei_linked_point_t *end = malloc(sizeof(struct ei_linked_point_t));
+        struct ei_linked_point_t *end = ei_arena_alloc(sizeof(struct ei_linked_point_t));
         end->point = final_point;
         end->next = NULL;
         sent->next = end;
@@ -80,7 +83,8 @@ ei_linked_point_t *arc(ei_point_t center, int radius, float init_angle, float fi
  * @param	radius          Radius of the rounded corners.
  * @param	part 	        The part to describe.
  *
- * @return			The list of points describing the rounded frame.
+ * @return			The list of points describing the rounded frame, allocated in the frame
+ *				arena.
  */
 ei_linked_point_t *rounded_frame(ei_rect_t rectangle, int radius, char part)
 {
@@ -112,9 +116,9 @@ ei_linked_point_t *rounded_frame(ei_rect_t rectangle, int radius, char part)
                 curr->next = arc(center_arc, radius, (float) M_PI, 5 * (float) M_PI_4);
                 while (curr->next != NULL) curr = curr->next;
 
-                struct ei_linked_point_t *middle_pt_r = malloc(sizeof(struct ei_linked_point_t));
+                struct ei_linked_point_t *middle_pt_r = ei_arena_alloc(sizeof(struct ei_linked_point_t));
                 middle_pt_r->point = ei_point(rectangle.top_left.x + rectangle.size.width - (int)(rectangle.size.height/2), rectangle.top_left.y + (int)(rectangle.size.height/2));
-                struct ei_linked_point_t *middle_pt_l = malloc(sizeof(struct ei_linked_point_t));
+                struct ei_linked_point_t *middle_pt_l = ei_arena_alloc(sizeof(struct ei_linked_point_t));
                 middle_pt_l->point = ei_point(rectangle.top_left.x + (int)(rectangle.size.height/2), rectangle.top_left.y + (int)(rectangle.size.height/2));
                 middle_pt_l->next = middle_pt_r;
                 curr->next = middle_pt_l;
@@ -139,9 +143,9 @@ ei_linked_point_t *rounded_frame(ei_rect_t rectangle, int radius, char part)
                 curr->next = arc(center_arc, radius, 0, (float) M_PI_4);
                 while (curr->next != NULL) curr = curr->next;
 
-                struct ei_linked_point_t *middle_pt_l = malloc(sizeof(struct ei_linked_point_t));
+                struct ei_linked_point_t *middle_pt_l = ei_arena_alloc(sizeof(struct ei_linked_point_t));
                 middle_pt_l->point = ei_point(rectangle.top_left.x + (int)(rectangle.size.height/2), rectangle.top_left.y + (int)(rectangle.size.height/2));
-                struct ei_linked_point_t *middle_pt_r = malloc(sizeof(struct ei_linked_point_t));
+                struct ei_linked_point_t *middle_pt_r = ei_arena_alloc(sizeof(struct ei_linked_point_t));
                 middle_pt_r->point = ei_point(rectangle.top_left.x + rectangle.size.width - (int)(rectangle.size.height/2), rectangle.top_left.y + (int)(rectangle.size.height/2));
                 middle_pt_r->next = middle_pt_l;
                 middle_pt_l->next = NULL;
@@ -212,6 +216,94 @@ ei_rect_t rectangle_intersect(ei_rect_t* first_rect, ei_rect_t* sec_rect)
         return ei_rect_zero();
 }
 
+/**
+ * \brief	Returns the smallest rectangle that contains two rectangles.
+ *
+ * @param	first_rect  	The first rectangle. If NULL, returns sec_rect.
+ * @param	sec_rect        The second rectangle.
+ *
+ * @return			A rectangle which contains both first_rect and sec_rect.
+ */
+ei_rect_t rectangle_union(ei_rect_t* first_rect, ei_rect_t* sec_rect)
+{
+        if (first_rect == NULL) return *sec_rect;
+        int left = (first_rect->top_left.x < sec_rect->top_left.x) ? first_rect->top_left.x : sec_rect->top_left.x;
+        int top = (first_rect->top_left.y < sec_rect->top_left.y) ? first_rect->top_left.y : sec_rect->top_left.y;
+        int first_right = first_rect->top_left.x + first_rect->size.width;
+        int sec_right = sec_rect->top_left.x + sec_rect->size.width;
+        int first_bottom = first_rect->top_left.y + first_rect->size.height;
+        int sec_bottom = sec_rect->top_left.y + sec_rect->size.height;
+        ei_rect_t bounds;
+        bounds.top_left.x = left;
+        bounds.top_left.y = top;
+        bounds.size.width = ((first_right > sec_right) ? first_right : sec_right) - left;
+        bounds.size.height = ((first_bottom > sec_bottom) ? first_bottom : sec_bottom) - top;
+        return bounds;
+}
+
+/**
+ * \brief	Blends a translucent color over a rectangle of a surface: unlike \ref ei_fill, the
+ *		pixels below show through.
+ *
+ * @param	surface		The surface, *locked* by \ref hw_surface_lock.
+ * @param	rect		The rectangle, which must be inside the surface.
+ * @param	color		The color. Its alpha channel is the opacity of the blend.
+ */
+void blend_rect(ei_surface_t surface, const ei_rect_t* rect, ei_color_t color)
+{
+        int ir, ig, ib, ia;
+        hw_surface_get_channel_indices(surface, &ir, &ig, &ib, &ia);
+        ei_size_t surf_size = hw_surface_get_size(surface);
+        uint32_t *buffer = (uint32_t*) hw_surface_get_buffer(surface);
+        uint32_t bitmask = 0xFF;
+        uint32_t alpha = color.alpha;
+        ei_stats.pixels_blended += (unsigned long) rect->size.width * rect->size.height;
+
+        for (int32_t j = 0; j < rect->size.height; j++) {
+                uint32_t *pixel_ptr = buffer + (rect->top_left.y + j) * surf_size.width + rect->top_left.x;
+                for (int32_t i = 0; i < rect->size.width; i++, pixel_ptr++) {
+                        uint32_t red = (*pixel_ptr >> (ir * 8)) & bitmask;
+                        uint32_t green = (*pixel_ptr >> (ig * 8)) & bitmask;
+                        uint32_t blue = (*pixel_ptr >> (ib * 8)) & bitmask;
+                        red = (color.red * alpha + (255 - alpha) * red) / 255;
+                        green = (color.green * alpha + (255 - alpha) * green) / 255;
+                        blue = (color.blue * alpha + (255 - alpha) * blue) / 255;
+                        uint32_t pixel = (red << (ir * 8)) + (green << (ig * 8)) + (blue << (ib * 8));
+                        if (ia != -1) pixel += bitmask << (ia * 8);
+                        *pixel_ptr = pixel;
+                }
+        }
+}
+
+/**
+ * \brief	Moves the pixels of a rectangle of a surface by an offset, in place. Only the
+ *		pixels that stay in the rectangle are moved: the strips that the move exposes
+ *		keep their old pixels.
+ *
+ * @param	surface		The surface, *locked* by \ref hw_surface_lock.
+ * @param	rect		The rectangle, which must be inside the surface.
+ * @param	dx, dy		The offset, smaller than the size of the rectangle.
+ */
+void move_rect(ei_surface_t surface, const ei_rect_t* rect, int dx, int dy)
+{
+        int width = rect->size.width - abs(dx);
+        int height = rect->size.height - abs(dy);
+        if (width <= 0 || height <= 0 || (dx == 0 && dy == 0)) return;
+        int surf_width = hw_surface_get_size(surface).width;
+        uint32_t *buffer = (uint32_t*) hw_surface_get_buffer(surface);
+        int src_x = rect->top_left.x + ((dx < 0) ? -dx : 0);
+        int dst_x = rect->top_left.x + ((dx > 0) ? dx : 0);
+        ei_stats.pixels_copied += (unsigned long) width * height;
+
+        // Rows moving down are copied from the bottom, so that they are read before being overwritten
+        for (int j = 0; j < height; j++) {
+                int row = (dy > 0) ? height - 1 - j : j;
+                int src_y = rect->top_left.y + ((dy < 0) ? -dy : 0) + row;
+                memmove(buffer + (size_t) (src_y + dy) * surf_width + dst_x,
+                        buffer + (size_t) src_y * surf_width + src_x, (size_t) width * sizeof(uint32_t));
+        }
+}
+
 /**
  * \brief	Sets the coordinates of a topleft point regarding the anchor and the size of
  *              the object to anchor.
@@ -265,4 +357,64 @@ void anchoring(ei_anchor_t anchor, ei_point_t* where, ei_rect_t* screen_loc, ei_
                 default:
                         break;
         }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief	Computes a dimension of the polygon offscreen after it has grown: half as big
+ *		again as it was, or as big as needed if it is more.
+ *
+ * @param	current		The dimension of the offscreen.
+ * @param	needed		The dimension of the polygon.
+ * @param	limit		The dimension of the surface, the headroom stops there.
+ *
+ * @return			The new dimension, at least needed.
+ */
+static int grow_dimension(int current, int needed, int limit)
+{
+        if (current >= needed) return current;
+        int grown = current + current / 2;
+        if (grown > limit) grown = limit;
+        return (grown > needed) ? grown : needed;
+}
+
+/**
+ * \brief	Returns the offscreen surface used to rasterize polygons, at least as big as the
+ *		requested size and cleared to transparent over that size. The same surface is
+ *		reused from one polygon to the next, it is only re-created when it is too small.
+ *
+ * @param	surface		The surface the polygon will be copied to, provides the channels order.
+ * @param	size		The size of the polygon.
+ *
+ * @return			The offscreen surface, *locked* by \ref hw_surface_lock.
+ */
+ei_surface_t get_polygon_offscreen(ei_surface_t surface, ei_size_t size)
+{
+        ei_size_t offscreen_size = ei_size_zero();
+        if (polygon_offscreen != NULL) offscreen_size = hw_surface_get_size(polygon_offscreen);
+
+        if (offscreen_size.width < size.width || offscreen_size.height < size.height) {
+                // Grow to the polygon, with some headroom so that slightly bigger polygons
+                // do not create it again, but never beyond the surface size
+                ei_size_t surf_size = hw_surface_get_size(surface);
+                offscreen_size.width = grow_dimension(offscreen_size.width, size.width, surf_size.width);
+                offscreen_size.height = grow_dimension(offscreen_size.height, size.height, surf_size.height);
+                free_polygon_offscreen();
+                polygon_offscreen = hw_surface_create(surface, offscreen_size, EI_TRUE);
+                ei_stats.surfaces_created++;
+        }
+
+        hw_surface_lock(polygon_offscreen);
+        uint32_t *pixel_ptr = (uint32_t*) hw_surface_get_buffer(polygon_offscreen);
+        for (int32_t j = 0; j < size.height; j++)
+                memset(pixel_ptr + j * offscreen_size.width, 0, (size_t) size.width * sizeof(uint32_t));
+        return polygon_offscreen;
+}
+
+/**
+ * \brief	Releases the offscreen surface used to rasterize polygons.
+ */
+void free_polygon_offscreen(void)
+{
+        if (polygon_offscreen != NULL) hw_surface_free(polygon_offscreen);
+        polygon_offscreen = NULL;
+}
@@ -13,31 +13,8 @@ static ei_default_handle_func_t default_handle = NULL;
 static void focus(ei_widget_t *widget)
 {
         while (widget->parent != NULL) {
-                if (strcmp(ei_widgetclass_stringname(widget->wclass->name), "toplevel") == 0) {
-                        if (widget->parent->children_tail != widget) {
-                                if (widget->parent->children_head == widget)
-                                        widget->parent->children_head = widget->next_sibling;
-                                else {
-                                        ei_widget_t sent;
-                                        sent.next_sibling = widget->parent->children_head;
-                                        ei_widget_t *senti = &sent;
-                                        while (senti->next_sibling != widget) senti = senti->next_sibling;
-                                        senti->next_sibling = senti->next_sibling->next_sibling;
-                                }
-                                widget->parent->children_tail->next_sibling = widget;
-                                widget->next_sibling = NULL;
-                                widget->parent->children_tail = widget;
-                                ei_rect_t rect2invalidate = widget->screen_location;
-                                ei_toplevel_t *toplevel = (ei_toplevel_t *) widget;
-                                int title_width = 0;
-                                int title_height = 0;
-                                hw_text_compute_size(*toplevel->title, ei_default_font,
-                                                     &title_width, &title_height);
-                                rect2invalidate.size.height += title_height + 2 * *toplevel->border_width;
-                                rect2invalidate.size.width += 2 * *toplevel->border_width;
-                                ei_app_invalidate_rect(&rect2invalidate);
-                        }
-                }
+                if (strcmp(ei_widgetclass_stringname(widget->wclass->name), "toplevel") == 0)
+                        ei_widget_raise(widget);
                 widget = widget->parent;
         }
 }
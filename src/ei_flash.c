@@ -0,0 +1,199 @@
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_flash.h"
+
+#define FLASH_MAX 256
+
+typedef struct {
+        ei_rect_t rect;
+        double start;           ///< When the rectangle was invalidated, see \ref hw_now.
+        ei_color_t color;
+} flash_t;
+
+static double flash_duration = 0.5;
+static int flash_period_ms = 33;        // Time between two steps of the fading
+static int flash_alpha = 0x90;          // Opacity of the tint of a new flash
+static ei_color_t flash_colors[] = {{0xff, 0x00, 0xff, 0xff}, {0x00, 0xc0, 0xff, 0xff},
+                                    {0xff, 0x80, 0x00, 0xff}, {0x40, 0xff, 0x40, 0xff},
+                                    {0xff, 0x30, 0x30, 0xff}, {0xff, 0xff, 0x00, 0xff}};
+
+static ei_bool_t flash_enabled = EI_FALSE;
+static FILE *flash_log = NULL;
+static ei_bool_t log_set = EI_FALSE;    // Until ei_flash_set_log is called, the log is stderr
+static flash_t flashes[FLASH_MAX];      // Ring of the flashes that are not faded out yet
+static int first_flash = 0;
+static int flash_count = 0;
+static ei_bool_t tick_scheduled = EI_FALSE;
+static ei_bool_t refreshing = EI_FALSE; // The flashes invalidated to fade them are not flashed
+static char tick_marker;                // Parameter of the events that fade the flashes
+
+/**
+ * @brief	Chooses the color of a flash from the place of the call, so that each call site
+ *		always flashes with the same color.
+ *
+ * @param	file, line	The place of the call.
+ *
+ * @return			The color.
+ */
+static ei_color_t site_color(const char* file, int line)
+{
+        unsigned long hash = (unsigned long) line;
+        for (; file != NULL && *file != '\0'; file++) hash = hash * 31 + (unsigned char) *file;
+        return flash_colors[hash % (sizeof(flash_colors) / sizeof(flash_colors[0]))];
+}
+
+/**
+ * @brief	Invalidates every flash, so that they are drawn again with their new opacity.
+ */
+static void invalidate_flashes(void)
+{
+        refreshing = EI_TRUE;
+        for (int i = 0; i < flash_count; i++) ei_app_invalidate_rect(&flashes[(first_flash + i) % FLASH_MAX].rect);
+        refreshing = EI_FALSE;
+}
+
+/**
+ * \brief	Starts or stops the repaint flash mode, to debug what is redrawn: every rectangle
+ *		added to the list of rectangles to update is tinted with a translucent color,
+ *		which fades out in half a second, and the place in the source of the call to
+ *		\ref ei_app_invalidate_rect is logged. The color depends on this place. Off by
+ *		default.
+ *
+ * @param	enabled		EI_TRUE to flash the repainted rectangles.
+ */
+void ei_flash_set_enabled(ei_bool_t enabled)
+{
+        if (enabled == flash_enabled) return;
+        flash_enabled = enabled;
+        if (enabled) return;
+        // The flashes on screen are wiped out
+        if (ei_app_root_widget() != NULL) invalidate_flashes();
+        flash_count = 0;
+}
+
+/**
+ * \brief	Tells if the repaint flash mode is on.
+ *
+ * @return			EI_TRUE if the repainted rectangles are flashed.
+ */
+ei_bool_t ei_flash_is_enabled(void)
+{
+        return flash_enabled;
+}
+
+/**
+ * \brief	Sets where the repaint flash mode logs the invalidated rectangles.
+ *
+ * @param	log		The stream to write to, or NULL to log nothing. Defaults to stderr.
+ */
+void ei_flash_set_log(FILE* log)
+{
+        flash_log = log;
+        log_set = EI_TRUE;
+}
+
+/**
+ * \brief	Records an invalidated rectangle, if the repaint flash mode is on. Called by
+ *		\ref ei_app_invalidate_rect_at.
+ *
+ * @param	rect		The rectangle, clipped to the root window.
+ * @param	file, line	Where the rectangle was invalidated, or NULL and 0 if unknown.
+ * @param	batched		EI_TRUE if the rectangle is merged into a batch (see
+ *				\ref ei_app_batch_begin): it is only logged, the merged
+ *				rectangle is flashed when the batch ends.
+ */
+void ei_flash_record(const ei_rect_t* rect, const char* file, int line, ei_bool_t batched)
+{
+        if (!flash_enabled || refreshing) return;
+
+        FILE *log = log_set ? flash_log : stderr;
+        if (log != NULL) {
+                fprintf(log, "invalidate %d,%d %dx%d at %s:%d%s\n", rect->top_left.x, rect->top_left.y,
+                        rect->size.width, rect->size.height, (file != NULL) ? file : "?", line,
+                        batched ? " (batched)" : "");
+        }
+        if (batched) return;
+
+        // When the ring is full, the oldest flash is wiped out to make room
+        if (flash_count == FLASH_MAX) {
+                refreshing = EI_TRUE;
+                ei_app_invalidate_rect(&flashes[first_flash].rect);
+                refreshing = EI_FALSE;
+                first_flash = (first_flash + 1) % FLASH_MAX;
+                flash_count--;
+        }
+        flash_t *flash = &flashes[(first_flash + flash_count) % FLASH_MAX];
+        flash->rect = *rect;
+        flash->start = hw_now();
+        flash->color = site_color(file, line);
+        flash_count++;
+}
+
+/**
+ * \brief	Handles the events the repaint flash mode schedules to fade out the flashes.
+ *		Called by the main loop for every event.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event was one of these events, and must not be handled.
+ */
+ei_bool_t ei_flash_handle_event(ei_event_t* event)
+{
+        if (event->type != ei_ev_app || event->param.application.user_param != &tick_marker) return EI_FALSE;
+        tick_scheduled = EI_FALSE;
+        if (!flash_enabled) return EI_TRUE;
+
+        // Every flash is drawn again, fainter, and the faded out ones for the last time
+        invalidate_flashes();
+        double now = hw_now();
+        while (flash_count > 0 && now - flashes[first_flash].start >= flash_duration) {
+                first_flash = (first_flash + 1) % FLASH_MAX;
+                flash_count--;
+        }
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Tints the flashes that are not faded out yet, within the rectangles drawn in this
+ *		frame. Called by the main loop after the widgets are drawn, before the screen is
+ *		updated.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rects		The rectangles drawn in this frame.
+ */
+void ei_flash_draw(ei_surface_t surface, const ei_linked_rect_t* rects)
+{
+        if (!flash_enabled || flash_count == 0) return;
+
+        // Outside of the rectangles drawn in this frame, the tint is already on screen
+        double now = hw_now();
+        for (int i = 0; i < flash_count; i++) {
+                flash_t *flash = &flashes[(first_flash + i) % FLASH_MAX];
+                double age = now - flash->start;
+                if (age >= flash_duration) continue;
+                ei_color_t color = flash->color;
+                color.alpha = (unsigned char) (flash_alpha * (1.0 - age / flash_duration));
+                for (const ei_linked_rect_t *drawn = rects; drawn != NULL; drawn = drawn->next) {
+                        ei_rect_t rect = rectangle_intersect(&flash->rect, (ei_rect_t*) &drawn->rect);
+                        if (rect.size.width <= 0 || rect.size.height <= 0) continue;
+                        blend_rect(surface, &rect, color);
+                }
+        }
+
+        // The main loop waits for events: the fading is driven by scheduled ones
+        if (!tick_scheduled) {
+                hw_event_schedule_app(flash_period_ms, &tick_marker);
+                tick_scheduled = EI_TRUE;
+        }
+}
+
+/**
+ * \brief	Forgets the flashes, and turns the repaint flash mode off.
+ */
+void ei_flash_free(void)
+{
+        flash_enabled = EI_FALSE;
+        first_flash = 0;
+        flash_count = 0;
+        tick_scheduled = EI_FALSE;
+}
@@ -4,17 +4,17 @@ static int default_frame_border_width = 0;
 
 ei_widget_t* frame_alloc (void)
 {
-        ei_frame_t *frame = (ei_frame_t*) calloc(1, sizeof(ei_frame_t));
-        frame->color = calloc(1, sizeof(ei_color_t));
-        frame->border_width = calloc(1, sizeof(int));
-        frame->relief = calloc(1, sizeof(ei_relief_t));
-        frame->text = calloc(1, sizeof(char*));
-        frame->text_font = calloc(1, sizeof(ei_font_t));
-        frame->text_color = calloc(1, sizeof(ei_color_t));
-        frame->text_anchor = calloc(1, sizeof(ei_anchor_t));
-        frame->img = calloc(1, sizeof(ei_surface_t));
-        frame->img_rect = calloc(1,sizeof(ei_rect_t*));
-        frame->img_anchor = calloc(1, sizeof(ei_anchor_t));
+        ei_frame_t *frame = (ei_frame_t*) ei_calloc(1, sizeof(ei_frame_t));
+        frame->color = ei_calloc(1, sizeof(ei_color_t));
+        frame->border_width = ei_calloc(1, sizeof(int));
+        frame->relief = ei_calloc(1, sizeof(ei_relief_t));
+        frame->text = ei_calloc(1, sizeof(char*));
+        frame->text_font = ei_calloc(1, sizeof(ei_font_t));
+        frame->text_color = ei_calloc(1, sizeof(ei_color_t));
+        frame->text_anchor = ei_calloc(1, sizeof(ei_anchor_t));
+        frame->img = ei_calloc(1, sizeof(ei_surface_t));
+        frame->img_rect = ei_calloc(1,sizeof(ei_rect_t*));
+        frame->img_anchor = ei_calloc(1, sizeof(ei_anchor_t));
         return (ei_widget_t*) frame;
 }
 
@@ -63,42 +63,49 @@ void frame_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_sur
         }
 
 
-        ei_color_t light_color = get_light_color_variation(color);
-        ei_color_t dark_color = get_dark_color_variation(color);
         ei_rect_t frame_content = rectangle_intersect(clipper,frame->widget.content_rect);
-        ei_fill(surface,color,&frame_content);
-        ei_fill(pick_surface,frame->widget.pick_color,&frame_content);
-        if (*relief != ei_relief_none) {
-                ei_rect_t top_h_bar = {frame->widget.screen_location.top_left, {frame->widget
-                .screen_location.size.width,*frame->border_width}};
-                ei_rect_t top_v_bar = {frame->widget.screen_location.top_left, {*frame->border_width,
-                frame->widget.screen_location.size.height-*frame->border_width}};
-                ei_rect_t bot_h_bar = {{frame->widget.screen_location.top_left.x,frame->widget.screen_location.top_left.y +
-                frame->widget.screen_location.size.height-*frame->border_width},{frame->widget.screen_location
-                .size.width-*frame->border_width,*frame->border_width}};
-                ei_rect_t bot_v_bar = {{frame->widget.screen_location.top_left.x+
-                frame->widget.screen_location.size.width-*frame->border_width,frame->widget
-                .screen_location.top_left.y+*frame->border_width},{*frame->border_width,frame->widget
-                .screen_location.size
-                .height-*frame->border_width}};
-                ei_rect_t frame_top_h_part = rectangle_intersect(clipper, &top_h_bar);
-                ei_rect_t frame_top_v_part = rectangle_intersect(clipper, &top_v_bar);
-                ei_rect_t frame_bot_h_part = rectangle_intersect(clipper, &bot_h_bar);
-                ei_rect_t frame_bot_v_part = rectangle_intersect(clipper, &bot_v_bar);
-                if (*relief == ei_relief_raised) {
-                        // draw top part
-                        ei_fill(surface, &light_color, &frame_top_h_part);
-                        ei_fill(surface, &light_color, &frame_top_v_part);
-                        // draw bottom part
-                        ei_fill(surface, &dark_color, &frame_bot_h_part);
-                        ei_fill(surface, &dark_color, &frame_bot_v_part);
-                } else {
-                        // draw top part
-                        ei_fill(surface, &dark_color, &frame_top_h_part);
-                        ei_fill(surface, &dark_color, &frame_top_v_part);
-                        // draw bottom part
-                        ei_fill(surface, &light_color, &frame_bot_h_part);
-                        ei_fill(surface, &light_color, &frame_bot_v_part);
+        ei_skin_t *skin = NULL;
+        if (*relief != ei_relief_none) skin = ei_skin_get(color, *border_width, 0, *relief, EI_FALSE);
+
+        if (skin != NULL && ei_skin_fits(skin, rectangle)) {
+                ei_skin_draw(surface, skin, rectangle, clipper);
+                ei_fill(pick_surface,frame->widget.pick_color,&frame_content);
+        } else {
+                ei_color_t light_color = get_light_color_variation(color);
+                ei_color_t dark_color = get_dark_color_variation(color);
+                ei_fill_with_pick(surface, color, pick_surface, frame->widget.pick_color, &frame_content);
+                if (*relief != ei_relief_none) {
+                        ei_rect_t top_h_bar = {frame->widget.screen_location.top_left, {frame->widget
+                        .screen_location.size.width,*frame->border_width}};
+                        ei_rect_t top_v_bar = {frame->widget.screen_location.top_left, {*frame->border_width,
+                        frame->widget.screen_location.size.height-*frame->border_width}};
+                        ei_rect_t bot_h_bar = {{frame->widget.screen_location.top_left.x,frame->widget.screen_location.top_left.y +
+                        frame->widget.screen_location.size.height-*frame->border_width},{frame->widget.screen_location
+                        .size.width-*frame->border_width,*frame->border_width}};
+                        ei_rect_t bot_v_bar = {{frame->widget.screen_location.top_left.x+
+                        frame->widget.screen_location.size.width-*frame->border_width,frame->widget
+                        .screen_location.top_left.y+*frame->border_width},{*frame->border_width,frame->widget
+                        .screen_location.size
+                        .height-*frame->border_width}};
+                        ei_rect_t frame_top_h_part = rectangle_intersect(clipper, &top_h_bar);
+                        ei_rect_t frame_top_v_part = rectangle_intersect(clipper, &top_v_bar);
+                        ei_rect_t frame_bot_h_part = rectangle_intersect(clipper, &bot_h_bar);
+                        ei_rect_t frame_bot_v_part = rectangle_intersect(clipper, &bot_v_bar);
+                        if (*relief == ei_relief_raised) {
+                                // draw top part
+                                ei_fill(surface, &light_color, &frame_top_h_part);
+                                ei_fill(surface, &light_color, &frame_top_v_part);
+                                // draw bottom part
+                                ei_fill(surface, &dark_color, &frame_bot_h_part);
+                                ei_fill(surface, &dark_color, &frame_bot_v_part);
+                        } else {
+                                // draw top part
+                                ei_fill(surface, &dark_color, &frame_top_h_part);
+                                ei_fill(surface, &dark_color, &frame_top_v_part);
+                                // draw bottom part
+                                ei_fill(surface, &light_color, &frame_bot_h_part);
+                                ei_fill(surface, &light_color, &frame_bot_v_part);
+                        }
                 }
         }
 
@@ -164,6 +171,13 @@ ei_bool_t frame_handle(ei_widget_t* widget, ei_event_t* event)
         return EI_FALSE;
 }
 
+ei_bool_t frame_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        // The face and the relief bars overwrite every pixel of the frame
+        *opaque = widget->screen_location;
+        return EI_TRUE;
+}
+
 ei_widgetclass_t frameclass = {"frame",
                                &frame_alloc,
                                &frame_release,
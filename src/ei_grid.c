@@ -0,0 +1,249 @@
+#include "ei_grid.h"
+
+static ei_size_t default_grid_cell_size = {16, 16};
+static int default_grid_spacing = 1;
+
+ei_widget_t* grid_alloc(void)
+{
+        ei_grid_t *grid = (ei_grid_t*) ei_calloc(1, sizeof(ei_grid_t));
+        grid->rows = ei_calloc(1, sizeof(int));
+        grid->cols = ei_calloc(1, sizeof(int));
+        grid->cell_size = ei_calloc(1, sizeof(ei_size_t));
+        grid->spacing = ei_calloc(1, sizeof(int));
+        grid->color = ei_calloc(1, sizeof(ei_color_t));
+        grid->drawfunc = ei_calloc(1, sizeof(ei_grid_drawfunc_t));
+        grid->handlefunc = ei_calloc(1, sizeof(ei_grid_handlefunc_t));
+        grid->user_param = ei_calloc(1, sizeof(void*));
+        return (ei_widget_t*) grid;
+}
+
+void grid_release(ei_widget_t* widget)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        free(grid->rows);
+        free(grid->cols);
+        free(grid->cell_size);
+        free(grid->spacing);
+        free(grid->color);
+        free(grid->drawfunc);
+        free(grid->handlefunc);
+        free(grid->user_param);
+        free(grid);
+}
+
+/**
+ * @brief	Finds the range of cells crossed by a segment, along one axis.
+ *
+ * @param	from, length	The segment, relative to the top left corner of the grid.
+ * @param	cell		The size of a cell along this axis.
+ * @param	spacing		The space between the cells.
+ * @param	count		The number of cells along this axis.
+ * @param	first, last	Where to store the first and last cells crossed.
+ *
+ * @return			EI_FALSE if no cell is crossed.
+ */
+static ei_bool_t cell_range(int from, int length, int cell, int spacing, int count, int* first, int* last)
+{
+        int pitch = cell + spacing;
+        if (length <= 0 || count <= 0 || pitch <= 0) return EI_FALSE;
+        int start = from - spacing;
+        int end = from + length - 1 - spacing;
+        if (end < 0) return EI_FALSE;
+        *first = (start < 0) ? 0 : start / pitch;
+        *last = end / pitch;
+        if (*last >= count) *last = count - 1;
+        return (*first <= *last) ? EI_TRUE : EI_FALSE;
+}
+
+void grid_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+               ei_rect_t* clipper)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        ei_rect_t grid_clipper = rectangle_intersect(clipper, &widget->screen_location);
+        if (grid_clipper.size.width <= 0 || grid_clipper.size.height <= 0) return;
+
+        // The cells are not widgets: the whole grid picks as one widget
+        ei_fill_with_pick(surface, grid->color, pick_surface, widget->pick_color, &grid_clipper);
+        if (*grid->drawfunc == NULL) return;
+
+        // Only visit the cells that intersect the clipper
+        int first_row, last_row, first_col, last_col;
+        ei_point_t origin = widget->screen_location.top_left;
+        if (!cell_range(grid_clipper.top_left.y - origin.y, grid_clipper.size.height,
+                        grid->cell_size->height, *grid->spacing, *grid->rows, &first_row, &last_row)) return;
+        if (!cell_range(grid_clipper.top_left.x - origin.x, grid_clipper.size.width,
+                        grid->cell_size->width, *grid->spacing, *grid->cols, &first_col, &last_col)) return;
+
+        for (int row = first_row; row <= last_row; row++) {
+                for (int col = first_col; col <= last_col; col++) {
+                        ei_rect_t cell_rect = ei_grid_cell_rect(widget, row, col);
+                        ei_rect_t cell_clipper = rectangle_intersect(&grid_clipper, &cell_rect);
+                        if (cell_clipper.size.width <= 0 || cell_clipper.size.height <= 0) continue;
+                        (*grid->drawfunc)(widget, row, col, surface, &cell_rect, &cell_clipper,
+                                          *grid->user_param);
+                }
+        }
+}
+
+void grid_setdefaults(ei_widget_t* widget)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        *grid->rows = 0;
+        *grid->cols = 0;
+        *grid->cell_size = default_grid_cell_size;
+        *grid->spacing = default_grid_spacing;
+        *grid->color = ei_default_background_color;
+        *grid->drawfunc = NULL;
+        *grid->handlefunc = NULL;
+        *grid->user_param = NULL;
+}
+
+void grid_geomnotify(ei_widget_t* widget, ei_rect_t rect)
+{
+
+}
+
+ei_bool_t grid_handle(ei_widget_t* widget, ei_event_t* event)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        ei_bool_t handled = EI_FALSE;
+        int row, col;
+
+        if (event->type == ei_ev_mouse_buttondown || event->type == ei_ev_mouse_buttonup ||
+            event->type == ei_ev_mouse_move) {
+                if (*grid->handlefunc != NULL && ei_grid_cell_at(widget, &event->param.mouse.where, &row, &col))
+                        handled = (*grid->handlefunc)(widget, row, col, event, *grid->user_param);
+                if (event->type == ei_ev_mouse_buttonup) {
+                        ei_event_set_active_widget(NULL);
+                        handled = EI_TRUE;
+                }
+        }
+        return handled;
+}
+
+ei_bool_t grid_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        // The spacing color is filled below the cells
+        *opaque = widget->screen_location;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Configures the attributes of widgets of the class "grid".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for this widget. Defaults to the size of all the
+ *				cells and their spacing.
+ * @param	rows, cols	The number of rows and columns of cells. Default to 0.
+ * @param	cell_size	The size of every cell. Defaults to 16x16.
+ * @param	spacing		The space in pixels between the cells and around them. Defaults to 1.
+ * @param	color		The color of the space between the cells. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	drawfunc	The function called to draw a cell. Defaults to NULL (cells are
+ *				not drawn).
+ * @param	handlefunc	The function called for mouse events over a cell. Defaults to NULL.
+ * @param	user_param	The cell data model, passed to drawfunc and handlefunc. Defaults to NULL.
+ */
+void ei_grid_configure (ei_widget_t* widget,
+                        ei_size_t* requested_size,
+                        int* rows,
+                        int* cols,
+                        ei_size_t* cell_size,
+                        int* spacing,
+                        const ei_color_t* color,
+                        ei_grid_drawfunc_t* drawfunc,
+                        ei_grid_handlefunc_t* handlefunc,
+                        void** user_param)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(grid->rows, rows, sizeof(int));
+        changed |= update_field(grid->cols, cols, sizeof(int));
+        changed |= update_field(grid->cell_size, cell_size, sizeof(ei_size_t));
+        changed |= update_field(grid->spacing, spacing, sizeof(int));
+        changed |= update_field(grid->color, color, sizeof(ei_color_t));
+        changed |= update_field(grid->drawfunc, drawfunc, sizeof(ei_grid_drawfunc_t));
+        // The handle function is not drawn: changing it needs no redraw
+        update_field(grid->handlefunc, handlefunc, sizeof(ei_grid_handlefunc_t));
+        changed |= update_field(grid->user_param, user_param, sizeof(void*));
+        if (requested_size != NULL) {
+                widget->requested_size = *requested_size;
+        } else {
+                widget->requested_size.width = *grid->cols * (grid->cell_size->width + *grid->spacing) +
+                                               *grid->spacing;
+                widget->requested_size.height = *grid->rows * (grid->cell_size->height + *grid->spacing) +
+                                                *grid->spacing;
+        }
+        ei_widget_configured(widget, changed, old_requested_size);
+}
+
+/**
+ * \brief	Returns the location on screen of a cell of a grid.
+ *
+ * @param	widget		The grid.
+ * @param	row, col	The cell.
+ *
+ * @return			The rectangle of the cell, in the root window coordinates.
+ */
+ei_rect_t ei_grid_cell_rect(ei_widget_t* widget, int row, int col)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        ei_rect_t cell_rect;
+        cell_rect.top_left.x = widget->screen_location.top_left.x + *grid->spacing +
+                               col * (grid->cell_size->width + *grid->spacing);
+        cell_rect.top_left.y = widget->screen_location.top_left.y + *grid->spacing +
+                               row * (grid->cell_size->height + *grid->spacing);
+        cell_rect.size = *grid->cell_size;
+        return cell_rect;
+}
+
+/**
+ * \brief	Finds the cell of a grid at a given location on screen.
+ *
+ * @param	widget		The grid.
+ * @param	where		The location, in the root window coordinates.
+ * @param	row, col	Where to store the cell.
+ *
+ * @return			EI_FALSE if the location is outside of the cells (including
+ *				the spacing between them).
+ */
+ei_bool_t ei_grid_cell_at(ei_widget_t* widget, const ei_point_t* where, int* row, int* col)
+{
+        ei_grid_t *grid = (ei_grid_t*) widget;
+        int pitch_x = grid->cell_size->width + *grid->spacing;
+        int pitch_y = grid->cell_size->height + *grid->spacing;
+        int x = where->x - widget->screen_location.top_left.x - *grid->spacing;
+        int y = where->y - widget->screen_location.top_left.y - *grid->spacing;
+
+        if (x < 0 || y < 0 || pitch_x <= 0 || pitch_y <= 0) return EI_FALSE;
+        // Points in the spacing after a cell belong to no cell
+        if (x % pitch_x >= grid->cell_size->width || y % pitch_y >= grid->cell_size->height) return EI_FALSE;
+        if (x / pitch_x >= *grid->cols || y / pitch_y >= *grid->rows) return EI_FALSE;
+        *col = x / pitch_x;
+        *row = y / pitch_y;
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Tells the grid a cell has changed: only this cell is redrawn.
+ *
+ * @param	widget		The grid.
+ * @param	row, col	The cell.
+ */
+void ei_grid_invalidate_cell(ei_widget_t* widget, int row, int col)
+{
+        ei_rect_t cell_rect = ei_grid_cell_rect(widget, row, col);
+        ei_widget_invalidate_rect(widget, &cell_rect);
+}
+
+ei_widgetclass_t gridclass = {"grid",
+                              &grid_alloc,
+                              &grid_release,
+                              &grid_draw,
+                              &grid_setdefaults,
+                              &grid_geomnotify,
+                              &grid_handle,
+                              NULL};
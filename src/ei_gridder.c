@@ -0,0 +1,289 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ei_drawing_tools.h"
+#include "ei_gridder.h"
+#include "ei_stats.h"
+#include "ei_trace.h"
+#include "ei_widget.h"
+
+/**
+ * @brief	Returns the rows and columns of the children of a widget, creating them the
+ *		first time.
+ *
+ * @param	parent		The widget.
+ *
+ * @return			Its rows and columns.
+ */
+static ei_gridder_t* get_gridder(struct ei_widget_t* parent)
+{
+        if (parent->placer_params->gridder == NULL) {
+                parent->placer_params->gridder = ei_calloc(1, sizeof(ei_gridder_t));
+                parent->placer_params->gridder->dirty = EI_TRUE;
+        }
+        return parent->placer_params->gridder;
+}
+
+/**
+ * @brief	Makes sure that a line exists in an array of rows or columns, growing it if needed.
+ *
+ * @param	lines		The array.
+ * @param	count		The number of lines in use, updated to include the line.
+ * @param	capacity	The number of lines allocated.
+ * @param	index		The line.
+ *
+ * @return			The line.
+ */
+static ei_gridder_line_t* get_line(ei_gridder_line_t** lines, int* count, int* capacity, int index)
+{
+        if (index >= *capacity) {
+                int size = (*capacity > 0) ? *capacity : 8;
+                while (size <= index) size *= 2;
+                ei_gridder_line_t *grown = ei_calloc((size_t) size, sizeof(ei_gridder_line_t));
+                if (*lines != NULL) memcpy(grown, *lines, (size_t) *capacity * sizeof(ei_gridder_line_t));
+                free(*lines);
+                *lines = grown;
+                *capacity = size;
+        }
+        if (index >= *count) *count = index + 1;
+        return &(*lines)[index];
+}
+
+/**
+ * @brief	Computes the sizes and offsets of rows or columns: each line gets the size it
+ *		needs, then the space left is shared according to the weights. The shares are
+ *		rounded so that they add up to all the space left.
+ *
+ * @param	lines		The lines, which size is what they need.
+ * @param	count		The number of lines.
+ * @param	available	The space available for all the lines.
+ */
+static void distribute(ei_gridder_line_t* lines, int count, int available)
+{
+        long needed = 0;
+        long weights = 0;
+        for (int i = 0; i < count; i++) {
+                needed += lines[i].size;
+                weights += lines[i].weight;
+        }
+        long extra = available - needed;
+        long weight_before = 0;
+        int offset = 0;
+        for (int i = 0; i < count; i++) {
+                if (extra > 0 && weights > 0 && lines[i].weight > 0) {
+                        long given_before = extra * weight_before / weights;
+                        weight_before += lines[i].weight;
+                        lines[i].size += (int) (extra * weight_before / weights - given_before);
+                }
+                lines[i].offset = offset;
+                offset += lines[i].size;
+        }
+}
+
+/**
+ * @brief	Computes the rows and columns of the children of a widget, in one pass over its
+ *		children.
+ *
+ * @param	parent		The widget.
+ * @param	gridder		Its rows and columns.
+ */
+static void solve(struct ei_widget_t* parent, ei_gridder_t* gridder)
+{
+        ei_trace_begin("ei_gridder_solve");
+        for (int i = 0; i < gridder->row_count; i++) gridder->rows[i].size = gridder->rows[i].min_size;
+        for (int i = 0; i < gridder->column_count; i++) gridder->columns[i].size = gridder->columns[i].min_size;
+
+        for (ei_widget_t *child = parent->children_head; child != NULL; child = child->next_sibling) {
+                ei_gridder_params_t *params = child->placer_params->grid;
+                if (params == NULL) continue;
+                ei_gridder_line_t *row = get_line(&gridder->rows, &gridder->row_count,
+                                                  &gridder->row_capacity, params->row);
+                ei_gridder_line_t *column = get_line(&gridder->columns, &gridder->column_count,
+                                                     &gridder->column_capacity, params->column);
+                int height = child->requested_size.height + 2 * params->padding;
+                int width = child->requested_size.width + 2 * params->padding;
+                if (height > row->size) row->size = height;
+                if (width > column->size) column->size = width;
+        }
+
+        gridder->solved_size = parent->content_rect->size;
+        distribute(gridder->rows, gridder->row_count, gridder->solved_size.height);
+        distribute(gridder->columns, gridder->column_count, gridder->solved_size.width);
+        gridder->dirty = EI_FALSE;
+        ei_trace_end("ei_gridder_solve");
+}
+
+/**
+ * @brief	Asks for the rows and columns of the children of a widget to be computed again,
+ *		and for the widget to be redrawn.
+ *
+ * @param	parent		The widget.
+ */
+static void relayout(struct ei_widget_t* parent)
+{
+        if (parent == NULL) return;
+        get_gridder(parent)->dirty = EI_TRUE;
+        ei_widget_invalidate(parent);
+}
+
+/**
+ * \brief	Configures the geometry of a widget using the "gridder" geometry manager: the
+ *		content rect of the parent is split into rows and columns, and the widget is put
+ *		in one of the cells.
+ *
+ *		A row is as high as the highest widget placed in it, padding included, and at
+ *		least as its minimum size. The same goes for the width of a column. The space left
+ *		in the parent is shared between the rows and the columns according to their
+ *		weights, see \ref ei_gridder_configure_row.
+ *
+ *		If the widget was already managed by the "gridder", then arguments that are not
+ *		NULL replace previous values. Otherwise, the widget stops being managed by the
+ *		"placer".
+ *
+ * @param	widget		The widget to place.
+ * @param	row		The row of the cell (defaults to 0).
+ * @param	column		The column of the cell (defaults to 0).
+ * @param	padding		The space in pixels kept around the widget in its cell (defaults to 0).
+ * @param	fill		If EI_TRUE, the widget takes the whole cell. If EI_FALSE, it keeps its
+ *				requested size (defaults to EI_TRUE).
+ * @param	anchor		Where the widget is in its cell when it does not fill it (defaults
+ *				to ei_anc_center).
+ */
+void ei_gridder_place(struct ei_widget_t* widget, int* row, int* column, int* padding, ei_bool_t* fill,
+                      ei_anchor_t* anchor)
+{
+        ei_gridder_params_t *params = widget->placer_params->grid;
+        if (params == NULL) {
+                params = ei_malloc(sizeof(ei_gridder_params_t));
+                params->row = 0;
+                params->column = 0;
+                params->padding = 0;
+                params->fill = EI_TRUE;
+                params->anchor = ei_anc_center;
+                widget->placer_params->grid = params;
+        }
+        if (row != NULL) params->row = (*row > 0) ? *row : 0;
+        if (column != NULL) params->column = (*column > 0) ? *column : 0;
+        if (padding != NULL) params->padding = *padding;
+        if (fill != NULL) params->fill = *fill;
+        if (anchor != NULL) params->anchor = *anchor;
+        relayout(widget->parent);
+}
+
+/**
+ * \brief	Configures a row of the cells of a widget.
+ *
+ * @param	parent		The widget which children are placed by the "gridder".
+ * @param	row		The row.
+ * @param	weight		If not NULL, the share of the extra space given to the row. Rows all
+ *				have a weight of 0 by default: they keep the size they need.
+ * @param	min_size	If not NULL, the minimum height of the row (defaults to 0).
+ */
+void ei_gridder_configure_row(struct ei_widget_t* parent, int row, int* weight, int* min_size)
+{
+        if (row < 0) return;
+        ei_gridder_t *gridder = get_gridder(parent);
+        ei_gridder_line_t *line = get_line(&gridder->rows, &gridder->row_count, &gridder->row_capacity, row);
+        if (weight != NULL) line->weight = (*weight > 0) ? *weight : 0;
+        if (min_size != NULL) line->min_size = *min_size;
+        relayout(parent);
+}
+
+/**
+ * \brief	Configures a column of the cells of a widget.
+ *
+ * @param	parent		The widget which children are placed by the "gridder".
+ * @param	column		The column.
+ * @param	weight		If not NULL, the share of the extra space given to the column. Columns
+ *				all have a weight of 0 by default: they keep the size they need.
+ * @param	min_size	If not NULL, the minimum width of the column (defaults to 0).
+ */
+void ei_gridder_configure_column(struct ei_widget_t* parent, int column, int* weight, int* min_size)
+{
+        if (column < 0) return;
+        ei_gridder_t *gridder = get_gridder(parent);
+        ei_gridder_line_t *line = get_line(&gridder->columns, &gridder->column_count,
+                                           &gridder->column_capacity, column);
+        if (weight != NULL) line->weight = (*weight > 0) ? *weight : 0;
+        if (min_size != NULL) line->min_size = *min_size;
+        relayout(parent);
+}
+
+/**
+ * \brief	Computes the geometry of a widget managed by the "gridder", without moving the
+ *		widget. The rows and columns of its parent are only computed again if they have
+ *		changed, so that placing all the children takes a single pass. Called by
+ *		\ref ei_placer_rect.
+ *
+ * @param	widget		The widget which geometry must be computed.
+ *
+ * @return			The geometry, in the root window coordinates.
+ */
+ei_rect_t ei_gridder_rect(struct ei_widget_t* widget)
+{
+        ei_gridder_params_t *params = widget->placer_params->grid;
+        ei_widget_t *parent = widget->parent;
+        ei_gridder_t *gridder = get_gridder(parent);
+        ei_rect_t *content = parent->content_rect;
+        if (gridder->dirty || gridder->solved_size.width != content->size.width ||
+            gridder->solved_size.height != content->size.height) solve(parent, gridder);
+
+        ei_gridder_line_t *row = &gridder->rows[params->row];
+        ei_gridder_line_t *column = &gridder->columns[params->column];
+        ei_rect_t cell = {{content->top_left.x + column->offset + params->padding,
+                           content->top_left.y + row->offset + params->padding},
+                          {column->size - 2 * params->padding, row->size - 2 * params->padding}};
+        if (params->fill) return cell;
+        ei_rect_t rect = {widget->screen_location.top_left, widget->requested_size};
+        anchoring(params->anchor, &rect.top_left, &cell, &widget->requested_size);
+        return rect;
+}
+
+/**
+ * \brief	Tells the "gridder" that the requested size of a widget has changed, so that the
+ *		rows and columns of its parent are computed again.
+ *
+ * @param	widget		The widget. Nothing is done if it is not managed by the "gridder".
+ */
+void ei_gridder_child_changed(struct ei_widget_t* widget)
+{
+        if (widget->placer_params->grid != NULL && widget->parent != NULL)
+                get_gridder(widget->parent)->dirty = EI_TRUE;
+}
+
+/**
+ * \brief	Tells the "gridder" to remove a widget from the screen and forget about it.
+ *		Note: the widget is not destroyed and still exists in memory.
+ *
+ * @param	widget		The widget to remove from screen.
+ */
+void ei_gridder_forget(struct ei_widget_t* widget)
+{
+        if (widget->placer_params->grid == NULL) return;
+        free(widget->placer_params->grid);
+        widget->placer_params->grid = NULL;
+        // Not managed by the placer either
+        widget->placer_params->anchor_data = ei_anc_none;
+        relayout(widget->parent);
+}
+
+/**
+ * \brief	Releases the "gridder" data of a widget, both as a child and as a parent. Called
+ *		when the widget is destroyed.
+ *
+ * @param	widget		The widget.
+ */
+void ei_gridder_release(struct ei_widget_t* widget)
+{
+        if (widget->placer_params->grid != NULL) {
+                ei_gridder_child_changed(widget);
+                free(widget->placer_params->grid);
+                widget->placer_params->grid = NULL;
+        }
+        ei_gridder_t *gridder = widget->placer_params->gridder;
+        if (gridder != NULL) {
+                free(gridder->rows);
+                free(gridder->columns);
+                free(gridder);
+                widget->placer_params->gridder = NULL;
+        }
+}
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include "ei_application.h"
+#include "ei_arena.h"
+#include "ei_hud.h"
+
+#define HUD_HISTORY 60
+
+static ei_size_t hud_size = {220, 84};
+static int hud_margin = 4;
+static int hud_font_size = 12;
+static ei_font_t hud_font = NULL;
+static ei_color_t hud_background = {0x10, 0x10, 0x18, 0xff};
+static ei_color_t hud_text_color = {0xe0, 0xe0, 0xe0, 0xff};
+static ei_color_t hud_bar_color = {0x40, 0xc0, 0x60, 0xff};
+static ei_color_t hud_slow_bar_color = {0xe0, 0x50, 0x40, 0xff};
+static double hud_slow_frame = 1.0 / 60.0;      // Bars of slower frames are drawn in red
+
+static ei_bool_t hud_visible = EI_FALSE;
+static int toggle_key = 0;
+
+static double frame_times[HUD_HISTORY];         // Ring of the last frame times
+static int frame_index = 0;
+static int last_rect_count = 0;
+static long last_area = 0;
+
+static double period_start = -1.0;              // The rates are measured over periods of one second
+static int period_frames = 0;
+static int period_events = 0;
+static double frames_per_second = 0.0;
+static double events_per_second = 0.0;
+
+/**
+ * @brief	Returns the rectangle of the overlay, in the top right corner of the root window.
+ *
+ * @return			The rectangle of the overlay.
+ */
+static ei_rect_t hud_rect(void)
+{
+        ei_rect_t root = hw_surface_get_rect(ei_app_root_surface());
+        ei_rect_t rect;
+        rect.top_left.x = root.top_left.x + root.size.width - hud_size.width - hud_margin;
+        rect.top_left.y = root.top_left.y + hud_margin;
+        rect.size = hud_size;
+        return rect;
+}
+
+/**
+ * @brief	Updates the rates when a period of one second is over.
+ */
+static void update_rates(void)
+{
+        double now = hw_now();
+        if (period_start < 0.0) period_start = now;
+        if (now - period_start < 1.0) return;
+        frames_per_second = period_frames / (now - period_start);
+        events_per_second = period_events / (now - period_start);
+        period_start = now;
+        period_frames = 0;
+        period_events = 0;
+}
+
+/**
+ * \brief	Shows or hides the performance overlay: a small panel drawn over the top right
+ *		corner of the root window, on top of all the widgets. It shows the time spent
+ *		drawing the last frame, the frames and events per second, the number and area of
+ *		the rectangles drawn, the memory reserved by the frame arena, and the time of the
+ *		last frames as a sparkline. Hidden by default.
+ *
+ * @param	visible		EI_TRUE to show the overlay.
+ */
+void ei_hud_set_visible(ei_bool_t visible)
+{
+        if (visible == hud_visible) return;
+        hud_visible = visible;
+        if (ei_app_root_widget() == NULL) return;
+        // Shown, it is drawn over what is below; hidden, what is below is drawn again
+        ei_rect_t rect = hud_rect();
+        ei_app_invalidate_rect(&rect);
+}
+
+/**
+ * \brief	Tells if the performance overlay is shown.
+ *
+ * @return			EI_TRUE if the overlay is shown.
+ */
+ei_bool_t ei_hud_is_visible(void)
+{
+        return hud_visible;
+}
+
+/**
+ * \brief	Sets a key that shows or hides the performance overlay. The key press is not
+ *		given to the widgets nor to the default handle function.
+ *
+ * @param	key_code	The key, or 0 for no key (the default).
+ */
+void ei_hud_set_toggle_key(int key_code)
+{
+        toggle_key = key_code;
+}
+
+/**
+ * \brief	Counts an event for the statistics of the overlay, and toggles the overlay if
+ *		it is the toggle key. Called by the main loop for every event.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event was the toggle key, and must not be handled.
+ */
+ei_bool_t ei_hud_handle_event(ei_event_t* event)
+{
+        period_events++;
+        if (toggle_key != 0 && event->type == ei_ev_keydown && event->param.key.key_code == toggle_key) {
+                ei_hud_set_visible(!hud_visible);
+                return EI_TRUE;
+        }
+        return EI_FALSE;
+}
+
+/**
+ * @brief	Draws one line of text of the overlay.
+ *
+ * @param	surface		The root surface.
+ * @param	rect		The rectangle of the overlay.
+ * @param	line		The index of the line.
+ * @param	text		The text.
+ */
+static void draw_line(ei_surface_t surface, const ei_rect_t* rect, int line, const char* text)
+{
+        int width = 0;
+        int height = 0;
+        hw_text_compute_size("Ag", hud_font, &width, &height);
+        ei_point_t where = {rect->top_left.x + 6, rect->top_left.y + 4 + line * height};
+        ei_draw_text(surface, &where, text, hud_font, hud_text_color, rect);
+}
+
+/**
+ * @brief	Draws the time of the last frames as vertical bars, along the bottom of the overlay.
+ *
+ * @param	surface		The root surface.
+ * @param	rect		The rectangle of the overlay.
+ */
+static void draw_sparkline(ei_surface_t surface, const ei_rect_t* rect)
+{
+        int bar_width = (rect->size.width - 12) / HUD_HISTORY;
+        int max_height = 24;
+        double scale = max_height / (2.0 * hud_slow_frame);     // Twice the slow time fills the height
+
+        for (int i = 0; i < HUD_HISTORY; i++) {
+                double time = frame_times[(frame_index + i) % HUD_HISTORY];
+                int height = (int) (time * scale) + 1;
+                if (height > max_height) height = max_height;
+                ei_rect_t bar;
+                bar.top_left.x = rect->top_left.x + 6 + i * bar_width;
+                bar.top_left.y = rect->top_left.y + rect->size.height - 4 - height;
+                bar.size.width = (bar_width > 1) ? bar_width - 1 : 1;
+                bar.size.height = height;
+                ei_fill(surface, (time > hud_slow_frame) ? &hud_slow_bar_color : &hud_bar_color, &bar);
+        }
+}
+
+/**
+ * \brief	Draws the overlay, if it is shown, over all the widgets. Called by the main loop
+ *		at the end of each frame, before the screen is updated.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rect		Where to store the rectangle of the overlay, to update on screen.
+ *
+ * @return			EI_FALSE if the overlay is hidden and nothing was drawn.
+ */
+ei_bool_t ei_hud_draw(ei_surface_t surface, ei_rect_t* rect)
+{
+        if (!hud_visible) return EI_FALSE;
+        *rect = hud_rect();
+        update_rates();
+        if (hud_font == NULL) hud_font = hw_text_font_create(ei_default_font_filename, ei_style_normal,
+                                                             hud_font_size);
+
+        char text[64];
+        double last_time = frame_times[(frame_index + HUD_HISTORY - 1) % HUD_HISTORY];
+        ei_fill(surface, &hud_background, rect);
+        snprintf(text, sizeof(text), "frame %.2f ms  %.0f fps", last_time * 1000.0, frames_per_second);
+        draw_line(surface, rect, 0, text);
+        snprintf(text, sizeof(text), "paint %d rects %ld px", last_rect_count, last_area);
+        draw_line(surface, rect, 1, text);
+        snprintf(text, sizeof(text), "%.0f events/s  arena %lu kB", events_per_second,
+                 (unsigned long) (ei_arena_get_size() / 1024));
+        draw_line(surface, rect, 2, text);
+        draw_sparkline(surface, rect);
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Records the statistics of a frame. Called by the main loop after each frame.
+ *
+ * @param	rects		The rectangles that were drawn.
+ * @param	frame_time	The time spent drawing the frame, in seconds.
+ */
+void ei_hud_frame_done(const ei_linked_rect_t* rects, double frame_time)
+{
+        frame_times[frame_index] = frame_time;
+        frame_index = (frame_index + 1) % HUD_HISTORY;
+        last_rect_count = 0;
+        last_area = 0;
+        for (; rects != NULL; rects = rects->next) {
+                last_rect_count++;
+                last_area += (long) rects->rect.size.width * rects->rect.size.height;
+        }
+        period_frames++;
+}
+
+/**
+ * \brief	Releases the resources of the overlay.
+ */
+void ei_hud_free(void)
+{
+        if (hud_font != NULL) hw_text_font_free(hud_font);
+        hud_font = NULL;
+        hud_visible = EI_FALSE;
+}
@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include "ei_idle.h"
+#include "ei_stats.h"
+#include "hw_interface.h"
+
+typedef struct ei_idle_task_t {
+        uint32_t id;
+        ei_idle_func_t func;
+        void* user_param;
+        int priority;
+        struct ei_idle_task_t* next;
+} ei_idle_task_t;
+
+static ei_idle_task_t *tasks = NULL;            // Sorted by decreasing priority
+static uint32_t next_id = 1;
+static uint32_t running_id = 0;                 // The task being run, out of the list
+static ei_bool_t running_cancelled = EI_FALSE;
+static double budget = 0.004;                   // In seconds
+
+/**
+ * @brief	Inserts a task after all the tasks of the same or a higher priority.
+ *
+ * @param	task		The task.
+ */
+static void insert_task(ei_idle_task_t* task)
+{
+        ei_idle_task_t **link = &tasks;
+        while (*link != NULL && (*link)->priority >= task->priority) link = &(*link)->next;
+        task->next = *link;
+        *link = task;
+}
+
+/**
+ * \brief	Queues a task to run when the application is idle: when all the ready events have
+ *		been processed and the screen is up to date. Idle tasks run by order of priority
+ *		(tasks of the same priority in turn), until the idle budget of the iteration of the
+ *		main loop is spent, so a long job should be split in small steps.
+ *
+ * @param	func		The function of the task.
+ * @param	user_param	A programmer supplied parameter that will be passed to func.
+ * @param	priority	The priority of the task: tasks with a higher priority run first.
+ *
+ * @return			An identifier of the task, to give to \ref ei_app_cancel_idle.
+ */
+uint32_t ei_app_post_idle(ei_idle_func_t func, void* user_param, int priority)
+{
+        ei_idle_task_t *task = ei_malloc(sizeof(ei_idle_task_t));
+        task->id = next_id++;
+        task->func = func;
+        task->user_param = user_param;
+        task->priority = priority;
+        insert_task(task);
+        return task->id;
+}
+
+/**
+ * \brief	Removes a task from the idle tasks. Does nothing if the task is already done.
+ *
+ * @param	id		The identifier returned by \ref ei_app_post_idle.
+ */
+void ei_app_cancel_idle(uint32_t id)
+{
+        if (id == running_id) {
+                running_cancelled = EI_TRUE;
+                return;
+        }
+        for (ei_idle_task_t **link = &tasks; *link != NULL; link = &(*link)->next) {
+                if ((*link)->id == id) {
+                        ei_idle_task_t *task = *link;
+                        *link = task->next;
+                        free(task);
+                        return;
+                }
+        }
+}
+
+/**
+ * \brief	Sets the time given to the idle tasks in each iteration of the main loop. No
+ *		task is started once it is spent, but a task is never interrupted.
+ *
+ * @param	budget_us	The budget, in microseconds. Defaults to 4000.
+ */
+void ei_app_set_idle_budget(int budget_us)
+{
+        budget = budget_us / 1000000.0;
+}
+
+/**
+ * \brief	Runs the idle tasks, by order of priority, until they are all done or the idle
+ *		budget of the iteration is spent. Called by \ref ei_app_step once the ready events
+ *		are processed and the screen is up to date.
+ */
+void ei_idle_run(void)
+{
+        double deadline = hw_now() + budget;
+        // A task that is not done goes after the tasks of its priority, so it runs once per turn
+        while (tasks != NULL && hw_now() < deadline) {
+                ei_idle_task_t *task = tasks;
+                tasks = task->next;
+                running_id = task->id;
+                running_cancelled = EI_FALSE;
+                ei_bool_t again = task->func(task->user_param);
+                running_id = 0;
+                if (again && !running_cancelled) insert_task(task);
+                else free(task);
+        }
+}
+
+/**
+ * \brief	Tells if some idle tasks are waiting to run.
+ *
+ * @return			EI_TRUE if at least one idle task is queued.
+ */
+ei_bool_t ei_idle_pending(void)
+{
+        return (tasks != NULL) ? EI_TRUE : EI_FALSE;
+}
+
+/**
+ * \brief	Releases all the idle tasks, without running them.
+ */
+void ei_idle_free(void)
+{
+        ei_idle_task_t *temp = NULL;
+        while (tasks) {
+                temp = tasks->next;
+                free(tasks);
+                tasks = temp;
+        }
+}
@@ -0,0 +1,327 @@
+#include <stdlib.h>
+#include "ei_arena.h"
+#include "ei_occlusion.h"
+#include "ei_placer.h"
+#include "ei_record.h"
+#include "ei_stats.h"
+#include "ei_trace.h"
+#include "ei_utils.h"
+
+typedef struct ei_opaque_hook_t {
+        ei_widgetclass_t* widgetclass;
+        ei_occlusion_opaquefunc_t opaquefunc;
+        struct ei_opaque_hook_t* next;
+} ei_opaque_hook_t;
+
+static ei_opaque_hook_t *opaque_hooks = NULL;
+
+/**
+ * @brief	Computes the intersection of two rectangles.
+ *
+ * @param	first_rect	The first rectangle.
+ * @param	sec_rect	The second rectangle.
+ * @param	intersection	Where to store the intersection.
+ *
+ * @return			EI_TRUE if the intersection is not empty.
+ */
+static ei_bool_t clip_rect(const ei_rect_t* first_rect, const ei_rect_t* sec_rect, ei_rect_t* intersection)
+{
+        int x_min = (first_rect->top_left.x > sec_rect->top_left.x) ? first_rect->top_left.x : sec_rect->top_left.x;
+        int y_min = (first_rect->top_left.y > sec_rect->top_left.y) ? first_rect->top_left.y : sec_rect->top_left.y;
+        int f_x_max = first_rect->top_left.x + first_rect->size.width;
+        int s_x_max = sec_rect->top_left.x + sec_rect->size.width;
+        int f_y_max = first_rect->top_left.y + first_rect->size.height;
+        int s_y_max = sec_rect->top_left.y + sec_rect->size.height;
+        int x_max = (f_x_max < s_x_max) ? f_x_max : s_x_max;
+        int y_max = (f_y_max < s_y_max) ? f_y_max : s_y_max;
+
+        if (x_max <= x_min || y_max <= y_min) return EI_FALSE;
+        intersection->top_left.x = x_min;
+        intersection->top_left.y = y_min;
+        intersection->size.width = x_max - x_min;
+        intersection->size.height = y_max - y_min;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Adds a rectangle at the head of a list of rectangles.
+ *
+ * @param	list		The list.
+ * @param	x, y		The top left corner of the rectangle.
+ * @param	width, height	The size of the rectangle, nothing is added if it is empty.
+ *
+ * @return			The new head of the list.
+ */
+static ei_linked_rect_t* push_rect(ei_linked_rect_t* list, int x, int y, int width, int height)
+{
+        if (width <= 0 || height <= 0) return list;
+        ei_linked_rect_t *new_rect = ei_arena_alloc(sizeof(ei_linked_rect_t));
+        new_rect->rect = ei_rect(ei_point(x, y), ei_size(width, height));
+        new_rect->next = list;
+        return new_rect;
+}
+
+/**
+ * @brief	Intersects a list of rectangles with a rectangle.
+ *
+ * @param	list		The list.
+ * @param	rect		The rectangle.
+ *
+ * @return			The non-empty intersections, in reverse order.
+ */
+static ei_linked_rect_t* clip_linked_rects(const ei_linked_rect_t* list, const ei_rect_t* rect)
+{
+        ei_linked_rect_t *clipped = NULL;
+        ei_rect_t inter;
+        for (; list != NULL; list = list->next) {
+                if (clip_rect(&list->rect, rect, &inter))
+                        clipped = push_rect(clipped, inter.top_left.x, inter.top_left.y,
+                                            inter.size.width, inter.size.height);
+        }
+        return clipped;
+}
+
+/**
+ * @brief	Merges two rectangles into the first one if their union is a rectangle, i.e. if
+ *		they have the same columns and touch vertically, or the same rows and touch
+ *		horizontally.
+ *
+ * @param	into		The first rectangle, which receives the union.
+ * @param	other		The second rectangle.
+ *
+ * @return			EI_TRUE if the rectangles were merged.
+ */
+static ei_bool_t merge_pair(ei_rect_t* into, const ei_rect_t* other)
+{
+        if (into->top_left.x == other->top_left.x && into->size.width == other->size.width) {
+                if (into->top_left.y + into->size.height == other->top_left.y) {
+                        into->size.height += other->size.height;
+                        return EI_TRUE;
+                }
+                if (other->top_left.y + other->size.height == into->top_left.y) {
+                        into->top_left.y = other->top_left.y;
+                        into->size.height += other->size.height;
+                        return EI_TRUE;
+                }
+        }
+        if (into->top_left.y == other->top_left.y && into->size.height == other->size.height) {
+                if (into->top_left.x + into->size.width == other->top_left.x) {
+                        into->size.width += other->size.width;
+                        return EI_TRUE;
+                }
+                if (other->top_left.x + other->size.width == into->top_left.x) {
+                        into->top_left.x = other->top_left.x;
+                        into->size.width += other->size.width;
+                        return EI_TRUE;
+                }
+        }
+        return EI_FALSE;
+}
+
+/**
+ * @brief	Merges the adjacent bands of a region, until no two of its rectangles can be
+ *		merged, so that it is drawn in fewer pieces.
+ *
+ * @param	region		The region, modified in place.
+ *
+ * @return			The region.
+ */
+static ei_linked_rect_t* merge_bands(ei_linked_rect_t* region)
+{
+        ei_bool_t merged = EI_TRUE;
+        while (merged) {
+                merged = EI_FALSE;
+                for (ei_linked_rect_t *curr = region; curr != NULL; curr = curr->next) {
+                        ei_linked_rect_t **link = &curr->next;
+                        while (*link != NULL) {
+                                if (merge_pair(&curr->rect, &(*link)->rect)) {
+                                        *link = (*link)->next;
+                                        merged = EI_TRUE;
+                                } else {
+                                        link = &(*link)->next;
+                                }
+                        }
+                }
+        }
+        return region;
+}
+
+/**
+ * @brief	Removes a rectangle from a region: each rectangle of the region overlapping the
+ *		hole is split into at most four bands around it.
+ *
+ * @param	region		The region.
+ * @param	hole		The rectangle to remove.
+ *
+ * @return			The new region.
+ */
+static ei_linked_rect_t* subtract_rect(ei_linked_rect_t* region, const ei_rect_t* hole)
+{
+        ei_linked_rect_t *result = NULL;
+        ei_linked_rect_t *curr = region;
+        while (curr != NULL) {
+                ei_rect_t *r = &curr->rect;
+                ei_rect_t inter;
+                if (!clip_rect(r, hole, &inter)) {
+                        result = push_rect(result, r->top_left.x, r->top_left.y, r->size.width, r->size.height);
+                } else {
+                        int r_x_max = r->top_left.x + r->size.width;
+                        int r_y_max = r->top_left.y + r->size.height;
+                        int i_x_max = inter.top_left.x + inter.size.width;
+                        int i_y_max = inter.top_left.y + inter.size.height;
+                        // top and bottom bands span the whole width, left and right bands fill the gap
+                        result = push_rect(result, r->top_left.x, r->top_left.y, r->size.width,
+                                           inter.top_left.y - r->top_left.y);
+                        result = push_rect(result, r->top_left.x, i_y_max, r->size.width, r_y_max - i_y_max);
+                        result = push_rect(result, r->top_left.x, inter.top_left.y,
+                                           inter.top_left.x - r->top_left.x, inter.size.height);
+                        result = push_rect(result, i_x_max, inter.top_left.y, r_x_max - i_x_max,
+                                           inter.size.height);
+                }
+                curr = curr->next;
+        }
+        return result;
+}
+
+/**
+ * @brief	Finds the opaque function of a class of widget.
+ *
+ * @param	widgetclass	The class of widget.
+ *
+ * @return			The opaque function, or NULL if the class is transparent.
+ */
+static ei_occlusion_opaquefunc_t find_opaquefunc(const ei_widgetclass_t* widgetclass)
+{
+        ei_opaque_hook_t *hook = opaque_hooks;
+        while (hook != NULL) {
+                if (hook->widgetclass == widgetclass) return hook->opaquefunc;
+                hook = hook->next;
+        }
+        return NULL;
+}
+
+/**
+ * \brief	Declares the opaque region of a class of widgets. Classes without an opaque
+ *		region are considered transparent: they never hide what is below them.
+ *
+ * @param	widgetclass	The class of widget.
+ * @param	opaquefunc	The function computing the opaque rectangle of a widget of this class.
+ */
+void ei_occlusion_register(ei_widgetclass_t* widgetclass, ei_occlusion_opaquefunc_t opaquefunc)
+{
+        ei_opaque_hook_t *hook = opaque_hooks;
+        while (hook != NULL) {
+                if (hook->widgetclass == widgetclass) {
+                        hook->opaquefunc = opaquefunc;
+                        return;
+                }
+                hook = hook->next;
+        }
+        hook = ei_calloc(1, sizeof(ei_opaque_hook_t));
+        hook->widgetclass = widgetclass;
+        hook->opaquefunc = opaquefunc;
+        hook->next = opaque_hooks;
+        opaque_hooks = hook;
+}
+
+/**
+ * @brief	Computes where a child would draw once placed by its geometry manager, i.e. its
+ *		outer rectangle at the geometry the manager gives it.
+ *
+ * @param	child		The child.
+ * @param	placed		The geometry given by the geometry manager.
+ *
+ * @return			The outer rectangle, in the root window coordinates.
+ */
+static ei_rect_t placed_outer_rect(ei_widget_t* child, const ei_rect_t* placed)
+{
+        // The decorations around the screen location do not depend on where it is
+        ei_rect_t outer_rect = ei_widget_outer_rect(child);
+        outer_rect.top_left = placed->top_left;
+        outer_rect.size.width += placed->size.width - child->screen_location.size.width;
+        outer_rect.size.height += placed->size.height - child->screen_location.size.height;
+        return outer_rect;
+}
+
+/**
+ * \brief	Culls the children of a widget outside of the clipper, and runs the geometry
+ *		manager of the others, then walks them from front to back, subtracting their
+ *		opaque rectangles from the visible region. Each child is given the part of the
+ *		region it covers, with adjacent bands merged.
+ *
+ *		Culled children are not placed: their screen location is the one they had when
+ *		last drawn, until they are drawn again.
+ *
+ * @param	occlusion	Where to store the result, allocated in the frame arena.
+ * @param	parent		The widget which children are culled.
+ * @param	clipper		The region to draw.
+ */
+void ei_occlusion_compute(ei_occlusion_t* occlusion, ei_widget_t* parent, const ei_rect_t* clipper)
+{
+        int count = 0;
+        for (ei_widget_t *child = parent->children_head; child != NULL; child = child->next_sibling) count++;
+
+        occlusion->children = ei_arena_alloc((size_t) count * sizeof(ei_widget_t*));
+        occlusion->visible = ei_arena_alloc((size_t) count * sizeof(ei_linked_rect_t*));
+
+        count = 0;
+        for (ei_widget_t *child = parent->children_head; child != NULL; child = child->next_sibling) {
+                ei_rect_t placed = ei_placer_rect(child);
+                ei_rect_t outer_rect = placed_outer_rect(child, &placed);
+                ei_rect_t inter;
+                if (!clip_rect(&outer_rect, clipper, &inter)) continue;
+                child->screen_location = placed;
+                occlusion->children[count++] = child;
+        }
+        occlusion->count = count;
+
+        // Siblings are drawn in list order: the last child is the front-most one
+        ei_linked_rect_t *region = push_rect(NULL, clipper->top_left.x, clipper->top_left.y,
+                                             clipper->size.width, clipper->size.height);
+        for (int i = count - 1; i >= 0 && region != NULL; i--) {
+                ei_widget_t *child = occlusion->children[i];
+                // Each child only draws the part of the region it covers
+                ei_rect_t outer_rect = ei_widget_outer_rect(child);
+                occlusion->visible[i] = merge_bands(clip_linked_rects(region, &outer_rect));
+                if (occlusion->visible[i] == NULL) continue;
+                ei_occlusion_opaquefunc_t opaquefunc = find_opaquefunc(child->wclass);
+                ei_rect_t opaque;
+                if (opaquefunc != NULL && opaquefunc(child, &opaque))
+                        region = merge_bands(subtract_rect(region, &opaque));
+        }
+        occlusion->uncovered = region;
+}
+
+/**
+ * \brief	Draws the children of a widget from back to front, each one only where it is
+ *		visible, from its record if it has one. Hidden children are skipped.
+ *
+ * @param	occlusion	The result of \ref ei_occlusion_compute.
+ * @param	surface		Where to draw the children.
+ * @param	pick_surface	The picking offscreen.
+ */
+void ei_occlusion_draw_children(const ei_occlusion_t* occlusion, ei_surface_t surface,
+                                ei_surface_t pick_surface)
+{
+        for (int i = 0; i < occlusion->count; i++) {
+                ei_widget_t *child = occlusion->children[i];
+                for (ei_linked_rect_t *curr = occlusion->visible[i]; curr != NULL; curr = curr->next) {
+                        ei_trace_begin(child->wclass->name);
+                        ei_record_draw(child, surface, pick_surface, &curr->rect);
+                        ei_trace_end(child->wclass->name);
+                }
+        }
+}
+
+/**
+ * \brief	Forgets all the opaque functions declared by \ref ei_occlusion_register.
+ */
+void ei_occlusion_unregister_all(void)
+{
+        ei_opaque_hook_t *temp = NULL;
+        while (opaque_hooks) {
+                temp = opaque_hooks->next;
+                free(opaque_hooks);
+                opaque_hooks = temp;
+        }
+}
@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_overdraw.h"
+#include "ei_picking.h"
+
+ei_bool_t ei_overdraw_enabled = EI_FALSE;
+
+static ei_bool_t heatmap_visible = EI_FALSE;
+static uint16_t *counts = NULL;         // Writes to each pixel of the root window in this frame
+static ei_size_t counts_size = {0, 0};
+static double last_average = 0.0;
+static int last_maximum = 0;
+static ei_color_t heat_colors[] = {{0x00, 0x40, 0xff, 0x70}, {0x00, 0xc0, 0x40, 0x80},
+                                   {0xff, 0xe0, 0x00, 0x90}, {0xff, 0x80, 0x00, 0xa0},
+                                   {0xff, 0x00, 0x00, 0xb0}};
+
+/**
+ * @brief	Allocates the counters, of the size of the root window, if they are not yet.
+ *
+ * @return			EI_FALSE if there is no root window yet.
+ */
+static ei_bool_t alloc_counts(void)
+{
+        if (counts != NULL) return EI_TRUE;
+        if (ei_app_root_surface() == NULL) return EI_FALSE;
+        counts_size = hw_surface_get_size(ei_app_root_surface());
+        counts = ei_calloc((size_t) counts_size.width * counts_size.height, sizeof(uint16_t));
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Counts a write to every pixel of a rectangle. Use \ref ei_overdraw_count instead.
+ *
+ * @param	surface		The surface written to. Only the writes to the root surface and to
+ *				the picking surface are counted, in the same counters.
+ * @param	rect		The rectangle written, or NULL for the whole surface.
+ */
+void ei_overdraw_record(ei_surface_t surface, const ei_rect_t* rect)
+{
+        if (surface != ei_app_root_surface() && surface != ei_picking_get_picking_surface()) return;
+        if (!alloc_counts()) return;
+
+        int x0 = 0, y0 = 0, x1 = counts_size.width, y1 = counts_size.height;
+        if (rect != NULL) {
+                if (rect->top_left.x > x0) x0 = rect->top_left.x;
+                if (rect->top_left.y > y0) y0 = rect->top_left.y;
+                if (rect->top_left.x + rect->size.width < x1) x1 = rect->top_left.x + rect->size.width;
+                if (rect->top_left.y + rect->size.height < y1) y1 = rect->top_left.y + rect->size.height;
+        }
+        for (int y = y0; y < y1; y++) {
+                uint16_t *count = counts + y * counts_size.width + x0;
+                for (int x = x0; x < x1; x++, count++) {
+                        if (*count < UINT16_MAX) (*count)++;
+                }
+        }
+}
+
+/**
+ * \brief	Starts or stops counting how many times each pixel is written in a frame, to
+ *		measure the overdraw. The counting is off by default.
+ *
+ * @param	enabled		EI_TRUE to count the writes.
+ */
+void ei_overdraw_set_enabled(ei_bool_t enabled)
+{
+        ei_overdraw_enabled = enabled;
+        if (!enabled) ei_overdraw_set_heatmap(EI_FALSE);
+}
+
+/**
+ * \brief	Shows or hides the overdraw heatmap: each pixel drawn in a frame is tinted with a
+ *		color that depends on how many times it was written, from blue (once) to red
+ *		(five times or more). Showing the heatmap starts the counting.
+ *
+ * @param	visible		EI_TRUE to show the heatmap.
+ */
+void ei_overdraw_set_heatmap(ei_bool_t visible)
+{
+        if (visible == heatmap_visible) return;
+        heatmap_visible = visible;
+        if (visible) ei_overdraw_enabled = EI_TRUE;
+        // The whole window is drawn again, with or without the heatmap
+        if (ei_app_root_widget() != NULL) ei_app_invalidate_rect(ei_app_root_widget()->content_rect);
+}
+
+/**
+ * \brief	Returns the overdraw of the last frame.
+ *
+ * @param	average		Where to store the average number of writes per pixel, among the
+ *				pixels written at least once. Can be NULL.
+ * @param	maximum		Where to store the highest number of writes to a pixel. Can be NULL.
+ */
+void ei_overdraw_get_stats(double* average, int* maximum)
+{
+        if (average != NULL) *average = last_average;
+        if (maximum != NULL) *maximum = last_maximum;
+}
+
+/**
+ * \brief	Sets all the counters to 0. Called by the main loop before drawing a frame.
+ */
+void ei_overdraw_begin_frame(void)
+{
+        if (!ei_overdraw_enabled || !alloc_counts()) return;
+        memset(counts, 0, (size_t) counts_size.width * counts_size.height * sizeof(uint16_t));
+}
+
+/**
+ * @brief	Tints one rectangle drawn in the frame with the heatmap. The counters of the pixels
+ *		tinted are set to 0, so that the parts shared with other rectangles are tinted once.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rect		The rectangle, inside the root surface.
+ */
+static void draw_heatmap(ei_surface_t surface, const ei_rect_t* rect)
+{
+        int levels = sizeof(heat_colors) / sizeof(heat_colors[0]);
+
+        // Pixels written the same number of times in a row are tinted at once
+        for (int y = rect->top_left.y; y < rect->top_left.y + rect->size.height; y++) {
+                uint16_t *row = counts + y * counts_size.width;
+                int x = rect->top_left.x;
+                while (x < rect->top_left.x + rect->size.width) {
+                        int start = x;
+                        uint16_t count = row[x];
+                        while (x < rect->top_left.x + rect->size.width && row[x] == count) row[x++] = 0;
+                        if (count == 0) continue;
+                        ei_rect_t run = {{start, y}, {x - start, 1}};
+                        blend_rect(surface, &run, heat_colors[(count < levels) ? count - 1 : levels - 1]);
+                }
+        }
+}
+
+/**
+ * \brief	Computes the overdraw of the frame, and draws the heatmap if it is shown. Called by
+ *		the main loop after the widgets are drawn, before the screen is updated.
+ *
+ * @param	surface		The root surface, *locked*.
+ * @param	rects		The rectangles drawn in this frame.
+ */
+void ei_overdraw_end_frame(ei_surface_t surface, const ei_linked_rect_t* rects)
+{
+        if (!ei_overdraw_enabled || counts == NULL) return;
+
+        long writes = 0;
+        long written = 0;
+        int maximum = 0;
+        for (long i = 0; i < (long) counts_size.width * counts_size.height; i++) {
+                if (counts[i] == 0) continue;
+                writes += counts[i];
+                written++;
+                if (counts[i] > maximum) maximum = counts[i];
+        }
+        last_average = (written > 0) ? (double) writes / written : 0.0;
+        last_maximum = maximum;
+
+        if (!heatmap_visible) return;
+        ei_rect_t bounds = {{0, 0}, counts_size};
+        for (; rects != NULL; rects = rects->next) {
+                ei_rect_t rect = rectangle_intersect(&bounds, (ei_rect_t*) &rects->rect);
+                if (rect.size.width <= 0 || rect.size.height <= 0) continue;
+                draw_heatmap(surface, &rect);
+        }
+}
+
+/**
+ * \brief	Releases the counters, and stops the counting.
+ */
+void ei_overdraw_free(void)
+{
+        free(counts);
+        counts = NULL;
+        ei_overdraw_enabled = EI_FALSE;
+        heatmap_visible = EI_FALSE;
+        last_average = 0.0;
+        last_maximum = 0;
+}
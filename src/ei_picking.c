@@ -1,6 +1,14 @@
+#include <stdlib.h>
+#include <string.h>
 #include "ei_picking.h"
+#include "ei_stats.h"
 
-static ei_surface_t *picking_surface = NULL;
+static ei_pick_buffer_t *picking_surface = NULL;
+static uint32_t next_id = 0;            // The smallest ID never given
+static uint32_t *free_ids = NULL;       // The released IDs, in a min-heap
+static uint32_t free_count = 0;
+static uint32_t free_capacity = 0;
+static uint32_t wide_count = 0;         // The IDs in use that do not fit on 16 bits
 
 /**
  * Returns the picking surface currently being used.
@@ -9,15 +17,283 @@ static ei_surface_t *picking_surface = NULL;
  */
 ei_surface_t* ei_picking_get_picking_surface (void)
 {
-        return picking_surface;
+        return (ei_surface_t*) picking_surface;
 }
 
 /**
- * Sets a picking surface.
+ * @brief	Releases the IDs of the picking offscreen, but not the IDs of the widgets.
+ */
+static void free_buffer(void)
+{
+        if (picking_surface == NULL) return;
+        free(picking_surface->ids);
+        free(picking_surface);
+        picking_surface = NULL;
+}
+
+/**
+ * \brief	Creates the picking offscreen, which becomes the picking surface.
+ *
+ * @param	size		The size of the root window.
+ */
+void ei_picking_create (ei_size_t size)
+{
+        free_buffer();
+        picking_surface = ei_malloc(sizeof(ei_pick_buffer_t));
+        picking_surface->size = size;
+        picking_surface->depth = (wide_count > 0) ? sizeof(uint32_t) : sizeof(uint16_t);
+        picking_surface->ids = ei_calloc((size_t) size.width * size.height, (size_t) picking_surface->depth);
+}
+
+/**
+ * \brief	Releases the picking offscreen.
+ */
+void ei_picking_free (void)
+{
+        free_buffer();
+        // All the widgets are destroyed with the application: the IDs start again from 0
+        free(free_ids);
+        free_ids = NULL;
+        free_count = 0;
+        free_capacity = 0;
+        next_id = 0;
+        wide_count = 0;
+}
+
+/**
+ * \brief	Tells if a surface is the picking offscreen, to draw pick IDs instead of colors.
+ *
+ * @param	surface		The surface.
+ *
+ * @return			EI_TRUE if surface is the picking offscreen.
+ */
+ei_bool_t ei_picking_is_buffer (ei_surface_t surface)
+{
+        return (surface != NULL && surface == (ei_surface_t) picking_surface) ? EI_TRUE : EI_FALSE;
+}
+
+/**
+ * @brief	Changes the number of bytes per ID of the picking offscreen. IDs that do not fit
+ *		on 16 bits are those of destroyed widgets: they are cleared.
+ *
+ * @param	depth		The new number of bytes per ID: 2, or 4.
+ */
+static void set_depth(int depth)
+{
+        if (picking_surface == NULL || picking_surface->depth == depth) return;
+
+        size_t count = (size_t) picking_surface->size.width * picking_surface->size.height;
+        if (depth == sizeof(uint32_t)) {
+                uint16_t *ids16 = picking_surface->ids;
+                uint32_t *ids32 = ei_malloc(count * sizeof(uint32_t));
+                for (size_t i = 0; i < count; i++) ids32[i] = ids16[i];
+                free(ids16);
+                picking_surface->ids = ids32;
+        } else {
+                uint32_t *ids32 = picking_surface->ids;
+                uint16_t *ids16 = ei_malloc(count * sizeof(uint16_t));
+                for (size_t i = 0; i < count; i++) ids16[i] = (ids32[i] <= UINT16_MAX) ? (uint16_t) ids32[i] : 0;
+                free(ids32);
+                picking_surface->ids = ids16;
+        }
+        picking_surface->depth = depth;
+}
+
+/**
+ * \brief	Gives a pick ID to a new widget: the smallest ID released by a destroyed widget,
+ *		or a new one. The picking offscreen switches to 32 bits IDs if it does not fit
+ *		on 16 bits.
+ *
+ * @param	id		Where to store the ID.
+ *
+ * @return			EI_FALSE if all the IDs up to \ref EI_PICK_ID_MAX are used.
+ */
+ei_bool_t ei_picking_acquire_id (uint32_t* id)
+{
+        if (free_count > 0) {
+                // Pop the smallest ID, and sift the last one down from the root
+                *id = free_ids[0];
+                uint32_t last = free_ids[--free_count];
+                uint32_t i = 0;
+                for (;;) {
+                        uint32_t child = 2 * i + 1;
+                        if (child >= free_count) break;
+                        if (child + 1 < free_count && free_ids[child + 1] < free_ids[child]) child++;
+                        if (free_ids[child] >= last) break;
+                        free_ids[i] = free_ids[child];
+                        i = child;
+                }
+                if (free_count > 0) free_ids[i] = last;
+        } else if (next_id <= EI_PICK_ID_MAX) {
+                *id = next_id++;
+        } else {
+                return EI_FALSE;
+        }
+        if (*id > UINT16_MAX && wide_count++ == 0) set_depth(sizeof(uint32_t));
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Releases the pick ID of a destroyed widget, to give it to a new one. The picking
+ *		offscreen switches back to 16 bits IDs when no ID in use needs 32 bits.
+ *
+ * @param	id		The ID.
+ */
+void ei_picking_release_id (uint32_t id)
+{
+        if (free_count == free_capacity) {
+                free_capacity = (free_capacity > 0) ? 2 * free_capacity : 64;
+                uint32_t *grown = ei_malloc(free_capacity * sizeof(uint32_t));
+                if (free_ids != NULL) memcpy(grown, free_ids, free_count * sizeof(uint32_t));
+                free(free_ids);
+                free_ids = grown;
+        }
+        // Push the ID, and sift it up
+        uint32_t i = free_count++;
+        while (i > 0 && free_ids[(i - 1) / 2] > id) {
+                free_ids[i] = free_ids[(i - 1) / 2];
+                i = (i - 1) / 2;
+        }
+        free_ids[i] = id;
+        if (id > UINT16_MAX && --wide_count == 0) set_depth(sizeof(uint16_t));
+}
+
+/**
+ * @brief	Clips a rectangle to the picking offscreen.
+ *
+ * @param	rect		The rectangle, or NULL for the whole offscreen.
+ * @param	x0, y0		Where to store the top left corner of the clipped rectangle.
+ * @param	x1, y1		Where to store the bottom right corner, excluded.
+ *
+ * @return			EI_FALSE if nothing is left.
+ */
+static ei_bool_t clip(const ei_rect_t* rect, int* x0, int* y0, int* x1, int* y1)
+{
+        *x0 = 0;
+        *y0 = 0;
+        *x1 = picking_surface->size.width;
+        *y1 = picking_surface->size.height;
+        if (rect != NULL) {
+                if (rect->top_left.x > *x0) *x0 = rect->top_left.x;
+                if (rect->top_left.y > *y0) *y0 = rect->top_left.y;
+                if (rect->top_left.x + rect->size.width < *x1) *x1 = rect->top_left.x + rect->size.width;
+                if (rect->top_left.y + rect->size.height < *y1) *y1 = rect->top_left.y + rect->size.height;
+        }
+        return (*x0 < *x1 && *y0 < *y1) ? EI_TRUE : EI_FALSE;
+}
+
+/**
+ * \brief	Stores an ID in a rectangle of the picking offscreen.
+ *
+ * @param	rect		The rectangle, clipped to the offscreen. If NULL, the whole offscreen.
+ * @param	id		The ID.
+ */
+void ei_picking_fill (const ei_rect_t* rect, uint32_t id)
+{
+        int x0, y0, x1, y1;
+        if (picking_surface == NULL || !clip(rect, &x0, &y0, &x1, &y1)) return;
+
+        int width = picking_surface->size.width;
+        if (picking_surface->depth == sizeof(uint16_t)) {
+                for (int y = y0; y < y1; y++) {
+                        uint16_t *row = (uint16_t*) picking_surface->ids + (size_t) y * width;
+                        for (int x = x0; x < x1; x++) row[x] = (uint16_t) id;
+                }
+        } else {
+                for (int y = y0; y < y1; y++) {
+                        uint32_t *row = (uint32_t*) picking_surface->ids + (size_t) y * width;
+                        for (int x = x0; x < x1; x++) row[x] = id;
+                }
+        }
+}
+
+/**
+ * \brief	Stores an ID in the pixels of a rectangle of the picking offscreen where a mask
+ *		is not transparent.
+ *
+ * @param	dst_rect	The rectangle of the offscreen.
+ * @param	mask		The mask, *locked*: a surface with an alpha channel.
+ * @param	src_rect	The rectangle of the mask, of the same size as dst_rect.
+ * @param	id		The ID.
+ */
+void ei_picking_fill_mask (const ei_rect_t* dst_rect, ei_surface_t mask, const ei_rect_t* src_rect,
+                           uint32_t id)
+{
+        int x0, y0, x1, y1;
+        if (picking_surface == NULL || !clip(dst_rect, &x0, &y0, &x1, &y1)) return;
+
+        int ir, ig, ib, ia;
+        hw_surface_get_channel_indices(mask, &ir, &ig, &ib, &ia);
+        if (ia == -1) return;
+        uint32_t alpha_mask = (uint32_t) 0xff << (ia * 8);
+        int mask_width = hw_surface_get_size(mask).width;
+        uint32_t *mask_pixels = (uint32_t*) hw_surface_get_buffer(mask);
+        int dx = src_rect->top_left.x - dst_rect->top_left.x;
+        int dy = src_rect->top_left.y - dst_rect->top_left.y;
+        int width = picking_surface->size.width;
+
+        for (int y = y0; y < y1; y++) {
+                uint32_t *mask_row = mask_pixels + (size_t) (y + dy) * mask_width + dx;
+                if (picking_surface->depth == sizeof(uint16_t)) {
+                        uint16_t *row = (uint16_t*) picking_surface->ids + (size_t) y * width;
+                        for (int x = x0; x < x1; x++) if (mask_row[x] & alpha_mask) row[x] = (uint16_t) id;
+                } else {
+                        uint32_t *row = (uint32_t*) picking_surface->ids + (size_t) y * width;
+                        for (int x = x0; x < x1; x++) if (mask_row[x] & alpha_mask) row[x] = id;
+                }
+        }
+}
+
+/**
+ * \brief	Moves the IDs of a rectangle of the picking offscreen by an offset, in place, as
+ *		\ref move_rect does with the pixels of the root window.
+ *
+ * @param	rect		The rectangle, which must be inside the offscreen.
+ * @param	dx, dy		The offset, smaller than the size of the rectangle.
+ */
+void ei_picking_move (const ei_rect_t* rect, int dx, int dy)
+{
+        int width = rect->size.width - abs(dx);
+        int height = rect->size.height - abs(dy);
+        if (picking_surface == NULL || width <= 0 || height <= 0 || (dx == 0 && dy == 0)) return;
+        size_t depth = (size_t) picking_surface->depth;
+        size_t stride = (size_t) picking_surface->size.width * depth;
+        int src_x = rect->top_left.x + ((dx < 0) ? -dx : 0);
+        int dst_x = rect->top_left.x + ((dx > 0) ? dx : 0);
+        uint8_t *ids = picking_surface->ids;
+
+        for (int j = 0; j < height; j++) {
+                int row = (dy > 0) ? height - 1 - j : j;
+                int src_y = rect->top_left.y + ((dy < 0) ? -dy : 0) + row;
+                memmove(ids + (size_t) (src_y + dy) * stride + dst_x * depth,
+                        ids + (size_t) src_y * stride + src_x * depth, (size_t) width * depth);
+        }
+}
+
+/**
+ * \brief	Returns the ID stored at a location of the picking offscreen.
+ *
+ * @param	where		The location, in the root window coordinates.
+ *
+ * @return			The ID, or 0 outside of the offscreen.
+ */
+uint32_t ei_picking_get_id (const ei_point_t* where)
+{
+        if (picking_surface == NULL || where->x < 0 || where->y < 0 ||
+            where->x >= picking_surface->size.width || where->y >= picking_surface->size.height) return 0;
+        size_t index = (size_t) where->y * picking_surface->size.width + where->x;
+        if (picking_surface->depth == sizeof(uint16_t)) return ((uint16_t*) picking_surface->ids)[index];
+        return ((uint32_t*) picking_surface->ids)[index];
+}
+
+/**
+ * \brief	Returns the rectangle of the picking offscreen.
  *
- * @param	widget		The widget to declare as the picking surface.
+ * @return			The rectangle of the root window.
  */
-void ei_picking_set_picking_surface (ei_surface_t *surface)
+ei_rect_t ei_picking_get_rect (void)
 {
-        picking_surface = surface;
-}
\ No newline at end of file
+        ei_rect_t rect = {{0, 0}, {0, 0}};
+        if (picking_surface != NULL) rect.size = picking_surface->size;
+        return rect;
+}
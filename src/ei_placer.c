@@ -1,7 +1,23 @@
+#include "ei_gridder.h"
 #include "ei_placer.h"
+#include "ei_trace.h"
 #include "ei_types.h"
 #include "ei_widget.h"
 
+/**
+ * @brief	Redraws a widget where it is placed, decorations of a toplevel included, and
+ *		where it is visible.
+ *
+ * @param	widget		The widget. Nothing is done for the root widget, or for a widget
+ *				that was never placed.
+ */
+static void invalidate_placed(struct ei_widget_t* widget)
+{
+        if (widget->parent == NULL) return;
+        ei_rect_t outer_rect = ei_widget_outer_rect(widget);
+        ei_widget_invalidate_rect(widget, &outer_rect);
+}
+
 /**
  * \brief	Configures the geometry of a widget using the "placer" geometry manager.
  *
@@ -15,6 +31,8 @@
  *		relative), then either the requested size of the widget is used if one was provided,
  *		or the default size is used.
  *
+ *		If the widget was managed by the "gridder", it stops being.
+ *
  * @param	widget		The widget to place.
  * @param	anchor		How to anchor the widget to the position defined by the placer
  *				(defaults to ei_anc_northwest).
@@ -36,6 +54,9 @@
 void ei_place(struct ei_widget_t* widget, ei_anchor_t* anchor, int* x, int* y, int* width,
               int* height, float* rel_x, float*	rel_y, float* rel_width, float*	rel_height)
 {
+        // Only the old and the new places of the widget are redrawn
+        invalidate_placed(widget);
+        ei_gridder_forget(widget);
         if (!anchor) {
                 widget->placer_params->anchor_data = ei_anc_northwest;
                 widget->placer_params->anchor = &widget->placer_params->anchor_data;
@@ -107,18 +128,26 @@ void ei_place(struct ei_widget_t* widget, ei_anchor_t* anchor, int* x, int* y, i
                 widget->placer_params->rh_data = *rel_height;
                 widget->placer_params->rh = rel_height;
         }
+        if (widget->parent != NULL) {
+                ei_placer_run(widget);
+                invalidate_placed(widget);
+        }
 }
 
 /**
- * \brief	Tells the placer to recompute the geometry of a widget.
- *		The widget must have been previsouly placed by a call to \ref ei_place.
- *		Geometry re-computation is necessary for example when the text label of
- *		a widget has changed, and thus the widget "natural" size has changed.
+ * \brief	Computes the geometry the placer gives to a widget, without moving the widget,
+ *		e.g. to know if it is visible before placing it.
+ *		Widgets managed by the "gridder" are computed by \ref ei_gridder_rect instead.
  *
- * @param	widget		The widget which geometry must be re-computed.
+ * @param	widget		The widget, previously placed by a call to \ref ei_place.
+ *
+ * @return			The geometry, in the root window coordinates.
  */
-void ei_placer_run(struct ei_widget_t* widget)
+ei_rect_t ei_placer_rect(struct ei_widget_t* widget)
 {
+        if (widget->placer_params->grid != NULL) return ei_gridder_rect(widget);
+        ei_trace_begin("ei_placer_rect");
+        ei_rect_t rect = widget->screen_location;
         int x = ((int) (widget->placer_params->rx_data * (float) (widget->parent->content_rect->size.width)) +
                 widget->parent->content_rect->top_left.x + widget->placer_params->x_data);
         int y = ((int) (widget->placer_params->ry_data * (float) (widget->parent->content_rect->size.height)) +
@@ -140,42 +169,57 @@ void ei_placer_run(struct ei_widget_t* widget)
                 height = widget->requested_size.height;
         }
 
-        widget->screen_location.size.width = width;
-        widget->screen_location.size.height = height;
+        rect.size.width = width;
+        rect.size.height = height;
 
         if (widget->placer_params->anchor_data == ei_anc_northwest) {
-                widget->screen_location.top_left.x = x;
-                widget->screen_location.top_left.y = y;
+                rect.top_left.x = x;
+                rect.top_left.y = y;
         } else if (widget->placer_params->anchor_data == ei_anc_north) {
-                widget->screen_location.top_left.x = x - (int) (width/2);
-                widget->screen_location.top_left.y = y;
+                rect.top_left.x = x - (int) (width/2);
+                rect.top_left.y = y;
         } else if (widget->placer_params->anchor_data == ei_anc_northeast) {
-                widget->screen_location.top_left.x = x - width;
-                widget->screen_location.top_left.y = y;
+                rect.top_left.x = x - width;
+                rect.top_left.y = y;
         } else if (widget->placer_params->anchor_data == ei_anc_east) {
-                widget->screen_location.top_left.x = x - width;
-                widget->screen_location.top_left.y = y - (int) (height/2);
+                rect.top_left.x = x - width;
+                rect.top_left.y = y - (int) (height/2);
         } else if (widget->placer_params->anchor_data == ei_anc_southeast) {
-                widget->screen_location.top_left.x = x - width;
-                widget->screen_location.top_left.y = y - height;
+                rect.top_left.x = x - width;
+                rect.top_left.y = y - height;
         } else if (widget->placer_params->anchor_data == ei_anc_south) {
-                widget->screen_location.top_left.x = x - (int) (width/2);
-                widget->screen_location.top_left.y = y - height;
+                rect.top_left.x = x - (int) (width/2);
+                rect.top_left.y = y - height;
         } else if (widget->placer_params->anchor_data == ei_anc_southwest) {
-                widget->screen_location.top_left.x = x;
-                widget->screen_location.top_left.y = y - height;
+                rect.top_left.x = x;
+                rect.top_left.y = y - height;
         } else if (widget->placer_params->anchor_data == ei_anc_west) {
-                widget->screen_location.top_left.x = x;
-                widget->screen_location.top_left.y = y - (int) (height/2);
+                rect.top_left.x = x;
+                rect.top_left.y = y - (int) (height/2);
         } else if (widget->placer_params->anchor_data == ei_anc_center) {
-                widget->screen_location.top_left.x = x - (int) (width/2);
-                widget->screen_location.top_left.y = y - (int) (height/2);
+                rect.top_left.x = x - (int) (width/2);
+                rect.top_left.y = y - (int) (height/2);
         } else if (widget->placer_params->anchor_data == ei_anc_none) {
-                widget->screen_location.size.height = 0;
-                widget->screen_location.size.width = 0;
-                widget->screen_location.top_left.x = 0;
-                widget->screen_location.top_left.y = 0;
+                rect.size.height = 0;
+                rect.size.width = 0;
+                rect.top_left.x = 0;
+                rect.top_left.y = 0;
         }
+        ei_trace_end("ei_placer_rect");
+        return rect;
+}
+
+/**
+ * \brief	Tells the placer to recompute the geometry of a widget.
+ *		The widget must have been previsouly placed by a call to \ref ei_place.
+ *		Geometry re-computation is necessary for example when the text label of
+ *		a widget has changed, and thus the widget "natural" size has changed.
+ *
+ * @param	widget		The widget which geometry must be re-computed.
+ */
+void ei_placer_run(struct ei_widget_t* widget)
+{
+        widget->screen_location = ei_placer_rect(widget);
 }
 
 /**
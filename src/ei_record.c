@@ -0,0 +1,720 @@
+#include <string.h>
+#include "ei_arena.h"
+#include "ei_draw.h"
+#include "ei_picking.h"
+#include "ei_record.h"
+#include "ei_skin.h"
+#include "ei_stats.h"
+#include "ei_trace.h"
+#include "ei_utils.h"
+
+ei_bool_t ei_recording = EI_FALSE;
+
+typedef enum {
+        command_fill = 0,
+        command_polyline,
+        command_polygon,
+        command_copy,
+        command_skin
+} command_type_t;
+
+/**
+ * @brief	A drawing recorded from the draw function of a widget, with what it needs to be
+ *		drawn again without the widget.
+ */
+typedef struct command_t {
+        command_type_t type;
+        ei_rect_t bounds;               // Where the command can draw: it is skipped elsewhere
+        ei_surface_t surface;
+        ei_surface_t pick_surface;      // NULL if the command only draws in surface
+        ei_bool_t has_color;            // EI_FALSE for a fill of the picking offscreen with ID 0
+        ei_color_t color;               // Also the color of the shape of a skin mask
+        ei_color_t pick_color;
+        ei_rect_t rect;                 // The destination of a copy, or the rectangle of a skin
+        ei_point_t src_origin;          // The top left corner of the source of a copy
+        ei_surface_t source;
+        ei_bool_t alpha;
+        ei_bool_t owned;                // The source is a text rendered by the record
+        ei_bool_t mask;                 // The skin is drawn by ei_skin_draw_mask
+        ei_skin_key_t skin;             // The skin is looked up again, the cache may have released it
+        int first_point;
+        int point_count;
+} command_t;
+
+/**
+ * @brief	The commands drawn by a widget the last time it was recorded.
+ */
+typedef struct ei_record_t {
+        ei_bool_t valid;                // The widget has not changed since it was recorded
+        ei_bool_t direct;               // The widget draws too much to be recorded
+        ei_bool_t overflow;             // Too many commands in the recording in progress
+        ei_rect_t location;             // The screen location of the widget when it was recorded
+        ei_rect_t content;              // Its content rectangle
+        ei_rect_t area;                 // The rectangle it was recorded in
+        ei_surface_t surface;           // The surfaces it was recorded in
+        ei_surface_t pick_surface;
+        command_t* commands;
+        int command_count;
+        int command_capacity;
+        ei_point_t* points;
+        int point_count;
+        int point_capacity;
+} ei_record_t;
+
+/**
+ * @brief	A class of widgets which can be recorded.
+ */
+typedef struct ei_record_class_t {
+        ei_widgetclass_t* widgetclass;
+        struct ei_record_class_t* next;
+} ei_record_class_t;
+
+static ei_record_class_t *record_classes = NULL;
+static ei_bool_t recording_enabled = EI_TRUE;
+static ei_record_t **records = NULL;    // The records, by pick ID of their widget
+static uint32_t record_capacity = 0;
+static ei_record_t *current = NULL;     // The record in progress
+
+/**
+ * @brief	Computes the intersection of two rectangles.
+ *
+ * @param	first_rect	The first rectangle.
+ * @param	sec_rect	The second rectangle.
+ * @param	intersection	Where to store the intersection.
+ *
+ * @return			EI_TRUE if the intersection is not empty.
+ */
+static ei_bool_t clip_rect(const ei_rect_t* first_rect, const ei_rect_t* sec_rect, ei_rect_t* intersection)
+{
+        int x_min = (first_rect->top_left.x > sec_rect->top_left.x) ? first_rect->top_left.x : sec_rect->top_left.x;
+        int y_min = (first_rect->top_left.y > sec_rect->top_left.y) ? first_rect->top_left.y : sec_rect->top_left.y;
+        int f_x_max = first_rect->top_left.x + first_rect->size.width;
+        int s_x_max = sec_rect->top_left.x + sec_rect->size.width;
+        int f_y_max = first_rect->top_left.y + first_rect->size.height;
+        int s_y_max = sec_rect->top_left.y + sec_rect->size.height;
+        int x_max = (f_x_max < s_x_max) ? f_x_max : s_x_max;
+        int y_max = (f_y_max < s_y_max) ? f_y_max : s_y_max;
+
+        if (x_max <= x_min || y_max <= y_min) return EI_FALSE;
+        intersection->top_left.x = x_min;
+        intersection->top_left.y = y_min;
+        intersection->size.width = x_max - x_min;
+        intersection->size.height = y_max - y_min;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Tells if a rectangle contains another one.
+ */
+static ei_bool_t contains_rect(const ei_rect_t* outer, const ei_rect_t* inner)
+{
+        return (ei_bool_t) (inner->top_left.x >= outer->top_left.x && inner->top_left.y >= outer->top_left.y &&
+                            inner->top_left.x + inner->size.width <= outer->top_left.x + outer->size.width &&
+                            inner->top_left.y + inner->size.height <= outer->top_left.y + outer->size.height);
+}
+
+static ei_rect_t translate_rect(ei_rect_t rect, ei_point_t delta)
+{
+        rect.top_left.x += delta.x;
+        rect.top_left.y += delta.y;
+        return rect;
+}
+
+/**
+ * @brief	Returns the rectangle of a surface, which can be the picking offscreen.
+ */
+static ei_rect_t surface_rect(ei_surface_t surface)
+{
+        return ei_picking_is_buffer(surface) ? ei_picking_get_rect() : hw_surface_get_rect(surface);
+}
+
+/**
+ * @brief	Returns the record of a widget.
+ *
+ * @param	widget		The widget.
+ * @param	create		EI_TRUE to create the record if the widget has none.
+ *
+ * @return			The record, or NULL if the widget has none and create is EI_FALSE.
+ */
+static ei_record_t* get_record(ei_widget_t* widget, ei_bool_t create)
+{
+        uint32_t id = widget->pick_id;
+        if (id >= record_capacity) {
+                if (!create) return NULL;
+                uint32_t capacity = (record_capacity > 0) ? 2 * record_capacity : 64;
+                while (capacity <= id) capacity *= 2;
+                ei_record_t **grown = ei_calloc(capacity, sizeof(ei_record_t*));
+                if (records != NULL) memcpy(grown, records, record_capacity * sizeof(ei_record_t*));
+                free(records);
+                records = grown;
+                record_capacity = capacity;
+        }
+        if (records[id] == NULL && create) records[id] = ei_calloc(1, sizeof(ei_record_t));
+        return records[id];
+}
+
+/**
+ * @brief	Removes all the commands of a record, and releases the texts it has rendered.
+ */
+static void clear_commands(ei_record_t* record)
+{
+        for (int i = 0; i < record->command_count; i++) {
+                if (record->commands[i].owned) hw_surface_free(record->commands[i].source);
+        }
+        record->command_count = 0;
+        record->point_count = 0;
+        record->valid = EI_FALSE;
+}
+
+/**
+ * @brief	Releases a record.
+ */
+static void free_record(ei_record_t* record)
+{
+        clear_commands(record);
+        free(record->commands);
+        free(record->points);
+        free(record);
+}
+
+/**
+ * @brief	Adds a command to the record in progress.
+ *
+ * @param	type		The kind of command.
+ * @param	surface		The surface drawn in.
+ *
+ * @return			The command, set to 0, or NULL if the record has too many commands.
+ */
+static command_t* add_command(command_type_t type, ei_surface_t surface)
+{
+        if (current->overflow) return NULL;
+        if (current->command_count == EI_RECORD_MAX_COMMANDS) {
+                current->overflow = EI_TRUE;
+                return NULL;
+        }
+        if (current->command_count == current->command_capacity) {
+                int capacity = (current->command_capacity > 0) ? 2 * current->command_capacity : 8;
+                command_t *grown = ei_malloc((size_t) capacity * sizeof(command_t));
+                if (current->commands != NULL) memcpy(grown, current->commands, (size_t) current->command_count * sizeof(command_t));
+                free(current->commands);
+                current->commands = grown;
+                current->command_capacity = capacity;
+        }
+        command_t *command = &current->commands[current->command_count++];
+        memset(command, 0, sizeof(command_t));
+        command->type = type;
+        command->surface = surface;
+        return command;
+}
+
+/**
+ * @brief	Sets the bounds of the last command added, and removes it if it draws nothing.
+ *
+ * @param	command		The command.
+ * @param	extent		Where the drawing of the command can be.
+ * @param	clipper		The clipper of the drawing, NULL for the whole surface.
+ *
+ * @return			EI_FALSE if the command has been removed.
+ */
+static ei_bool_t bound_command(command_t* command, const ei_rect_t* extent, const ei_rect_t* clipper)
+{
+        ei_rect_t area = surface_rect(command->surface);
+        if ((clipper != NULL && !clip_rect(&area, clipper, &area)) || !clip_rect(&area, extent, &command->bounds)) {
+                current->command_count--;
+                return EI_FALSE;
+        }
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Adds a point to the record in progress.
+ *
+ * @param	command		The command drawing it.
+ * @param	point		The point.
+ */
+static void add_point(command_t* command, ei_point_t point)
+{
+        if (current->point_count == current->point_capacity) {
+                int capacity = (current->point_capacity > 0) ? 2 * current->point_capacity : 32;
+                ei_point_t *grown = ei_malloc((size_t) capacity * sizeof(ei_point_t));
+                if (current->points != NULL) memcpy(grown, current->points, (size_t) current->point_count * sizeof(ei_point_t));
+                free(current->points);
+                current->points = grown;
+                current->point_capacity = capacity;
+        }
+        current->points[current->point_count++] = point;
+        command->point_count++;
+}
+
+/**
+ * @brief	Copies the points of a line or a polygon in the record in progress. A list whose
+ *		last point links back to the first one, as \ref ei_draw_polyline accepts, is
+ *		walked once.
+ *
+ * @param	command		The command drawing them.
+ * @param	first_point	The points.
+ *
+ * @return			The rectangle containing the points.
+ */
+static ei_rect_t add_points(command_t* command, const ei_linked_point_t* first_point)
+{
+        command->first_point = current->point_count;
+        const ei_linked_point_t *curr = first_point;
+        do {
+                add_point(command, curr->point);
+                curr = curr->next;
+        } while (curr != NULL && curr != first_point);
+        // The segment closing a loop is drawn too
+        if (curr == first_point) add_point(command, first_point->point);
+
+        ei_point_t *points = &current->points[command->first_point];
+        int x_min = points[0].x, x_max = x_min;
+        int y_min = points[0].y, y_max = y_min;
+        for (int i = 1; i < command->point_count; i++) {
+                x_min = (points[i].x < x_min) ? points[i].x : x_min;
+                x_max = (points[i].x > x_max) ? points[i].x : x_max;
+                y_min = (points[i].y < y_min) ? points[i].y : y_min;
+                y_max = (points[i].y > y_max) ? points[i].y : y_max;
+        }
+        return ei_rect(ei_point(x_min, y_min), ei_size(x_max - x_min + 1, y_max - y_min + 1));
+}
+
+/**
+ * \brief	Tells if a surface is one the widget being recorded is drawn in. Use
+ *		\ref ei_record_capturing instead.
+ *
+ * @param	surface		The surface.
+ *
+ * @return			EI_TRUE if the drawing in this surface must be recorded.
+ */
+ei_bool_t ei_record_captures(ei_surface_t surface)
+{
+        return (ei_bool_t) (current != NULL && surface != NULL &&
+                            (surface == current->surface || surface == current->pick_surface));
+}
+
+/**
+ * \brief	Records \ref ei_fill.
+ */
+void ei_record_fill(ei_surface_t surface, const ei_color_t* color, const ei_rect_t* clipper)
+{
+        command_t *command = add_command(command_fill, surface);
+        if (command == NULL) return;
+        command->has_color = (ei_bool_t) (color != NULL);
+        if (color != NULL) command->color = *color;
+        ei_rect_t area = surface_rect(surface);
+        bound_command(command, &area, clipper);
+}
+
+/**
+ * \brief	Records \ref ei_fill_with_pick.
+ */
+void ei_record_fill_with_pick(ei_surface_t surface, const ei_color_t* color, ei_surface_t pick_surface,
+                              const ei_color_t* pick_color, const ei_rect_t* clipper)
+{
+        command_t *command = add_command(command_fill, surface);
+        if (command == NULL) return;
+        command->has_color = EI_TRUE;
+        command->color = *color;
+        command->pick_surface = pick_surface;
+        if (pick_surface != NULL) command->pick_color = *pick_color;
+        ei_rect_t area = surface_rect(surface);
+        bound_command(command, &area, clipper);
+}
+
+/**
+ * \brief	Records \ref ei_draw_polyline.
+ */
+void ei_record_polyline(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                        const ei_rect_t* clipper)
+{
+        if (first_point == NULL) return;
+        command_t *command = add_command(command_polyline, surface);
+        if (command == NULL) return;
+        command->color = color;
+        ei_rect_t extent = add_points(command, first_point);
+        // A single point is drawn at the top left corner of the surface, whatever the clipper
+        if (command->point_count == 1) {
+                extent = surface_rect(surface);
+                clipper = NULL;
+        }
+        bound_command(command, &extent, clipper);
+}
+
+/**
+ * \brief	Records \ref ei_draw_polygon and \ref ei_draw_polygon_with_pick.
+ */
+void ei_record_polygon(ei_surface_t surface, const ei_linked_point_t* first_point, ei_color_t color,
+                       ei_surface_t pick_surface, const ei_color_t* pick_color, const ei_rect_t* clipper)
+{
+        if (first_point == NULL || first_point->next == NULL || first_point->next->next == NULL) return;
+        command_t *command = add_command(command_polygon, surface);
+        if (command == NULL) return;
+        command->color = color;
+        command->pick_surface = pick_surface;
+        if (pick_surface != NULL) command->pick_color = *pick_color;
+        ei_rect_t extent = add_points(command, first_point);
+        bound_command(command, &extent, clipper);
+}
+
+/**
+ * \brief	Records \ref ei_draw_text. The text is rendered once, when it is recorded.
+ */
+void ei_record_text(ei_surface_t surface, const ei_point_t* where, const char* text, ei_font_t font,
+                    ei_color_t color, const ei_rect_t* clipper)
+{
+        if (text == NULL) return;
+        command_t *command = add_command(command_copy, surface);
+        if (command == NULL) return;
+        if (font == NULL) font = ei_default_font;
+        // The text is laid out and rendered once, and replayed as a copy of the rendered surface
+        command->source = hw_text_create_surface(text, font, color);
+        ei_stats.text_surfaces++;
+        command->owned = EI_TRUE;
+        command->alpha = EI_TRUE;
+        command->rect = ei_rect(*where, hw_surface_get_size(command->source));
+        command->src_origin = ei_point_zero();
+        if (!bound_command(command, &command->rect, clipper)) hw_surface_free(command->source);
+}
+
+/**
+ * \brief	Records \ref ei_copy_surface. The source surface is read when the command is
+ *		replayed: it must stay valid until the widget is invalidated.
+ *
+ * @return			1 if the source and destination areas have different sizes, like
+ *				\ref ei_copy_surface, 0 otherwise.
+ */
+int ei_record_copy(ei_surface_t destination, const ei_rect_t* dst_rect, ei_surface_t source,
+                   const ei_rect_t* src_rect, ei_bool_t alpha)
+{
+        ei_rect_t dst = (dst_rect != NULL) ? *dst_rect : hw_surface_get_rect(destination);
+        ei_rect_t src = (src_rect != NULL) ? *src_rect : hw_surface_get_rect(source);
+        if (dst.size.width != src.size.width || dst.size.height != src.size.height) return 1;
+        command_t *command = add_command(command_copy, destination);
+        if (command == NULL) return 0;
+        command->source = source;
+        command->alpha = alpha;
+        command->rect = dst;
+        command->src_origin = src.top_left;
+        bound_command(command, &dst, NULL);
+        return 0;
+}
+
+/**
+ * \brief	Records \ref ei_skin_draw, \ref ei_skin_draw_mask and \ref ei_skin_draw_with_pick.
+ *
+ * @param	surface		Where the skin is drawn.
+ * @param	skin		The skin.
+ * @param	rect		Where to draw the skin.
+ * @param	mask_color	The color of the shape for \ref ei_skin_draw_mask, NULL otherwise.
+ * @param	pick_surface	The picking offscreen for \ref ei_skin_draw_with_pick, NULL otherwise.
+ * @param	pick_color	The pick color for \ref ei_skin_draw_with_pick.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_record_skin(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                    const ei_color_t* mask_color, ei_surface_t pick_surface, const ei_color_t* pick_color,
+                    const ei_rect_t* clipper)
+{
+        command_t *command = add_command(command_skin, surface);
+        if (command == NULL) return;
+        command->skin = skin->key;
+        command->rect = *rect;
+        command->mask = (ei_bool_t) (mask_color != NULL);
+        if (mask_color != NULL) command->color = *mask_color;
+        command->pick_surface = pick_surface;
+        if (pick_surface != NULL) command->pick_color = *pick_color;
+        bound_command(command, rect, clipper);
+}
+
+/**
+ * @brief	Returns the surface a command draws in, among the surfaces a record is replayed in.
+ */
+static ei_surface_t replay_surface(const ei_record_t* record, ei_surface_t recorded, ei_surface_t surface,
+                                   ei_surface_t pick_surface)
+{
+        if (recorded == record->surface) return surface;
+        if (recorded != NULL && recorded == record->pick_surface) return pick_surface;
+        return recorded;
+}
+
+/**
+ * @brief	Builds the linked points of a line or a polygon of a record, in the frame arena.
+ *
+ * @param	record		The record.
+ * @param	command		The command of the line or polygon.
+ * @param	delta		The offset of the widget since it was recorded.
+ *
+ * @return			The head of the points.
+ */
+static ei_linked_point_t* linked_points(const ei_record_t* record, const command_t* command, ei_point_t delta)
+{
+        ei_linked_point_t *points = ei_arena_alloc((size_t) command->point_count * sizeof(ei_linked_point_t));
+        for (int i = 0; i < command->point_count; i++) {
+                ei_point_t point = record->points[command->first_point + i];
+                points[i].point = ei_point(point.x + delta.x, point.y + delta.y);
+                points[i].next = (i + 1 < command->point_count) ? &points[i + 1] : NULL;
+        }
+        return points;
+}
+
+/**
+ * @brief	Draws the commands of a record that intersect a clipper.
+ *
+ * @param	record		The record.
+ * @param	surface		Where to draw.
+ * @param	pick_surface	The picking offscreen.
+ * @param	clipper		The drawing is restricted within this rectangle.
+ * @param	delta		The offset of the widget since it was recorded.
+ */
+static void replay(const ei_record_t* record, ei_surface_t surface, ei_surface_t pick_surface,
+                   const ei_rect_t* clipper, ei_point_t delta)
+{
+        for (int i = 0; i < record->command_count; i++) {
+                const command_t *command = &record->commands[i];
+                ei_rect_t bounds = translate_rect(command->bounds, delta);
+                ei_rect_t clip;
+                // The bounds are inside the clipper of the command, it is restricted to them
+                if (!clip_rect(&bounds, clipper, &clip)) continue;
+                ei_stats.commands_replayed++;
+
+                ei_surface_t target = replay_surface(record, command->surface, surface, pick_surface);
+                ei_surface_t pick_target = replay_surface(record, command->pick_surface, surface, pick_surface);
+                const ei_color_t *pick_color = (pick_target != NULL) ? &command->pick_color : NULL;
+                ei_rect_t rect = translate_rect(command->rect, delta);
+                switch (command->type) {
+                        case command_fill:
+                                if (pick_target != NULL) {
+                                        ei_fill_with_pick(target, &command->color, pick_target, pick_color, &clip);
+                                } else {
+                                        ei_fill(target, command->has_color ? &command->color : NULL, &clip);
+                                }
+                                break;
+                        case command_polyline:
+                        case command_polygon: {
+                                ei_arena_mark_t mark = ei_arena_get_mark();
+                                ei_linked_point_t *points = linked_points(record, command, delta);
+                                if (command->type == command_polyline) {
+                                        ei_draw_polyline(target, points, command->color, &clip);
+                                } else {
+                                        ei_draw_polygon_with_pick(target, points, command->color, pick_target,
+                                                                  pick_color, &clip);
+                                }
+                                ei_arena_rewind(mark);
+                                break;
+                        }
+                        case command_copy: {
+                                ei_rect_t src = {{command->src_origin.x + clip.top_left.x - rect.top_left.x,
+                                                  command->src_origin.y + clip.top_left.y - rect.top_left.y},
+                                                 clip.size};
+                                hw_surface_lock(command->source);
+                                ei_copy_surface(target, &clip, command->source, &src, command->alpha);
+                                hw_surface_unlock(command->source);
+                                break;
+                        }
+                        case command_skin: {
+                                const ei_skin_key_t *key = &command->skin;
+                                ei_skin_t *skin = ei_skin_get(&key->color, key->border_width, key->corner_radius,
+                                                              key->relief, key->rounded);
+                                if (command->mask) {
+                                        ei_skin_draw_mask(target, skin, &rect, &command->color, &clip);
+                                } else {
+                                        ei_skin_draw_with_pick(target, skin, &rect, pick_target, pick_color, &clip);
+                                }
+                                break;
+                        }
+                }
+        }
+}
+
+/**
+ * @brief	Records the draw function of a widget: it is called on all the area the widget can
+ *		be drawn in, and its drawing is stored instead of drawn.
+ *
+ * @param	record		The record of the widget.
+ * @param	widget		The widget.
+ * @param	surface		Where the widget is drawn.
+ * @param	pick_surface	The picking offscreen.
+ * @param	area		The content rect of its parent, inside the surface.
+ */
+static void record_widget(ei_record_t* record, ei_widget_t* widget, ei_surface_t surface,
+                          ei_surface_t pick_surface, const ei_rect_t* area)
+{
+        clear_commands(record);
+        record->overflow = EI_FALSE;
+        record->location = widget->screen_location;
+        record->content = *widget->content_rect;
+        record->area = *area;
+        record->surface = surface;
+        record->pick_surface = pick_surface;
+
+        ei_trace_begin("ei_record");
+        ei_rect_t clipper = *area;
+        current = record;
+        ei_recording = EI_TRUE;
+        widget->wclass->drawfunc(widget, surface, pick_surface, &clipper);
+        ei_recording = EI_FALSE;
+        current = NULL;
+        ei_stats.widgets_recorded++;
+        ei_trace_end("ei_record");
+
+        if (record->overflow) {
+                // Replaying would not be faster than the class, e.g. for containers of items
+                clear_commands(record);
+                record->direct = EI_TRUE;
+        } else {
+                record->valid = EI_TRUE;
+        }
+}
+
+/**
+ * @brief	Tells if the widgets of a class can be recorded.
+ *
+ * @param	widgetclass	The class of widget.
+ *
+ * @return			EI_TRUE if the class was declared by \ref ei_record_register.
+ */
+static ei_bool_t is_recorded(const ei_widgetclass_t* widgetclass)
+{
+        for (ei_record_class_t *curr = record_classes; curr != NULL; curr = curr->next) {
+                if (curr->widgetclass == widgetclass) return EI_TRUE;
+        }
+        return EI_FALSE;
+}
+
+/**
+ * \brief	Declares that the widgets of a class can be recorded. Their class must redraw
+ *		them all when their appearance changes, with \ref ei_widget_invalidate or by
+ *		configuring them. Widgets of other classes are always drawn by their class.
+ *
+ * @param	widgetclass	The class of widget.
+ */
+void ei_record_register(ei_widgetclass_t* widgetclass)
+{
+        if (is_recorded(widgetclass)) return;
+        ei_record_class_t *record_class = ei_calloc(1, sizeof(ei_record_class_t));
+        record_class->widgetclass = widgetclass;
+        record_class->next = record_classes;
+        record_classes = record_class;
+}
+
+/**
+ * \brief	Forgets all the classes declared by \ref ei_record_register.
+ */
+void ei_record_unregister_all(void)
+{
+        ei_record_class_t *temp = NULL;
+        while (record_classes) {
+                temp = record_classes->next;
+                free(record_classes);
+                record_classes = temp;
+        }
+}
+
+/**
+ * \brief	Draws a widget from its record: the commands drawn by its class the last time it
+ *		was recorded, with their bounds, are replayed where they intersect the clipper.
+ *		The class is only called again to record the widget when it has been invalidated,
+ *		when its size has changed, or when it has moved to where it was not recorded.
+ *		Widgets of classes not declared by \ref ei_record_register, widgets with
+ *		children, and the ones drawing too many commands, are always drawn by their class.
+ *
+ * @param	widget		The widget.
+ * @param	surface		Where to draw the widget.
+ * @param	pick_surface	The picking offscreen.
+ * @param	clipper		The drawing is restricted within this rectangle.
+ */
+void ei_record_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+                    ei_rect_t* clipper)
+{
+        // The children of a widget are drawn by its class, and have their own records
+        if (!recording_enabled || ei_recording || widget->children_head != NULL ||
+            !is_recorded(widget->wclass)) {
+                if (widget->children_head != NULL) ei_record_discard(widget);
+                widget->wclass->drawfunc(widget, surface, pick_surface, clipper);
+                return;
+        }
+        ei_record_t *record = get_record(widget, EI_TRUE);
+        if (record->direct) {
+                widget->wclass->drawfunc(widget, surface, pick_surface, clipper);
+                return;
+        }
+
+        // Classes may draw outside of the outer rect of their widgets, e.g. the title of a
+        // toplevel, but their parent clips them within its content rect
+        ei_rect_t surface_area = surface_rect(surface);
+        ei_rect_t area = surface_area;
+        if (widget->parent != NULL && !clip_rect(widget->parent->content_rect, &surface_area, &area)) return;
+
+        // A widget that has only moved is replayed at its new location
+        ei_point_t delta = {widget->screen_location.top_left.x - record->location.top_left.x,
+                            widget->screen_location.top_left.y - record->location.top_left.y};
+        ei_rect_t moved_content = translate_rect(record->content, delta);
+        ei_rect_t moved_area = translate_rect(record->area, delta);
+        if (!record->valid || surface != record->surface || pick_surface != record->pick_surface ||
+            widget->screen_location.size.width != record->location.size.width ||
+            widget->screen_location.size.height != record->location.size.height ||
+            memcmp(&moved_content, widget->content_rect, sizeof(ei_rect_t)) != 0 ||
+            !contains_rect(&moved_area, &area)) {
+                record_widget(record, widget, surface, pick_surface, &area);
+                if (record->direct) {
+                        widget->wclass->drawfunc(widget, surface, pick_surface, clipper);
+                        return;
+                }
+                delta = ei_point_zero();
+        }
+        replay(record, surface, pick_surface, clipper, delta);
+}
+
+/**
+ * \brief	Forgets the record of a widget, because its appearance has changed: it is drawn
+ *		by its class the next time. Called by \ref ei_widget_invalidate and when a widget
+ *		is configured.
+ *
+ * @param	widget		The widget.
+ */
+void ei_record_discard(ei_widget_t* widget)
+{
+        ei_record_t *record = get_record(widget, EI_FALSE);
+        if (record == NULL) return;
+        // The buffers are kept for the next recording, and a widget that draws too much is
+        // not recorded again
+        clear_commands(record);
+}
+
+/**
+ * \brief	Releases the record of a widget that is destroyed.
+ *
+ * @param	widget		The widget.
+ */
+void ei_record_release(ei_widget_t* widget)
+{
+        ei_record_t *record = get_record(widget, EI_FALSE);
+        if (record == NULL) return;
+        free_record(record);
+        records[widget->pick_id] = NULL;
+}
+
+/**
+ * \brief	Turns the recording on or off. When it is off, the widgets are always drawn by
+ *		their class. It is on by default.
+ *
+ * @param	enabled		EI_TRUE to record the widgets.
+ */
+void ei_record_set_enabled(ei_bool_t enabled)
+{
+        recording_enabled = enabled;
+        if (!enabled) ei_record_free();
+}
+
+/**
+ * \brief	Releases all the records.
+ */
+void ei_record_free(void)
+{
+        for (uint32_t id = 0; id < record_capacity; id++) {
+                if (records[id] != NULL) free_record(records[id]);
+        }
+        free(records);
+        records = NULL;
+        record_capacity = 0;
+}
@@ -0,0 +1,464 @@
+#include <stdlib.h>
+#include "ei_rtree.h"
+#include "ei_stats.h"
+
+/**
+ * @brief	A data removed from an R-tree with its node, to insert again.
+ */
+typedef struct orphan_t {
+        ei_rtree_box_t box;
+        void* data;
+} orphan_t;
+
+static ei_rtree_box_t box_of(const ei_rect_t* rect)
+{
+        ei_rtree_box_t box = {rect->top_left.x, rect->top_left.y,
+                              rect->top_left.x + rect->size.width, rect->top_left.y + rect->size.height};
+        return box;
+}
+
+static ei_rect_t rect_of(const ei_rtree_box_t* box)
+{
+        ei_rect_t rect = {{box->x0, box->y0}, {box->x1 - box->x0, box->y1 - box->y0}};
+        return rect;
+}
+
+static ei_rtree_box_t box_union(const ei_rtree_box_t* first, const ei_rtree_box_t* second)
+{
+        ei_rtree_box_t box = {(first->x0 < second->x0) ? first->x0 : second->x0,
+                              (first->y0 < second->y0) ? first->y0 : second->y0,
+                              (first->x1 > second->x1) ? first->x1 : second->x1,
+                              (first->y1 > second->y1) ? first->y1 : second->y1};
+        return box;
+}
+
+static long box_area(const ei_rtree_box_t* box)
+{
+        return (long) (box->x1 - box->x0) * (box->y1 - box->y0);
+}
+
+static ei_bool_t box_intersects(const ei_rtree_box_t* first, const ei_rtree_box_t* second)
+{
+        return (first->x0 < second->x1 && second->x0 < first->x1 &&
+                first->y0 < second->y1 && second->y0 < first->y1) ? EI_TRUE : EI_FALSE;
+}
+
+static ei_bool_t box_contains(const ei_rtree_box_t* outer, const ei_rtree_box_t* inner)
+{
+        return (outer->x0 <= inner->x0 && outer->y0 <= inner->y0 &&
+                outer->x1 >= inner->x1 && outer->y1 >= inner->y1) ? EI_TRUE : EI_FALSE;
+}
+
+/**
+ * @brief	Returns the box of all the entries of a node.
+ *
+ * @param	node		The node, with at least one entry.
+ *
+ * @return			The box.
+ */
+static ei_rtree_box_t node_box(const ei_rtree_node_t* node)
+{
+        ei_rtree_box_t box = node->boxes[0];
+        for (int i = 1; i < node->count; i++) box = box_union(&box, &node->boxes[i]);
+        return box;
+}
+
+/**
+ * @brief	Adds an entry to a node, which can overflow by one entry.
+ *
+ * @param	node		The node.
+ * @param	box		The box of the entry.
+ * @param	entry		A data for a leaf, a child node otherwise.
+ */
+static void add_entry(ei_rtree_node_t* node, const ei_rtree_box_t* box, void* entry)
+{
+        node->boxes[node->count] = *box;
+        node->entries[node->count] = entry;
+        if (!node->leaf) ((ei_rtree_node_t*) entry)->parent = node;
+        node->count++;
+}
+
+/**
+ * @brief	Removes an entry from a node, replacing it with the last one.
+ *
+ * @param	node		The node.
+ * @param	index		The entry.
+ */
+static void remove_entry(ei_rtree_node_t* node, int index)
+{
+        node->count--;
+        node->boxes[index] = node->boxes[node->count];
+        node->entries[index] = node->entries[node->count];
+}
+
+static int index_of(const ei_rtree_node_t* parent, const ei_rtree_node_t* child)
+{
+        int index = 0;
+        while (parent->entries[index] != child) index++;
+        return index;
+}
+
+/**
+ * @brief	Finds the leaf where to insert a box: at each level, the child which box grows
+ *		the least, then the smallest one.
+ *
+ * @param	node		The root of the tree.
+ * @param	box		The box to insert.
+ *
+ * @return			The leaf.
+ */
+static ei_rtree_node_t* choose_leaf(ei_rtree_node_t* node, const ei_rtree_box_t* box)
+{
+        while (!node->leaf) {
+                int best = 0;
+                long best_growth = 0;
+                long best_area = 0;
+                for (int i = 0; i < node->count; i++) {
+                        ei_rtree_box_t grown = box_union(&node->boxes[i], box);
+                        long area = box_area(&node->boxes[i]);
+                        long growth = box_area(&grown) - area;
+                        if (i == 0 || growth < best_growth || (growth == best_growth && area < best_area)) {
+                                best = i;
+                                best_growth = growth;
+                                best_area = area;
+                        }
+                }
+                node = node->entries[best];
+        }
+        return node;
+}
+
+/**
+ * @brief	Splits a node which overflows in two, with the linear cost algorithm: the two
+ *		entries furthest apart start the two nodes, then every other entry goes where it
+ *		grows the box the least.
+ *
+ * @param	node		The node, keeping the first half of the entries.
+ *
+ * @return			A new node with the other half.
+ */
+static ei_rtree_node_t* split(ei_rtree_node_t* node)
+{
+        int count = node->count;
+        ei_rtree_box_t boxes[EI_RTREE_MAX_ENTRIES + 1];
+        void* entries[EI_RTREE_MAX_ENTRIES + 1];
+        for (int i = 0; i < count; i++) {
+                boxes[i] = node->boxes[i];
+                entries[i] = node->entries[i];
+        }
+
+        // The seeds: along the axis where they are the most apart, relatively to the whole box
+        ei_rtree_box_t all = node_box(node);
+        int first_seed = 0;
+        int second_seed = 1;
+        double best_separation = -1.0;
+        for (int axis = 0; axis < 2; axis++) {
+                int highest_low = 0;
+                int lowest_high = 0;
+                for (int i = 1; i < count; i++) {
+                        int low = axis ? boxes[i].y0 : boxes[i].x0;
+                        int high = axis ? boxes[i].y1 : boxes[i].x1;
+                        if (low > (axis ? boxes[highest_low].y0 : boxes[highest_low].x0)) highest_low = i;
+                        if (high < (axis ? boxes[lowest_high].y1 : boxes[lowest_high].x1)) lowest_high = i;
+                }
+                int width = axis ? all.y1 - all.y0 : all.x1 - all.x0;
+                int gap = axis ? boxes[highest_low].y0 - boxes[lowest_high].y1 :
+                                 boxes[highest_low].x0 - boxes[lowest_high].x1;
+                double separation = (double) gap / (double) ((width > 0) ? width : 1);
+                if (highest_low != lowest_high && separation > best_separation) {
+                        best_separation = separation;
+                        first_seed = lowest_high;
+                        second_seed = highest_low;
+                }
+        }
+
+        ei_rtree_node_t *sibling = ei_calloc(1, sizeof(ei_rtree_node_t));
+        sibling->leaf = node->leaf;
+        node->count = 0;
+        add_entry(node, &boxes[first_seed], entries[first_seed]);
+        add_entry(sibling, &boxes[second_seed], entries[second_seed]);
+        ei_rtree_box_t node_bounds = boxes[first_seed];
+        ei_rtree_box_t sibling_bounds = boxes[second_seed];
+
+        int left = count - 2;
+        for (int i = 0; i < count; i++) {
+                if (i == first_seed || i == second_seed) continue;
+                ei_bool_t to_node;
+                // Both nodes must keep the minimum number of entries
+                if (node->count + left == EI_RTREE_MIN_ENTRIES) {
+                        to_node = EI_TRUE;
+                } else if (sibling->count + left == EI_RTREE_MIN_ENTRIES) {
+                        to_node = EI_FALSE;
+                } else {
+                        ei_rtree_box_t node_grown = box_union(&node_bounds, &boxes[i]);
+                        ei_rtree_box_t sibling_grown = box_union(&sibling_bounds, &boxes[i]);
+                        long node_growth = box_area(&node_grown) - box_area(&node_bounds);
+                        long sibling_growth = box_area(&sibling_grown) - box_area(&sibling_bounds);
+                        if (node_growth != sibling_growth) {
+                                to_node = (node_growth < sibling_growth) ? EI_TRUE : EI_FALSE;
+                        } else {
+                                to_node = (node->count <= sibling->count) ? EI_TRUE : EI_FALSE;
+                        }
+                }
+                if (to_node) {
+                        add_entry(node, &boxes[i], entries[i]);
+                        node_bounds = box_union(&node_bounds, &boxes[i]);
+                } else {
+                        add_entry(sibling, &boxes[i], entries[i]);
+                        sibling_bounds = box_union(&sibling_bounds, &boxes[i]);
+                }
+                left--;
+        }
+        return sibling;
+}
+
+/**
+ * @brief	Updates the boxes from a node which has changed up to the root, splitting the
+ *		nodes which overflow on the way.
+ *
+ * @param	tree		The tree.
+ * @param	node		The node which has changed.
+ */
+static void adjust(ei_rtree_t* tree, ei_rtree_node_t* node)
+{
+        while (node != NULL) {
+                ei_rtree_node_t *sibling = (node->count > EI_RTREE_MAX_ENTRIES) ? split(node) : NULL;
+                ei_rtree_node_t *parent = node->parent;
+                if (parent == NULL) {
+                        // The tree grows by its root
+                        if (sibling != NULL) {
+                                ei_rtree_node_t *root = ei_calloc(1, sizeof(ei_rtree_node_t));
+                                ei_rtree_box_t node_bounds = node_box(node);
+                                ei_rtree_box_t sibling_bounds = node_box(sibling);
+                                add_entry(root, &node_bounds, node);
+                                add_entry(root, &sibling_bounds, sibling);
+                                tree->root = root;
+                        }
+                        return;
+                }
+                parent->boxes[index_of(parent, node)] = node_box(node);
+                if (sibling != NULL) {
+                        ei_rtree_box_t sibling_bounds = node_box(sibling);
+                        add_entry(parent, &sibling_bounds, sibling);
+                }
+                node = parent;
+        }
+}
+
+/**
+ * @brief	Stores a data in a leaf of an R-tree, without counting it.
+ *
+ * @param	tree		The tree.
+ * @param	box		The box of the data.
+ * @param	data		The data.
+ */
+static void insert_box(ei_rtree_t* tree, const ei_rtree_box_t* box, void* data)
+{
+        if (tree->root == NULL) {
+                tree->root = ei_calloc(1, sizeof(ei_rtree_node_t));
+                tree->root->leaf = EI_TRUE;
+        }
+        ei_rtree_node_t *leaf = choose_leaf(tree->root, box);
+        add_entry(leaf, box, data);
+        adjust(tree, leaf);
+}
+
+/**
+ * @brief	Releases a node and all its descendants.
+ *
+ * @param	node		The node.
+ * @param	orphans		If not NULL, where to store the data of the leaves, which must have
+ *				room for them.
+ * @param	orphan_count	The number of data in orphans, updated.
+ */
+static void free_node(ei_rtree_node_t* node, orphan_t* orphans, int* orphan_count)
+{
+        for (int i = 0; i < node->count; i++) {
+                if (!node->leaf) {
+                        free_node(node->entries[i], orphans, orphan_count);
+                } else if (orphans != NULL) {
+                        orphans[*orphan_count].box = node->boxes[i];
+                        orphans[*orphan_count].data = node->entries[i];
+                        (*orphan_count)++;
+                }
+        }
+        free(node);
+}
+
+/**
+ * @brief	Counts the data in a node and its descendants.
+ *
+ * @param	node		The node.
+ *
+ * @return			The number of data.
+ */
+static int count_data(const ei_rtree_node_t* node)
+{
+        if (node->leaf) return node->count;
+        int count = 0;
+        for (int i = 0; i < node->count; i++) count += count_data(node->entries[i]);
+        return count;
+}
+
+/**
+ * @brief	Finds the leaf where a data is stored.
+ *
+ * @param	node		The node where to look.
+ * @param	box		The box of the data.
+ * @param	data		The data.
+ * @param	index		Where to store the entry of the data in the leaf.
+ *
+ * @return			The leaf, or NULL if the data is not found.
+ */
+static ei_rtree_node_t* find_leaf(ei_rtree_node_t* node, const ei_rtree_box_t* box, void* data, int* index)
+{
+        for (int i = 0; i < node->count; i++) {
+                if (node->leaf) {
+                        if (node->entries[i] != data) continue;
+                        *index = i;
+                        return node;
+                }
+                if (!box_contains(&node->boxes[i], box)) continue;
+                ei_rtree_node_t *leaf = find_leaf(node->entries[i], box, data, index);
+                if (leaf != NULL) return leaf;
+        }
+        return NULL;
+}
+
+static void search_node(const ei_rtree_node_t* node, const ei_rtree_box_t* box, ei_rtree_visit_t visit,
+                        void* user_param, size_t* found)
+{
+        for (int i = 0; i < node->count; i++) {
+                if (!box_intersects(&node->boxes[i], box)) continue;
+                if (node->leaf) {
+                        ei_rect_t rect = rect_of(&node->boxes[i]);
+                        visit(node->entries[i], &rect, user_param);
+                        (*found)++;
+                } else {
+                        search_node(node->entries[i], box, visit, user_param, found);
+                }
+        }
+}
+
+/**
+ * \brief	Creates an empty R-tree.
+ *
+ * @return			The tree, to release with \ref ei_rtree_free.
+ */
+ei_rtree_t* ei_rtree_create(void)
+{
+        return ei_calloc(1, sizeof(ei_rtree_t));
+}
+
+/**
+ * \brief	Releases an R-tree. The data stored in it are not released.
+ *
+ * @param	tree		The tree.
+ */
+void ei_rtree_free(ei_rtree_t* tree)
+{
+        if (tree == NULL) return;
+        if (tree->root != NULL) free_node(tree->root, NULL, NULL);
+        free(tree);
+}
+
+/**
+ * \brief	Stores a data in an R-tree.
+ *
+ * @param	tree		The tree.
+ * @param	rect		The rectangle of the data. Empty rectangles are never found.
+ * @param	data		The data.
+ */
+void ei_rtree_insert(ei_rtree_t* tree, const ei_rect_t* rect, void* data)
+{
+        ei_rtree_box_t box = box_of(rect);
+        insert_box(tree, &box, data);
+        tree->count++;
+}
+
+/**
+ * \brief	Removes a data from an R-tree.
+ *
+ * @param	tree		The tree.
+ * @param	rect		The rectangle the data was inserted with.
+ * @param	data		The data.
+ *
+ * @return			EI_FALSE if the data was not found.
+ */
+ei_bool_t ei_rtree_remove(ei_rtree_t* tree, const ei_rect_t* rect, void* data)
+{
+        ei_rtree_box_t box = box_of(rect);
+        int index;
+        ei_rtree_node_t *leaf = (tree->root != NULL) ? find_leaf(tree->root, &box, data, &index) : NULL;
+        if (leaf == NULL) return EI_FALSE;
+        remove_entry(leaf, index);
+        tree->count--;
+
+        // The nodes left with too few entries are removed, and their data inserted again
+        orphan_t *orphans = NULL;
+        int orphan_count = 0;
+        ei_rtree_node_t *node = leaf;
+        while (node->parent != NULL) {
+                ei_rtree_node_t *parent = node->parent;
+                int node_index = index_of(parent, node);
+                if (node->count < EI_RTREE_MIN_ENTRIES) {
+                        remove_entry(parent, node_index);
+                        int capacity = orphan_count + count_data(node);
+                        orphan_t *grown = ei_malloc((size_t) (capacity > 0 ? capacity : 1) * sizeof(orphan_t));
+                        for (int i = 0; i < orphan_count; i++) grown[i] = orphans[i];
+                        free(orphans);
+                        orphans = grown;
+                        free_node(node, orphans, &orphan_count);
+                } else {
+                        parent->boxes[node_index] = node_box(node);
+                }
+                node = parent;
+        }
+
+        // A root with a single child is replaced with it
+        while (!tree->root->leaf && tree->root->count == 1) {
+                ei_rtree_node_t *root = tree->root;
+                tree->root = root->entries[0];
+                tree->root->parent = NULL;
+                free(root);
+        }
+        if (!tree->root->leaf && tree->root->count == 0) tree->root->leaf = EI_TRUE;
+        for (int i = 0; i < orphan_count; i++) insert_box(tree, &orphans[i].box, orphans[i].data);
+        free(orphans);
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Finds the data of an R-tree which rectangle intersects a rectangle. The data are
+ *		found in no particular order.
+ *
+ * @param	tree		The tree.
+ * @param	rect		The rectangle.
+ * @param	visit		The function called for each data found.
+ * @param	user_param	A parameter passed to visit.
+ *
+ * @return			The number of data found.
+ */
+size_t ei_rtree_search(const ei_rtree_t* tree, const ei_rect_t* rect, ei_rtree_visit_t visit, void* user_param)
+{
+        size_t found = 0;
+        if (tree->root == NULL) return found;
+        ei_rtree_box_t box = box_of(rect);
+        search_node(tree->root, &box, visit, user_param, &found);
+        return found;
+}
+
+/**
+ * \brief	Returns the rectangle that contains all the data of an R-tree.
+ *
+ * @param	tree		The tree.
+ *
+ * @return			The rectangle, empty if the tree is.
+ */
+ei_rect_t ei_rtree_get_bounds(const ei_rtree_t* tree)
+{
+        ei_rect_t bounds = {{0, 0}, {0, 0}};
+        if (tree->root == NULL || tree->root->count == 0) return bounds;
+        ei_rtree_box_t box = node_box(tree->root);
+        return rect_of(&box);
+}
@@ -0,0 +1,227 @@
+#include "ei_scrollframe.h"
+
+ei_widget_t* scrollframe_alloc(void)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) ei_calloc(1, sizeof(ei_scrollframe_t));
+        scrollframe->color = ei_calloc(1, sizeof(ei_color_t));
+        scrollframe->content_size = ei_calloc(1, sizeof(ei_size_t));
+        return (ei_widget_t*) scrollframe;
+}
+
+void scrollframe_release(ei_widget_t* widget)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+        free(scrollframe->color);
+        free(scrollframe->content_size);
+        free(scrollframe);
+}
+
+/**
+ * @brief	Clamps a scroll offset so that the viewport stays inside the content.
+ *
+ * @param	scroll		The offset.
+ * @param	content		The size of the content.
+ * @param	viewport	The size of the viewport.
+ *
+ * @return			The clamped offset.
+ */
+static int clamp_scroll(int scroll, int content, int viewport)
+{
+        if (scroll > content - viewport) scroll = content - viewport;
+        return (scroll > 0) ? scroll : 0;
+}
+
+/**
+ * @brief	Computes the content of a scrollframe from its viewport and its scroll offset.
+ *
+ * @param	scrollframe	The scrollframe.
+ */
+static void update_content(ei_scrollframe_t* scrollframe)
+{
+        ei_rect_t *viewport = &scrollframe->widget.screen_location;
+        ei_rect_t *content = &scrollframe->content_data;
+        content->size.width = (scrollframe->content_size->width > viewport->size.width) ?
+                              scrollframe->content_size->width : viewport->size.width;
+        content->size.height = (scrollframe->content_size->height > viewport->size.height) ?
+                               scrollframe->content_size->height : viewport->size.height;
+        scrollframe->scroll.x = clamp_scroll(scrollframe->scroll.x, content->size.width, viewport->size.width);
+        scrollframe->scroll.y = clamp_scroll(scrollframe->scroll.y, content->size.height, viewport->size.height);
+        content->top_left.x = viewport->top_left.x - scrollframe->scroll.x;
+        content->top_left.y = viewport->top_left.y - scrollframe->scroll.y;
+}
+
+void scrollframe_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
+                      ei_rect_t* clipper)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+        update_content(scrollframe);
+        ei_rect_t viewport_clipper = rectangle_intersect(clipper, &widget->screen_location);
+        if (viewport_clipper.size.width <= 0 || viewport_clipper.size.height <= 0) return;
+
+        // Children are placed in the content, but only the ones in the viewport are placed and drawn
+        ei_occlusion_t occlusion;
+        ei_occlusion_compute(&occlusion, widget, &viewport_clipper);
+        for (ei_linked_rect_t *bg_clipper = occlusion.uncovered; bg_clipper; bg_clipper = bg_clipper->next) {
+                ei_fill_with_pick(surface, scrollframe->color, pick_surface, widget->pick_color,
+                                  &bg_clipper->rect);
+        }
+        ei_occlusion_draw_children(&occlusion, surface, pick_surface);
+}
+
+void scrollframe_setdefaults(ei_widget_t* widget)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+        *scrollframe->color = ei_default_background_color;
+        scrollframe->content_size->width = 0;
+        scrollframe->content_size->height = 0;
+        widget->content_rect = &scrollframe->content_data;
+}
+
+void scrollframe_geomnotify(ei_widget_t* widget, ei_rect_t rect)
+{
+
+}
+
+ei_bool_t scrollframe_handle(ei_widget_t* widget, ei_event_t* event)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+
+        // The content is dragged with the mouse, where no child takes the events
+        if (event->type == ei_ev_mouse_buttondown) {
+                scrollframe->grab = event->param.mouse.where;
+                ei_event_set_active_widget(widget);
+                return EI_TRUE;
+        } else if (event->type == ei_ev_mouse_move && ei_event_get_active_widget() == widget) {
+                ei_point_t where = event->param.mouse.where;
+                ei_scrollframe_scroll_by(widget, scrollframe->grab.x - where.x, scrollframe->grab.y - where.y);
+                scrollframe->grab = where;
+                return EI_TRUE;
+        } else if (event->type == ei_ev_mouse_buttonup) {
+                ei_event_set_active_widget(NULL);
+                return EI_TRUE;
+        }
+        return EI_FALSE;
+}
+
+ei_bool_t scrollframe_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        *opaque = widget->screen_location;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Configures the attributes of widgets of the class "scrollframe".
+ *
+ *		Parameters obey the "default" protocol, see \ref ei_frame_configure.
+ *
+ * @param	widget		The widget to configure.
+ * @param	requested_size	The size requested for the viewport. Defaults to the size of the content.
+ * @param	color		The color of the background of the content. Defaults to
+ *				\ref ei_default_background_color.
+ * @param	content_size	The size of the content where the children are placed. It is never
+ *				smaller than the viewport. Defaults to 0x0.
+ */
+void ei_scrollframe_configure (ei_widget_t* widget,
+                               ei_size_t* requested_size,
+                               const ei_color_t* color,
+                               ei_size_t* content_size)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(scrollframe->color, color, sizeof(ei_color_t));
+        changed |= update_field(scrollframe->content_size, content_size, sizeof(ei_size_t));
+        if (requested_size != NULL) {
+                widget->requested_size = *requested_size;
+        } else if (content_size != NULL) {
+                widget->requested_size = *scrollframe->content_size;
+        }
+        ei_widget_configured(widget, changed, old_requested_size);
+}
+
+/**
+ * @brief	Moves a widget and its descendants on screen, as their geometry managers would
+ *		place them in a content that has moved, as long as they stay in view. A widget
+ *		out of view keeps its screen location, and so do its descendants: it is placed
+ *		again when it is drawn.
+ *
+ * @param	widget		The widget.
+ * @param	dx, dy		The offset.
+ * @param	viewport	Where the widget is visible.
+ */
+static void move_widget(ei_widget_t* widget, int dx, int dy, const ei_rect_t* viewport)
+{
+        ei_rect_t outer_rect = ei_widget_outer_rect(widget);
+        outer_rect.top_left.x += dx;
+        outer_rect.top_left.y += dy;
+        ei_rect_t visible_rect = rectangle_intersect(&outer_rect, (ei_rect_t*) viewport);
+        if (visible_rect.size.width <= 0 || visible_rect.size.height <= 0) return;
+
+        widget->screen_location.top_left.x += dx;
+        widget->screen_location.top_left.y += dy;
+        if (widget->content_rect != &widget->screen_location) {
+                widget->content_rect->top_left.x += dx;
+                widget->content_rect->top_left.y += dy;
+        }
+        for (ei_widget_t *child = widget->children_head; child != NULL; child = child->next_sibling)
+                move_widget(child, dx, dy, &visible_rect);
+}
+
+/**
+ * \brief	Scrolls a scrollframe so that a point of its content is at the top left of the
+ *		viewport. The point is clamped so that the viewport stays inside the content.
+ *
+ * @param	widget		The scrollframe.
+ * @param	x, y		The point of the content.
+ */
+void ei_scrollframe_scroll_to(ei_widget_t* widget, int x, int y)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+        ei_point_t old_scroll = scrollframe->scroll;
+        scrollframe->scroll.x = x;
+        scrollframe->scroll.y = y;
+        update_content(scrollframe);
+        int dx = scrollframe->scroll.x - old_scroll.x;
+        int dy = scrollframe->scroll.y - old_scroll.y;
+        if (dx == 0 && dy == 0) return;
+
+        // The children keep their place in the content, which moves the other way: only the
+        // ones in view must follow it now, as their pixels are moved instead of drawn again
+        for (ei_widget_t *child = widget->children_head; child != NULL; child = child->next_sibling)
+                move_widget(child, -dx, -dy, &widget->screen_location);
+
+        ei_widget_scroll_rect(widget, &widget->screen_location, -dx, -dy);
+}
+
+/**
+ * \brief	Scrolls a scrollframe by an offset, see \ref ei_scrollframe_scroll_to.
+ *
+ * @param	widget		The scrollframe.
+ * @param	dx, dy		The offset, positive to show the right and bottom of the content.
+ */
+void ei_scrollframe_scroll_by(ei_widget_t* widget, int dx, int dy)
+{
+        ei_scrollframe_t *scrollframe = (ei_scrollframe_t*) widget;
+        ei_scrollframe_scroll_to(widget, scrollframe->scroll.x + dx, scrollframe->scroll.y + dy);
+}
+
+/**
+ * \brief	Returns the point of the content of a scrollframe at the top left of its viewport.
+ *
+ * @param	widget		The scrollframe.
+ *
+ * @return			The point, relative to the top left of the content.
+ */
+ei_point_t ei_scrollframe_get_scroll(ei_widget_t* widget)
+{
+        return ((ei_scrollframe_t*) widget)->scroll;
+}
+
+ei_widgetclass_t scrollframeclass = {"scrollframe",
+                                     &scrollframe_alloc,
+                                     &scrollframe_release,
+                                     &scrollframe_draw,
+                                     &scrollframe_setdefaults,
+                                     &scrollframe_geomnotify,
+                                     &scrollframe_handle,
+                                     NULL};
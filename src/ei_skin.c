@@ -0,0 +1,402 @@
+#include <string.h>
+#include "ei_application.h"
+#include "ei_drawing_tools.h"
+#include "ei_picking.h"
+#include "ei_record.h"
+#include "ei_skin.h"
+
+#define SKIN_BUCKETS 512
+
+static ei_skin_t *buckets[SKIN_BUCKETS];        // The skins, by hash of their key
+static ei_skin_t *oldest = NULL;                // The least recently used skin
+static ei_skin_t *newest = NULL;                // The most recently used skin
+static int skin_count = 0;
+
+/**
+ * @brief	Hashes the description of a relief (FNV-1a over its bytes).
+ */
+static uint32_t hash_key(const ei_skin_key_t* key)
+{
+        const unsigned char *byte = (const unsigned char*) key;
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(ei_skin_key_t); i++) hash = (hash ^ byte[i]) * 16777619u;
+        return hash;
+}
+
+/**
+ * @brief	Removes a skin from the list of the skins by time of use.
+ */
+static void unlink_used(ei_skin_t* skin)
+{
+        if (skin->older != NULL) skin->older->newer = skin->newer;
+        else oldest = skin->newer;
+        if (skin->newer != NULL) skin->newer->older = skin->older;
+        else newest = skin->older;
+        skin->older = skin->newer = NULL;
+}
+
+/**
+ * @brief	Makes a skin the most recently used one.
+ */
+static void push_used(ei_skin_t* skin)
+{
+        skin->older = newest;
+        skin->newer = NULL;
+        if (newest != NULL) newest->newer = skin;
+        else oldest = skin;
+        newest = skin;
+}
+
+/**
+ * @brief	Removes a skin from the cache and releases it.
+ */
+static void release_skin(ei_skin_t* skin)
+{
+        ei_skin_t **link = &buckets[skin->hash % SKIN_BUCKETS];
+        while (*link != skin) link = &(*link)->next;
+        *link = skin->next;
+        unlink_used(skin);
+        skin_count--;
+        hw_surface_free(skin->bitmap);
+        free(skin);
+}
+
+/**
+ * @brief	Renders a button-like relief in a skin bitmap, with the same polygons as a button
+ *		of the size of the bitmap, then makes the outside of the shape transparent.
+ *
+ * @param	skin		The skin to render, its bitmap must be locked.
+ */
+static void render_rounded(ei_skin_t *skin)
+{
+        int side = skin->side;
+        ei_rect_t rectangle = {{0, 0}, {side, side}};
+        ei_color_t light_color = get_light_color_variation(&skin->key.color);
+        ei_color_t dark_color = get_dark_color_variation(&skin->key.color);
+
+        // The background gets a key color that differs from the light, dark and face colors
+        ei_color_t key_color = skin->key.color;
+        key_color.red ^= 0x80;
+        key_color.alpha = 0xff;
+        ei_fill(skin->bitmap, &key_color, NULL);
+
+        struct ei_linked_point_t *upper_part = rounded_frame(rectangle, skin->key.corner_radius, 'h');
+        struct ei_linked_point_t *lower_part = rounded_frame(rectangle, skin->key.corner_radius, 'l');
+        if (skin->key.relief == ei_relief_raised) {
+                ei_draw_polygon(skin->bitmap, upper_part, light_color, NULL);
+                ei_draw_polygon(skin->bitmap, lower_part, dark_color, NULL);
+        } else {
+                ei_draw_polygon(skin->bitmap, upper_part, dark_color, NULL);
+                ei_draw_polygon(skin->bitmap, lower_part, light_color, NULL);
+        }
+
+        rectangle.size.height -= 2 * skin->key.border_width;
+        rectangle.size.width -= 2 * skin->key.border_width;
+        rectangle.top_left.y += skin->key.border_width;
+        rectangle.top_left.x += skin->key.border_width;
+        struct ei_linked_point_t *main_part = rounded_frame(rectangle, skin->key.corner_radius, 't');
+        ei_draw_polygon(skin->bitmap, main_part, skin->key.color, NULL);
+
+        // Polygons are blended without alpha: rebuild the alpha channel from the key color
+        int ir, ig, ib, ia;
+        hw_surface_get_channel_indices(skin->bitmap, &ir, &ig, &ib, &ia);
+        uint32_t alpha_mask = (uint32_t) 0xff << (ia * 8);
+        uint32_t key = ei_map_rgba(skin->bitmap, key_color) & ~alpha_mask;
+        uint32_t *pixel_ptr = (uint32_t*) hw_surface_get_buffer(skin->bitmap);
+        for (int32_t i = 0; i < side * side; i++, pixel_ptr++) {
+                if ((*pixel_ptr & ~alpha_mask) == key) *pixel_ptr = 0;
+                else *pixel_ptr |= alpha_mask;
+        }
+}
+
+/**
+ * @brief	Renders a frame-like relief in a skin bitmap: light top and left bars, dark
+ *		bottom and right bars (the opposite for a sunken relief).
+ *
+ * @param	skin		The skin to render, its bitmap must be locked.
+ */
+static void render_bars(ei_skin_t *skin)
+{
+        int side = skin->side;
+        int border = skin->key.border_width;
+        ei_color_t light_color = get_light_color_variation(&skin->key.color);
+        ei_color_t dark_color = get_dark_color_variation(&skin->key.color);
+
+        ei_fill(skin->bitmap, &skin->key.color, NULL);
+        if (skin->key.relief != ei_relief_none) {
+                ei_color_t *top_color = (skin->key.relief == ei_relief_raised) ? &light_color : &dark_color;
+                ei_color_t *bot_color = (skin->key.relief == ei_relief_raised) ? &dark_color : &light_color;
+                ei_rect_t top_h_bar = {{0, 0}, {side, border}};
+                ei_rect_t top_v_bar = {{0, 0}, {border, side - border}};
+                ei_rect_t bot_h_bar = {{0, side - border}, {side - border, border}};
+                ei_rect_t bot_v_bar = {{side - border, border}, {border, side - border}};
+                ei_fill(skin->bitmap, top_color, &top_h_bar);
+                ei_fill(skin->bitmap, top_color, &top_v_bar);
+                ei_fill(skin->bitmap, bot_color, &bot_h_bar);
+                ei_fill(skin->bitmap, bot_color, &bot_v_bar);
+        }
+
+        // Frames are opaque whatever the alpha of their color
+        int ir, ig, ib, ia;
+        hw_surface_get_channel_indices(skin->bitmap, &ir, &ig, &ib, &ia);
+        uint32_t alpha_mask = (uint32_t) 0xff << (ia * 8);
+        uint32_t *pixel_ptr = (uint32_t*) hw_surface_get_buffer(skin->bitmap);
+        for (int32_t i = 0; i < side * side; i++, pixel_ptr++) *pixel_ptr |= alpha_mask;
+}
+
+/**
+ * @brief	Maps a coordinate of the stretched skin to a coordinate in the skin bitmap.
+ *
+ * @param	coord		The coordinate, relative to the top-left corner of the stretched skin.
+ * @param	length		The length of the stretched skin along this axis.
+ * @param	corner		The size of the corners of the skin.
+ * @param	side		The size of the skin bitmap.
+ *
+ * @return			The coordinate in the bitmap.
+ */
+static inline int slice_coordinate(int coord, int length, int corner, int side)
+{
+        if (coord < corner) return coord;
+        if (coord >= length - corner) return side - (length - coord);
+        return corner;
+}
+
+/**
+ * @brief	Walks the destination rows of a stretched skin and either blends the skin pixels,
+ *		or writes a single value where the skin is not transparent. The pick ID, if any,
+ *		is stored in the picking offscreen in the same pass.
+ *
+ * @param	surface		Where to draw, must be locked. If NULL, only the pick ID is stored.
+ * @param	skin		The skin to draw.
+ * @param	rect		Where to draw the skin.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ * @param	mask_pixel	If not NULL, the value to write in place of the skin pixels.
+ * @param	pick_id		If not NULL, the ID to store in the picking offscreen where the
+ *				skin is not transparent.
+ */
+static void draw_slices(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                        const ei_rect_t* clipper, const uint32_t* mask_pixel, const uint32_t* pick_id)
+{
+        ei_rect_t surface_rect = (surface != NULL) ? hw_surface_get_rect(surface) : ei_picking_get_rect();
+        ei_rect_t area = rectangle_intersect(&surface_rect, (ei_rect_t*) rect);
+        if (clipper) area = rectangle_intersect((ei_rect_t*) clipper, &area);
+        if (area.size.width <= 0 || area.size.height <= 0) return;
+
+        int corner = skin->corner;
+        int side = skin->side;
+        int ir, ig, ib, ia, dst_ir = 0, dst_ig = 0, dst_ib = 0, dst_ia = -1;
+        hw_surface_get_channel_indices(skin->bitmap, &ir, &ig, &ib, &ia);
+        if (surface != NULL) hw_surface_get_channel_indices(surface, &dst_ir, &dst_ig, &dst_ib, &dst_ia);
+        uint32_t alpha_mask = (uint32_t) 0xff << (ia * 8);
+        uint32_t keep_mask = (dst_ia == -1) ? ~alpha_mask : 0xffffffff;
+
+        int surf_width = surface_rect.size.width;
+        uint32_t *rst_dst_ptr = (surface != NULL) ? (uint32_t*) hw_surface_get_buffer(surface) : NULL;
+        uint32_t *rst_src_ptr = (uint32_t*) hw_surface_get_buffer(skin->bitmap);
+        int x_end = area.top_left.x + area.size.width;
+        int y_end = area.top_left.y + area.size.height;
+        int mid_end = rect->top_left.x + rect->size.width - corner;
+
+        for (int y = area.top_left.y; y < y_end; y++) {
+                int sy = slice_coordinate(y - rect->top_left.y, rect->size.height, corner, side);
+                uint32_t *src_row = rst_src_ptr + sy * side;
+                uint32_t *dst_row = (rst_dst_ptr != NULL) ? rst_dst_ptr + y * surf_width : NULL;
+                int x = area.top_left.x;
+                while (x < x_end) {
+                        int lx = x - rect->top_left.x;
+                        int sx = slice_coordinate(lx, rect->size.width, corner, side);
+                        uint32_t src_pixel = src_row[sx];
+                        uint32_t alpha = (src_pixel & alpha_mask) >> (ia * 8);
+                        // The middle column of the skin is repeated as one span
+                        int span_end = (sx == corner && lx >= corner) ?
+                                       ((mid_end < x_end) ? mid_end : x_end) : x + 1;
+                        if (alpha != 0 && pick_id != NULL) {
+                                ei_rect_t span = {{x, y}, {span_end - x, 1}};
+                                ei_picking_fill(&span, *pick_id);
+                        }
+                        if (alpha == 0 || dst_row == NULL) {
+                                x = span_end;
+                        } else if (mask_pixel != NULL) {
+                                for (; x < span_end; x++) dst_row[x] = *mask_pixel;
+                        } else if (alpha == 0xff) {
+                                uint32_t value = src_pixel & keep_mask;
+                                for (; x < span_end; x++) dst_row[x] = value;
+                        } else {
+                                for (; x < span_end; x++) {
+                                        uint32_t dst_pixel = dst_row[x];
+                                        uint32_t red = ((src_pixel >> (ir * 8) & 0xff) * alpha +
+                                                        (dst_pixel >> (dst_ir * 8) & 0xff) * (255 - alpha)) / 255;
+                                        uint32_t green = ((src_pixel >> (ig * 8) & 0xff) * alpha +
+                                                          (dst_pixel >> (dst_ig * 8) & 0xff) * (255 - alpha)) / 255;
+                                        uint32_t blue = ((src_pixel >> (ib * 8) & 0xff) * alpha +
+                                                         (dst_pixel >> (dst_ib * 8) & 0xff) * (255 - alpha)) / 255;
+                                        dst_row[x] = (red << (dst_ir * 8)) + (green << (dst_ig * 8)) +
+                                                     (blue << (dst_ib * 8));
+                                }
+                        }
+                }
+        }
+}
+
+/**
+ * \brief	Returns the skin matching a relief description, rendering it the first time
+ *		it is requested.
+ *
+ * @param	color		The face color.
+ * @param	border_width	The width of the relief border.
+ * @param	corner_radius	The radius of the rounded corners (ignored for frame-like reliefs).
+ * @param	relief		The kind of relief.
+ * @param	rounded		If true, the relief is drawn like a button: rounded corners and
+ *				light and dark parts split along the diagonal. If false, it is drawn
+ *				like a frame: light top and left bars, dark bottom and right bars.
+ *
+ * @return			The cached skin. It is owned by the cache and must not be freed. It
+ *				stays valid until the next call, which may release the least
+ *				recently used skins: it must not be kept.
+ */
+ei_skin_t* ei_skin_get(const ei_color_t* color, int border_width, int corner_radius,
+                       ei_relief_t relief, ei_bool_t rounded)
+{
+        ei_skin_key_t key;
+        memset(&key, 0, sizeof(key));   // The padding is compared too
+        key.color = *color;
+        key.border_width = border_width;
+        key.corner_radius = (rounded) ? corner_radius : 0;
+        key.relief = relief;
+        key.rounded = rounded;
+        uint32_t hash = hash_key(&key);
+
+        ei_skin_t *skin = buckets[hash % SKIN_BUCKETS];
+        while (skin != NULL && (skin->hash != hash || memcmp(&skin->key, &key, sizeof(key)) != 0)) skin = skin->next;
+        if (skin != NULL) {
+                unlink_used(skin);
+                push_used(skin);
+                return skin;
+        }
+
+        if (skin_count == EI_SKIN_CACHE_MAX) release_skin(oldest);
+        skin = ei_calloc(1, sizeof(ei_skin_t));
+        skin->key = key;
+        skin->hash = hash;
+        // The face of a button is inset by the border and has the same rounded corners
+        skin->corner = (rounded) ? border_width + key.corner_radius : border_width;
+        // An even side keeps the diagonal split of button reliefs at 45 degrees
+        skin->side = 2 * skin->corner + 2;
+        int side = skin->side;
+        skin->bitmap = hw_surface_create(ei_app_root_surface(), ei_size(side, side), EI_TRUE);
+        ei_stats.surfaces_created++;
+
+        hw_surface_lock(skin->bitmap);
+        if (rounded) render_rounded(skin);
+        else render_bars(skin);
+        hw_surface_unlock(skin->bitmap);
+
+        skin->next = buckets[hash % SKIN_BUCKETS];
+        buckets[hash % SKIN_BUCKETS] = skin;
+        push_used(skin);
+        skin_count++;
+        return skin;
+}
+
+/**
+ * \brief	Tells if a skin can be stretched to a rectangle, i.e. if the rectangle is at
+ *		least as big as the nine-slice bitmap.
+ *
+ * @param	skin		The skin.
+ * @param	rect		The rectangle where the skin would be drawn.
+ *
+ * @return			EI_TRUE if \ref ei_skin_draw can be used for this rectangle.
+ */
+ei_bool_t ei_skin_fits(const ei_skin_t* skin, const ei_rect_t* rect)
+{
+        int side = skin->side;
+        return (ei_bool_t) (rect->size.width >= side && rect->size.height >= side);
+}
+
+/**
+ * \brief	Draws a skin stretched to a rectangle: corner blits, edge and face span fills.
+ *
+ * @param	surface		Where to draw. The surface must be *locked* by \ref hw_surface_lock
+ *				and have the channel ordering of the root surface.
+ * @param	skin		The skin to draw.
+ * @param	rect		Where to draw the skin, must satisfy \ref ei_skin_fits.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_skin_draw(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                  const ei_rect_t* clipper)
+{
+        if (ei_record_capturing(surface)) {
+                ei_record_skin(surface, skin, rect, NULL, NULL, NULL, clipper);
+                return;
+        }
+        hw_surface_lock(skin->bitmap);
+        draw_slices(surface, skin, rect, clipper, NULL, NULL);
+        hw_surface_unlock(skin->bitmap);
+}
+
+/**
+ * \brief	Fills the shape of a skin with a single color, e.g. in the picking surface.
+ *
+ * @param	surface		Where to draw. The surface must be *locked* by \ref hw_surface_lock,
+ *				or be the picking offscreen.
+ * @param	skin		The skin which shape is used.
+ * @param	rect		Where to draw the shape, must satisfy \ref ei_skin_fits.
+ * @param	color		The color of the shape.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_skin_draw_mask(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                       const ei_color_t* color, const ei_rect_t* clipper)
+{
+        if (ei_record_capturing(surface)) {
+                ei_record_skin(surface, skin, rect, color, NULL, NULL, clipper);
+                return;
+        }
+        hw_surface_lock(skin->bitmap);
+        if (ei_picking_is_buffer(surface)) {
+                uint32_t id = color_to_id(*color);
+                draw_slices(NULL, skin, rect, clipper, NULL, &id);
+        } else {
+                uint32_t mask_pixel = ei_map_rgba(surface, *color);
+                draw_slices(surface, skin, rect, clipper, &mask_pixel, NULL);
+        }
+        hw_surface_unlock(skin->bitmap);
+}
+
+/**
+ * \brief	Draws a skin stretched to a rectangle like \ref ei_skin_draw, and fills its shape
+ *		in the picking offscreen like \ref ei_skin_draw_mask, in one pass over the rows.
+ *
+ * @param	surface		Where to draw. The surface must be *locked* by \ref hw_surface_lock
+ *				and have the channel ordering of the root surface.
+ * @param	skin		The skin to draw.
+ * @param	rect		Where to draw the skin, must satisfy \ref ei_skin_fits.
+ * @param	pick_surface	The picking offscreen, or NULL to only draw in surface.
+ * @param	pick_color	The pick color of the widget, which encodes its pick ID.
+ * @param	clipper		If not NULL, the drawing is restricted within this rectangle.
+ */
+void ei_skin_draw_with_pick(ei_surface_t surface, const ei_skin_t* skin, const ei_rect_t* rect,
+                            ei_surface_t pick_surface, const ei_color_t* pick_color,
+                            const ei_rect_t* clipper)
+{
+        if (ei_record_capturing(surface)) {
+                ei_record_skin(surface, skin, rect, NULL, pick_surface, pick_color, clipper);
+                return;
+        }
+        if (!ei_picking_is_buffer(pick_surface)) {
+                ei_skin_draw(surface, skin, rect, clipper);
+                if (pick_surface != NULL) ei_skin_draw_mask(pick_surface, skin, rect, pick_color, clipper);
+                return;
+        }
+        uint32_t id = color_to_id(*pick_color);
+        hw_surface_lock(skin->bitmap);
+        draw_slices(surface, skin, rect, clipper, NULL, &id);
+        hw_surface_unlock(skin->bitmap);
+}
+
+/**
+ * \brief	Releases all the skins of the cache.
+ */
+void ei_skin_cache_free(void)
+{
+        while (oldest != NULL) release_skin(oldest);
+}
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ei_stats.h"
+
+ei_stats_t ei_stats;
+
+static ei_stats_t last_frame;
+static ei_stats_t total;        // Counters of the frames before the current one
+
+/**
+ * @brief	Adds counters to other counters.
+ *
+ * @param	sum		The counters to add to.
+ * @param	stats		The counters to add.
+ */
+static void add_stats(ei_stats_t* sum, const ei_stats_t* stats)
+{
+        sum->pixels_filled += stats->pixels_filled;
+        sum->pixels_copied += stats->pixels_copied;
+        sum->pixels_blended += stats->pixels_blended;
+        sum->polygons += stats->polygons;
+        sum->polygon_edges += stats->polygon_edges;
+        sum->polyline_pixels += stats->polyline_pixels;
+        sum->text_surfaces += stats->text_surfaces;
+        sum->surfaces_created += stats->surfaces_created;
+        sum->mallocs += stats->mallocs;
+        sum->widgets_recorded += stats->widgets_recorded;
+        sum->commands_replayed += stats->commands_replayed;
+}
+
+/**
+ * \brief	Returns the counters of the last frame: the work done since the frame before it
+ *		was drawn, including the events handled in-between.
+ *
+ * @param	stats		Where to store the counters.
+ */
+void ei_stats_get_frame(ei_stats_t* stats)
+{
+        *stats = last_frame;
+}
+
+/**
+ * \brief	Returns the counters since the last call to \ref ei_stats_reset, or since the
+ *		start of the program.
+ *
+ * @param	stats		Where to store the counters.
+ */
+void ei_stats_get_total(ei_stats_t* stats)
+{
+        *stats = total;
+        add_stats(stats, &ei_stats);
+}
+
+/**
+ * \brief	Sets all the counters to 0, both the total and the ones of the last frame.
+ */
+void ei_stats_reset(void)
+{
+        memset(&ei_stats, 0, sizeof(ei_stats_t));
+        memset(&last_frame, 0, sizeof(ei_stats_t));
+        memset(&total, 0, sizeof(ei_stats_t));
+}
+
+/**
+ * \brief	Ends the counting of a frame. Called by the main loop after each frame is drawn.
+ */
+void ei_stats_frame_done(void)
+{
+        last_frame = ei_stats;
+        add_stats(&total, &ei_stats);
+        memset(&ei_stats, 0, sizeof(ei_stats_t));
+}
+
+/**
+ * \brief	Allocates memory like malloc, and counts the allocation. Used by the library
+ *		instead of malloc.
+ *
+ * @param	size		The number of bytes to allocate.
+ *
+ * @return			The memory, to release with free.
+ */
+void* ei_malloc(size_t size)
+{
+        ei_stats.mallocs++;
+        return malloc(size);
+}
+
+/**
+ * \brief	Allocates memory set to 0 like calloc, and counts the allocation. Used by the
+ *		library instead of calloc.
+ *
+ * @param	count		The number of elements.
+ * @param	size		The size of an element.
+ *
+ * @return			The memory, to release with free.
+ */
+void* ei_calloc(size_t count, size_t size)
+{
+        ei_stats.mallocs++;
+        return calloc(count, size);
+}
@@ -1,3 +1,5 @@
+#include <stdlib.h>
+#include <string.h>
 #include "ei_tools.h"
 
 /**
@@ -35,23 +37,11 @@ unsigned char max(unsigned char element_1, unsigned char element_2)
  */
 ei_color_t* id_to_color(uint32_t pick_id)
 {
-        ei_color_t *color = calloc(1, sizeof(ei_color_t));
-        color->red = 0;
-        color->green = 0;
-        color->blue = 0;
-        color->alpha = -1;
-
-        while (pick_id >= 65536) {
-                pick_id -= 65536;
-                color->red++;
-        }
-
-        while (pick_id >= 256) {
-                pick_id -= 256;
-                color->green++;
-        }
-
-        color->blue = pick_id;
+        ei_color_t *color = ei_calloc(1, sizeof(ei_color_t));
+        color->red = (pick_id >> 16) & 0xff;
+        color->green = (pick_id >> 8) & 0xff;
+        color->blue = pick_id & 0xff;
+        color->alpha = 0xff;
         return color;
 }
 
@@ -101,4 +91,45 @@ void free_linked_points(ei_linked_point_t* point)
                 free(point);
                 point = tmp;
         }
-}
\ No newline at end of file
+}
+
+/**
+ * \brief	Copies a value into a field of a widget, only if it is given and different.
+ *
+ * @param	field    	The field to update.
+ * @param	value    	The new value, or NULL to keep the current one.
+ * @param	size     	The size of the field, in bytes.
+ *
+ * @return	        	EI_TRUE if the field has changed.
+ */
+ei_bool_t update_field(void* field, const void* value, size_t size)
+{
+        if (value == NULL || memcmp(field, value, size) == 0) return EI_FALSE;
+        memcpy(field, value, size);
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Replaces the text of a widget by a copy of a new text, only if it is given and
+ *		different.
+ *
+ * @param	field    	The text of the widget, allocated with malloc, or NULL.
+ * @param	text     	A pointer to the new text (which can be NULL), or NULL to keep the
+ *				current one.
+ *
+ * @return	        	EI_TRUE if the text has changed.
+ */
+ei_bool_t update_text(char** field, char** text)
+{
+        if (text == NULL) return EI_FALSE;
+        if (*field == NULL && *text == NULL) return EI_FALSE;
+        if (*field != NULL && *text != NULL && strcmp(*field, *text) == 0) return EI_FALSE;
+        free(*field);
+        if (*text != NULL) {
+                *field = ei_calloc(strlen(*text) + 1, sizeof(char));
+                strcpy(*field, *text);
+        } else {
+                *field = NULL;
+        }
+        return EI_TRUE;
+}
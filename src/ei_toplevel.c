@@ -9,13 +9,13 @@ static char default_toplevel_title[9] = "Toplevel";
 
 ei_widget_t* toplevel_alloc (void)
 {
-        ei_toplevel_t *toplevel = (ei_toplevel_t*) calloc(1, sizeof(ei_toplevel_t));
-        toplevel->color = calloc(1, sizeof(ei_color_t));
-        toplevel->title = calloc(1, sizeof(char*));
-        toplevel->border_width = calloc(1, sizeof(int));
-        toplevel->closable = calloc(1,sizeof(ei_bool_t));
-        toplevel->resizable = calloc(1, sizeof(ei_axis_set_t));
-        toplevel->min_size = calloc(1, sizeof(ei_size_t*));
+        ei_toplevel_t *toplevel = (ei_toplevel_t*) ei_calloc(1, sizeof(ei_toplevel_t));
+        toplevel->color = ei_calloc(1, sizeof(ei_color_t));
+        toplevel->title = ei_calloc(1, sizeof(char*));
+        toplevel->border_width = ei_calloc(1, sizeof(int));
+        toplevel->closable = ei_calloc(1,sizeof(ei_bool_t));
+        toplevel->resizable = ei_calloc(1, sizeof(ei_axis_set_t));
+        toplevel->min_size = ei_calloc(1, sizeof(ei_size_t*));
         return (ei_widget_t*) toplevel;
 }
 
@@ -29,20 +29,64 @@ void toplevel_release (ei_widget_t* widget)
         free(toplevel->closable);
         free(toplevel->resizable);
         free(toplevel->min_size);
-        free(toplevel->widget.content_rect);
         free(toplevel);
 }
 
 void draw_content(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
                   ei_rect_t* clipper)
 {
+        ei_toplevel_t *toplevel = (ei_toplevel_t*) widget;
         ei_rect_t new_clipper = rectangle_intersect(clipper, widget->content_rect);
-        ei_widget_t* widget_child = widget->children_head;
-        while (widget_child) {
-                ei_placer_run(widget_child);
-                widget_child->wclass->drawfunc(widget_child, surface, pick_surface, &new_clipper);
-                widget_child = widget_child->next_sibling;
+        ei_occlusion_t occlusion;
+        ei_occlusion_compute(&occlusion, widget, &new_clipper);
+
+        // The background is only visible where no opaque child covers it
+        for (ei_linked_rect_t *bg_clipper = occlusion.uncovered; bg_clipper; bg_clipper = bg_clipper->next) {
+                ei_fill_with_pick(surface, toplevel->color, pick_surface, toplevel->widget.pick_color,
+                                  &bg_clipper->rect);
         }
+        ei_occlusion_draw_children(&occlusion, surface, pick_surface);
+}
+
+ei_bool_t toplevel_opaque(ei_widget_t* widget, ei_rect_t* opaque)
+{
+        ei_toplevel_t *toplevel = (ei_toplevel_t*) widget;
+        int text_width = 0;
+        int text_height = 0;
+        hw_text_compute_size(*toplevel->title, ei_default_font, &text_width, &text_height);
+
+        // Everything below the rounded part of the title bar is filled
+        opaque->top_left.x = widget->screen_location.top_left.x;
+        opaque->top_left.y = widget->screen_location.top_left.y + text_height;
+        opaque->size.width = widget->screen_location.size.width + 2 * *toplevel->border_width;
+        opaque->size.height = widget->screen_location.size.height + 2 * *toplevel->border_width;
+        return EI_TRUE;
+}
+
+/**
+ * \brief	Returns the resize icon of a toplevel, drawn over the bottom right corner of
+ *		its content.
+ *
+ * @param	widget		The toplevel.
+ * @param	rect		Where to store the rectangle of the icon.
+ *
+ * @return			EI_FALSE if the toplevel is not resizable, and has no icon.
+ */
+ei_bool_t ei_toplevel_resize_rect(ei_widget_t* widget, ei_rect_t* rect)
+{
+        ei_toplevel_t *toplevel = (ei_toplevel_t*) widget;
+        if (!*toplevel->resizable) return EI_FALSE;
+        int text_width = 0;
+        int text_height = 0;
+        hw_text_compute_size(*toplevel->title, ei_default_font, &text_width, &text_height);
+        int min_icon_size = (10 < *toplevel->border_width) ? *toplevel->border_width : 10;
+        rect->top_left.x = widget->screen_location.top_left.x + 2 * *toplevel->border_width +
+                           widget->screen_location.size.width - min_icon_size;
+        rect->top_left.y = widget->screen_location.top_left.y + text_height +
+                           widget->screen_location.size.height + 2 * *toplevel->border_width - min_icon_size;
+        rect->size.width = min_icon_size;
+        rect->size.height = min_icon_size;
+        return EI_TRUE;
 }
 
 void toplevel_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_surface,
@@ -50,7 +94,6 @@ void toplevel_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_
 {
         ei_toplevel_t *toplevel = (ei_toplevel_t*) widget;
         int *border_width = toplevel->border_width;
-        const ei_color_t *color = toplevel->color;
         int text_width = 0;
         int text_height = 0;
 
@@ -72,8 +115,6 @@ void toplevel_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_
         ei_draw_polygon(surface, lower_bar, dark_color, clipper);
         ei_rect_t bar_clipper = rectangle_intersect(clipper, &bar);
         ei_fill(pick_surface, toplevel->widget.pick_color, &bar_clipper);
-        free_linked_points(upper_bar);
-        free_linked_points(lower_bar);
 
         // Frame
         ei_rect_t frame = {{toplevel->widget.screen_location.top_left.x, toplevel->widget.screen_location
@@ -81,38 +122,24 @@ void toplevel_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_
                            .size.width + (2* *toplevel->border_width), +2* *
                            toplevel->border_width + toplevel->widget.screen_location.size.height}};
         ei_rect_t frame_clipper = rectangle_intersect(clipper, &frame);
-        ei_fill(surface, &light_color, &frame_clipper);
-        ei_fill(pick_surface, toplevel->widget.pick_color, &frame_clipper);
+        ei_fill_with_pick(surface, &light_color, pick_surface, toplevel->widget.pick_color, &frame_clipper);
 
 
         // Content background
-        ei_rect_t* content_rect = malloc(sizeof(ei_rect_t));
+        ei_rect_t* content_rect = &toplevel->content_data;
         content_rect->top_left.x = toplevel->widget.screen_location.top_left.x + *toplevel->border_width;
         content_rect->top_left.y = toplevel->widget.screen_location.top_left.y + text_height +
         *toplevel->border_width;
         content_rect->size = toplevel->widget.screen_location.size;
-        if (toplevel->widget.content_rect != &toplevel->widget.screen_location) free(toplevel->widget.content_rect);
         toplevel->widget.content_rect = content_rect;
-        ei_rect_t bg_clipper = rectangle_intersect(clipper,widget->content_rect);
-        ei_fill(surface,color, &bg_clipper);
-        ei_fill(pick_surface, toplevel->widget.pick_color, &bg_clipper);
         draw_content(widget, surface, pick_surface, clipper);
 
         // Resize icon
-        if (*toplevel->resizable) {
-
-                int min_icon_size = (10 < *toplevel->border_width) ? *toplevel->border_width : 10;
-                ei_rect_t res_icon = {{toplevel->widget.screen_location.top_left.x +
-                                      2* *toplevel->border_width +
-                                      toplevel->widget.screen_location.size.width - min_icon_size,
-                                      toplevel->widget.screen_location.top_left.y +
-                                      text_height+toplevel->widget.screen_location.size.height +
-                                      2* *toplevel->border_width-min_icon_size},
-                                      {min_icon_size, min_icon_size}};
-
+        ei_rect_t res_icon;
+        if (ei_toplevel_resize_rect(widget, &res_icon)) {
                 ei_rect_t res_icon_clipper = rectangle_intersect(clipper, &res_icon);
-                ei_fill(surface, &dark_color, &res_icon_clipper);
-                ei_fill(pick_surface, toplevel->widget.pick_color, &res_icon_clipper);
+                ei_fill_with_pick(surface, &dark_color, pick_surface, toplevel->widget.pick_color,
+                                  &res_icon_clipper);
         }
         // closing icon
         int offset = 4;
@@ -141,9 +168,6 @@ void toplevel_draw(ei_widget_t* widget, ei_surface_t surface, ei_surface_t pick_
 
                 struct ei_linked_point_t *main_part = rounded_frame(empty_rect, corner_radius, 't');
                 ei_draw_polygon(surface, main_part, red, clipper);
-                free_linked_points(upper_part);
-                free_linked_points(lower_part);
-                free_linked_points(main_part);
         }
 
         // title
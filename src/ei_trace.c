@@ -0,0 +1,153 @@
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "ei_trace.h"
+#include "hw_interface.h"
+
+#define TRACE_CAPACITY (1 << 16)
+
+typedef struct ei_trace_event_t {
+        const char* name;
+        double time;                    ///< In seconds, from \ref hw_now.
+        char phase;
+} ei_trace_event_t;
+
+ei_bool_t ei_trace_enabled = EI_FALSE;
+
+static ei_trace_event_t ring[TRACE_CAPACITY];
+static atomic_ulong recorded = 0;       // Events recorded since the start, the ring keeps the last ones
+static const char *exit_path = NULL;
+static const char *signal_path = NULL;
+static volatile sig_atomic_t signal_received = 0;
+
+/**
+ * \brief	Records the beginning or the end of a span in the trace ring buffer. Use
+ *		\ref ei_trace_begin and \ref ei_trace_end instead.
+ *
+ * @param	name		The name of the span. Must stay valid until the trace is exported.
+ * @param	phase		'B' for the beginning of the span, 'E' for its end.
+ */
+void ei_trace_record(const char* name, char phase)
+{
+        unsigned long index = atomic_fetch_add_explicit(&recorded, 1, memory_order_relaxed);
+        ei_trace_event_t *event = &ring[index % TRACE_CAPACITY];
+        event->name = name;
+        event->time = hw_now();
+        event->phase = phase;
+}
+
+/**
+ * \brief	Starts or stops the recording of spans. The recording is off by default.
+ *
+ * @param	enabled		EI_TRUE to record the spans.
+ */
+void ei_trace_set_enabled(ei_bool_t enabled)
+{
+        ei_trace_enabled = enabled;
+}
+
+/**
+ * @brief	Writes a string as a JSON string.
+ *
+ * @param	file		Where to write.
+ * @param	string		The string.
+ */
+static void write_json_string(FILE* file, const char* string)
+{
+        fputc('"', file);
+        for (; *string != '\0'; string++) {
+                if (*string == '"' || *string == '\\') fputc('\\', file);
+                if ((unsigned char) *string >= 0x20) fputc(*string, file);
+        }
+        fputc('"', file);
+}
+
+/**
+ * \brief	Writes the recorded spans as a Chrome trace (JSON "traceEvents" format), which can
+ *		be opened in chrome://tracing or in Perfetto. Only the most recent spans are kept
+ *		in the ring buffer.
+ *
+ * @param	path		The file to write.
+ *
+ * @return			EI_FALSE if the file could not be written.
+ */
+ei_bool_t ei_trace_export(const char* path)
+{
+        FILE *file = fopen(path, "w");
+        if (file == NULL) return EI_FALSE;
+
+        unsigned long end = atomic_load(&recorded);
+        unsigned long start = (end > TRACE_CAPACITY) ? end - TRACE_CAPACITY : 0;
+        int depth = 0;
+        ei_bool_t first = EI_TRUE;
+
+        fputs("{\"traceEvents\":[\n", file);
+        for (unsigned long i = start; i < end; i++) {
+                ei_trace_event_t *event = &ring[i % TRACE_CAPACITY];
+                // The ring may have overwritten the beginning of the oldest spans
+                if (event->phase == 'E' && depth == 0) continue;
+                depth += (event->phase == 'B') ? 1 : -1;
+                if (!first) fputs(",\n", file);
+                first = EI_FALSE;
+                fputs("{\"name\":", file);
+                write_json_string(file, event->name);
+                fprintf(file, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":1}", event->phase,
+                        event->time * 1000000.0);
+        }
+        fputs("\n]}\n", file);
+        return (fclose(file) == 0) ? EI_TRUE : EI_FALSE;
+}
+
+/**
+ * @brief	Exports the trace to the path given to \ref ei_trace_export_at_exit.
+ */
+static void export_at_exit(void)
+{
+        ei_trace_export(exit_path);
+}
+
+/**
+ * \brief	Exports the trace when the program exits.
+ *
+ * @param	path		The file to write. Must stay valid until the program exits.
+ */
+void ei_trace_export_at_exit(const char* path)
+{
+        if (exit_path == NULL) atexit(&export_at_exit);
+        exit_path = path;
+}
+
+/**
+ * @brief	Remembers that a signal asked for the trace: files can not be written safely
+ *		from a signal handler.
+ *
+ * @param	signum		The signal.
+ */
+static void signal_handler(int signum)
+{
+        signal_received = 1;
+}
+
+/**
+ * \brief	Exports the trace each time a signal is received (for example SIGUSR1). The file
+ *		is written by the main loop, in the iteration that follows the signal.
+ *
+ * @param	signum		The signal.
+ * @param	path		The file to write. Must stay valid until the program exits.
+ */
+void ei_trace_export_on_signal(int signum, const char* path)
+{
+        signal_path = path;
+        signal(signum, &signal_handler);
+}
+
+/**
+ * \brief	Writes the trace if a signal asked for it. Called by \ref ei_app_step.
+ */
+void ei_trace_poll(void)
+{
+        if (!signal_received) return;
+        signal_received = 0;
+        ei_trace_export(signal_path);
+}
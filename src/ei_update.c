@@ -0,0 +1,173 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "ei_arena.h"
+#include "ei_update.h"
+#include "hw_interface.h"
+
+typedef struct ei_update_t {
+        ei_widget_t* widget;
+        const void* key;
+        ei_update_func_t func;
+        void* user_param;
+        ei_bool_t superseded;
+        struct ei_update_t* next;
+} ei_update_t;
+
+// Lock-free stack: the threads push, the main loop takes the whole stack at once
+static _Atomic(ei_update_t*) posted = NULL;
+static atomic_bool wakeup_posted = false;
+static char wakeup_marker;                      // Parameter of the event that wakes up the main loop
+
+/**
+ * \brief	Posts an update of the user interface from any thread. The only function of the
+ *		library that can be called from another thread than the one of the main loop.
+ *
+ *		The main loop applies all the posted updates at once in each iteration, before
+ *		drawing. Among the updates of the same widget with the same key posted in the
+ *		meantime, only the last one is applied: the others are called as superseded.
+ *		The widget must not be destroyed while an update of it is pending.
+ *
+ * @param	widget		The widget to update, or NULL.
+ * @param	key		Identifies the property updated, for example the address of the
+ *				configure function, or NULL if the update must never be skipped.
+ * @param	func		The function that applies the update.
+ * @param	user_param	A programmer supplied parameter that will be passed to func.
+ */
+void ei_app_post_update(ei_widget_t* widget, const void* key, ei_update_func_t func, void* user_param)
+{
+        // Posted from any thread: not counted by ei_malloc, whose counters are not atomic
+        ei_update_t *update = malloc(sizeof(ei_update_t));
+        update->widget = widget;
+        update->key = key;
+        update->func = func;
+        update->user_param = user_param;
+        update->superseded = EI_FALSE;
+        update->next = atomic_load_explicit(&posted, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&posted, &update->next, update,
+                                                      memory_order_release, memory_order_relaxed));
+        // Only the first update since the last run wakes up the main loop
+        if (!atomic_exchange(&wakeup_posted, true)) hw_event_post_app(&wakeup_marker);
+}
+
+/**
+ * @brief	Marks the updates that are followed by a newer update of the same property.
+ *
+ * @param	newest		The updates, from the newest to the oldest.
+ * @param	count		The number of updates.
+ */
+static void mark_superseded(ei_update_t* newest, size_t count)
+{
+        // Open addressing set of the (widget, key) pairs already seen, in the frame arena
+        size_t size = 16;
+        while (size < 2 * count) size *= 2;
+        ei_update_t **seen = ei_arena_alloc(size * sizeof(ei_update_t*));
+
+        for (ei_update_t *update = newest; update != NULL; update = update->next) {
+                if (update->key == NULL) continue;
+                uintptr_t hash = ((uintptr_t) update->widget * 31 + (uintptr_t) update->key) * 2654435761u;
+                size_t i = (hash >> 4) & (size - 1);
+                while (seen[i] != NULL && (seen[i]->widget != update->widget || seen[i]->key != update->key))
+                        i = (i + 1) & (size - 1);
+                if (seen[i] != NULL) update->superseded = EI_TRUE;
+                else seen[i] = update;
+        }
+}
+
+/**
+ * @brief	Takes all the posted updates.
+ *
+ * @param	count		Where to store the number of updates.
+ *
+ * @return			The updates, from the newest to the oldest.
+ */
+static ei_update_t* take_updates(size_t* count)
+{
+        // Cleared first, so that an update posted from now on wakes up the main loop again
+        atomic_store(&wakeup_posted, false);
+        ei_update_t *newest = atomic_exchange_explicit(&posted, NULL, memory_order_acquire);
+        *count = 0;
+        for (ei_update_t *update = newest; update != NULL; update = update->next) (*count)++;
+        return newest;
+}
+
+/**
+ * @brief	Reverses a list of updates.
+ *
+ * @param	updates		The updates.
+ *
+ * @return			The same updates, in the reverse order.
+ */
+static ei_update_t* reverse_updates(ei_update_t* updates)
+{
+        ei_update_t *reversed = NULL;
+        while (updates != NULL) {
+                ei_update_t *next = updates->next;
+                updates->next = reversed;
+                reversed = updates;
+                updates = next;
+        }
+        return reversed;
+}
+
+/**
+ * \brief	Applies all the updates posted by \ref ei_app_post_update, in the order they were
+ *		posted, except the superseded ones. Called by \ref ei_app_step before drawing.
+ */
+void ei_update_run(void)
+{
+        size_t count;
+        ei_update_t *updates = take_updates(&count);
+        if (updates == NULL) return;
+
+        ei_arena_mark_t mark = ei_arena_get_mark();
+        mark_superseded(updates, count);
+        ei_arena_rewind(mark);
+
+        updates = reverse_updates(updates);
+        while (updates != NULL) {
+                ei_update_t *next = updates->next;
+                updates->func(updates->widget, updates->user_param, updates->superseded);
+                free(updates);
+                updates = next;
+        }
+}
+
+/**
+ * \brief	Tells if some updates are waiting to be applied.
+ *
+ * @return			EI_TRUE if at least one update is queued.
+ */
+ei_bool_t ei_update_pending(void)
+{
+        return (atomic_load(&posted) != NULL) ? EI_TRUE : EI_FALSE;
+}
+
+/**
+ * \brief	Tells if an event is the one posted to wake up the main loop when updates are
+ *		posted. It must not be given to the widgets.
+ *
+ * @param	event		The event.
+ *
+ * @return			EI_TRUE if the event wakes up the main loop for the updates.
+ */
+ei_bool_t ei_update_is_wakeup(ei_event_t* event)
+{
+        return (event->type == ei_ev_app && event->param.application.user_param == &wakeup_marker);
+}
+
+/**
+ * \brief	Releases the pending updates: they are all called as superseded.
+ */
+void ei_update_free(void)
+{
+        size_t count;
+        ei_update_t *updates = reverse_updates(take_updates(&count));
+        while (updates != NULL) {
+                ei_update_t *next = updates->next;
+                updates->func(updates->widget, updates->user_param, EI_TRUE);
+                free(updates);
+                updates = next;
+        }
+}
@@ -1,12 +1,100 @@
 #include "ei_application.h"
 #include "ei_button.h"
 #include "ei_frame.h"
+#include "ei_gridder.h"
 #include "ei_picking.h"
+#include "ei_record.h"
 #include "ei_tools.h"
 #include "ei_toplevel.h"
 #include "ei_widget.h"
 
-static uint32_t pick_id = 0;
+static unsigned long configure_count = 0;       // Calls to the configure functions
+static unsigned long elided_count = 0;          // Calls that changed nothing
+// The previous sibling of each widget, by pick ID: the layout of ei_widget_t is shared with
+// widget classes built outside of the library, so it can not get a field for it. The IDs of
+// destroyed widgets are given to new ones, so its size follows the number of live widgets.
+static ei_widget_t **prev_siblings = NULL;
+static uint32_t prev_siblings_size = 0;
+
+/**
+ * @brief	Returns the previous sibling of a widget.
+ *
+ * @param	widget		The widget.
+ *
+ * @return			The widget before it in the children of its parent, or NULL.
+ */
+static inline ei_widget_t* prev_sibling(const ei_widget_t* widget)
+{
+        return (widget->pick_id < prev_siblings_size) ? prev_siblings[widget->pick_id] : NULL;
+}
+
+/**
+ * @brief	Sets the previous sibling of a widget, growing the table of previous siblings
+ *		if the pick ID of the widget does not fit.
+ *
+ * @param	widget		The widget.
+ * @param	prev		Its previous sibling, or NULL.
+ */
+static void set_prev_sibling(ei_widget_t* widget, ei_widget_t* prev)
+{
+        if (widget->pick_id >= prev_siblings_size) {
+                uint32_t size = (prev_siblings_size > 0) ? prev_siblings_size : 64;
+                while (size <= widget->pick_id) size *= 2;
+                ei_widget_t **grown = ei_calloc(size, sizeof(ei_widget_t*));
+                if (prev_siblings != NULL) memcpy(grown, prev_siblings, prev_siblings_size * sizeof(ei_widget_t*));
+                free(prev_siblings);
+                prev_siblings = grown;
+                prev_siblings_size = size;
+        }
+        prev_siblings[widget->pick_id] = prev;
+}
+
+/**
+ * @brief	Adds a widget after the last child of a widget.
+ *
+ * @param	parent		The parent.
+ * @param	widget		The widget, which is not a child yet.
+ */
+static void append_child(ei_widget_t* parent, ei_widget_t* widget)
+{
+        set_prev_sibling(widget, parent->children_tail);
+        widget->next_sibling = NULL;
+        if (parent->children_tail != NULL) parent->children_tail->next_sibling = widget;
+        else parent->children_head = widget;
+        parent->children_tail = widget;
+}
+
+/**
+ * @brief	Adds a widget before the first child of a widget.
+ *
+ * @param	parent		The parent.
+ * @param	widget		The widget, which is not a child yet.
+ */
+static void prepend_child(ei_widget_t* parent, ei_widget_t* widget)
+{
+        set_prev_sibling(widget, NULL);
+        widget->next_sibling = parent->children_head;
+        if (parent->children_head != NULL) set_prev_sibling(parent->children_head, widget);
+        else parent->children_tail = widget;
+        parent->children_head = widget;
+}
+
+/**
+ * @brief	Removes a widget from the children of its parent, in constant time.
+ *
+ * @param	widget		The widget, which must have a parent.
+ */
+static void unlink_child(ei_widget_t* widget)
+{
+        ei_widget_t *parent = widget->parent;
+        ei_widget_t *prev = prev_sibling(widget);
+        if (prev != NULL) prev->next_sibling = widget->next_sibling;
+        else if (parent->children_head == widget) parent->children_head = widget->next_sibling;
+        if (widget->next_sibling != NULL) set_prev_sibling(widget->next_sibling, prev);
+        else if (parent->children_tail == widget) parent->children_tail = prev;
+        widget->next_sibling = NULL;
+        set_prev_sibling(widget, NULL);
+}
 
 /**
  * @brief	Creates a new instance of a widget of some particular class, as a descendant of
@@ -26,10 +114,12 @@ ei_widget_t* ei_widget_create(ei_widgetclass_name_t class_name, ei_widget_t* par
                               ei_widget_destructor_t destructor)
 {
         ei_widgetclass_t* wclass = ei_widgetclass_from_name(class_name);
+        uint32_t pick_id;
+        if (!ei_picking_acquire_id(&pick_id)) return NULL;
         ei_widget_t* widget = wclass->allocfunc();
         widget->wclass = wclass;
         widget->pick_color = id_to_color(pick_id);
-        widget->pick_id = pick_id++;
+        widget->pick_id = pick_id;
         widget->user_data = user_data;
         widget->destructor = destructor;
 
@@ -37,20 +127,13 @@ ei_widget_t* ei_widget_create(ei_widgetclass_name_t class_name, ei_widget_t* par
         widget->children_head = NULL;
         widget->children_tail = NULL;
         widget->next_sibling = NULL;
+        set_prev_sibling(widget, NULL);
 
-        if (widget->parent) {
-                if (widget->parent->children_head == NULL) {
-                        widget->parent->children_head = widget;
-                        widget->parent->children_tail = widget;
-                } else {
-                        widget->parent->children_tail->next_sibling = widget;
-                        widget->parent->children_tail = widget;
-                }
-                ei_app_invalidate_rect(ei_app_root_widget()->content_rect);
-        }
+        // The widget is drawn once it is placed by a geometry manager
+        if (widget->parent) append_child(widget->parent, widget);
 
         widget->content_rect = &widget->screen_location;
-        widget->placer_params = malloc(sizeof(ei_placer_params_t));
+        widget->placer_params = ei_calloc(1, sizeof(ei_placer_params_t));
         widget->wclass->setdefaultsfunc(widget);
         return widget;
 }
@@ -68,8 +151,14 @@ static void ei_widget_destroy_rec(ei_widget_t* widget)
         }
         if (widget->destructor != NULL) widget->destructor(widget);
         free(widget->pick_color);
+        ei_gridder_release(widget);
+        ei_record_release(widget);
         free(widget->placer_params);
+        // The ID is given to a new widget once this one is released
+        uint32_t pick_id = widget->pick_id;
+        if (pick_id < prev_siblings_size) prev_siblings[pick_id] = NULL;
         widget->wclass->releasefunc(widget);
+        ei_picking_release_id(pick_id);
 }
 
 /**
@@ -83,31 +172,10 @@ void ei_widget_destroy(ei_widget_t* widget)
 {
         ei_event_set_active_widget(NULL);
         if (widget != ei_app_root_widget()) {
-                ei_app_invalidate_rect(widget->parent->content_rect);
-                ei_widget_t *prev_widget = NULL;
-                ei_widget_t *curr_widget = widget->parent->children_head;
-
-                if (curr_widget == widget) {
-                        if (widget->parent->children_head == widget->parent->children_tail) {
-                                widget->parent->children_head = NULL;
-                                widget->parent->children_tail = NULL;
-                        } else {
-                                widget->parent->children_head = widget->next_sibling;
-                        }
-                } else {
-                        prev_widget = curr_widget;
-
-                        while (curr_widget != widget && curr_widget != NULL) {
-                                prev_widget = curr_widget;
-                                curr_widget = curr_widget->next_sibling;
-                        }
-
-                        if (curr_widget != NULL) {
-                                prev_widget->next_sibling = curr_widget->next_sibling;
-                                if (curr_widget->next_sibling == NULL)
-                                        widget->parent->children_tail = prev_widget;
-                        }
-                }
+                // Only where the widget was visible is redrawn, its descendants are inside
+                ei_rect_t outer_rect = ei_widget_outer_rect(widget);
+                ei_widget_invalidate_rect(widget, &outer_rect);
+                unlink_child(widget);
         }
 
         ei_widget_destroy_rec(widget);
@@ -146,13 +214,292 @@ static ei_widget_t* find_widget_from_id(ei_widget_t *widget, uint32_t id)
  */
 ei_widget_t* ei_widget_pick(ei_point_t* where)
 {
-        ei_surface_t *picking_surface = ei_picking_get_picking_surface();
-        uint32_t *pixel = (uint32_t*) hw_surface_get_buffer(picking_surface);
-        pixel += where->x + hw_surface_get_size(picking_surface).width * where->y;
-        uint32_t id = color_to_id(pixel_to_color(picking_surface, *pixel));
+        uint32_t id = ei_picking_get_id(where);
         return (ei_app_root_widget()->pick_id == id) ? NULL : find_widget_from_id(ei_app_root_widget(), id);
 }
 
+/**
+ * @brief	Clips a part of a widget to where it is visible: inside the widget, and inside the
+ *		content of each of its ancestors where the ancestor shows it, e.g. the viewport
+ *		of a scrollframe.
+ *
+ * @param	widget		The widget.
+ * @param	rect		The part of the widget, in the root window coordinates.
+ * @param	visible_rect	Where to store the visible part.
+ *
+ * @return			EI_TRUE if some of the part is visible.
+ */
+static ei_bool_t clip_visible(ei_widget_t* widget, const ei_rect_t* rect, ei_rect_t* visible_rect)
+{
+        ei_rect_t outer_rect = ei_widget_outer_rect(widget);
+        *visible_rect = rectangle_intersect(&outer_rect, (ei_rect_t*) rect);
+        for (ei_widget_t *ancestor = widget->parent; ancestor != NULL; ancestor = ancestor->parent) {
+                if (visible_rect->size.width <= 0 || visible_rect->size.height <= 0) return EI_FALSE;
+                outer_rect = ei_widget_outer_rect(ancestor);
+                *visible_rect = rectangle_intersect(&outer_rect, visible_rect);
+                *visible_rect = rectangle_intersect(ancestor->content_rect, visible_rect);
+        }
+        return (ei_bool_t) (visible_rect->size.width > 0 && visible_rect->size.height > 0);
+}
+
+/**
+ * @brief	Tells the application that the appearance of a widget has changed: only the
+ *		visible part of its screen location is redrawn, not the whole parent.
+ *
+ * @param	widget		The widget whose appearance has changed.
+ */
+void ei_widget_invalidate(ei_widget_t* widget)
+{
+        ei_record_discard(widget);
+        ei_rect_t visible_rect;
+        if (clip_visible(widget, &widget->screen_location, &visible_rect)) ei_app_invalidate_rect(&visible_rect);
+}
+
+/**
+ * @brief	Tells the application that a part of a widget has changed, e.g. a cell of a grid:
+ *		only this part is redrawn, where the widget is visible.
+ *
+ * @param	widget		The widget whose appearance has changed.
+ * @param	rect		The part of the widget, in the root window coordinates.
+ */
+void ei_widget_invalidate_rect(ei_widget_t* widget, const ei_rect_t* rect)
+{
+        ei_record_discard(widget);
+        ei_rect_t visible_rect;
+        if (clip_visible(widget, rect, &visible_rect)) ei_app_invalidate_rect(&visible_rect);
+}
+
+/**
+ * @brief	Tells if something is drawn over a rectangle after a widget: one of the next
+ *		siblings of the widget or of its ancestors, or the resize icon of a toplevel.
+ *
+ * @param	widget		The widget.
+ * @param	rect		The rectangle, in the widget.
+ *
+ * @return			EI_TRUE if the pixels of the rectangle are not only the widget's.
+ */
+static ei_bool_t is_covered(ei_widget_t* widget, const ei_rect_t* rect)
+{
+        ei_rect_t area = *rect;
+        for (; widget->parent != NULL; widget = widget->parent) {
+                for (ei_widget_t *sibling = widget->next_sibling; sibling != NULL; sibling = sibling->next_sibling) {
+                        ei_rect_t outer_rect = ei_widget_outer_rect(sibling);
+                        ei_rect_t covered = rectangle_intersect(&outer_rect, &area);
+                        if (covered.size.width > 0 && covered.size.height > 0) return EI_TRUE;
+                }
+                ei_rect_t icon;
+                if (widget->parent->wclass == &toplevelclass && ei_toplevel_resize_rect(widget->parent, &icon)) {
+                        ei_rect_t covered = rectangle_intersect(&icon, &area);
+                        if (covered.size.width > 0 && covered.size.height > 0) return EI_TRUE;
+                }
+        }
+        return EI_FALSE;
+}
+
+/**
+ * @brief	Moves the pixels of a part of a widget already on screen, e.g. to scroll its
+ *		content, where they are visible. Only the rest of the part must then be redrawn.
+ *		When other widgets are drawn over the part, it is redrawn instead.
+ *
+ * @param	widget		The widget whose appearance has changed.
+ * @param	rect		The part of the widget, in the root window coordinates.
+ * @param	dx, dy		The offset of the pixels.
+ */
+void ei_widget_scroll_rect(ei_widget_t* widget, const ei_rect_t* rect, int dx, int dy)
+{
+        ei_record_discard(widget);
+        ei_rect_t visible_rect;
+        if (!clip_visible(widget, rect, &visible_rect)) return;
+        // The pixels can only be moved if they all belong to the widget
+        if (is_covered(widget, &visible_rect)) {
+                ei_app_invalidate_rect(&visible_rect);
+        } else {
+                ei_app_scroll_rect(&visible_rect, dx, dy);
+        }
+}
+
+/**
+ * @brief	Returns the rectangle where a widget draws: its screen location, and the
+ *		decorations around it for a toplevel.
+ *
+ * @param	widget		The widget, placed by its geometry manager.
+ *
+ * @return			The rectangle, in the root window coordinates.
+ */
+ei_rect_t ei_widget_outer_rect(ei_widget_t* widget)
+{
+        ei_rect_t outer_rect = widget->screen_location;
+        if (widget->wclass != &toplevelclass) return outer_rect;
+        ei_toplevel_t *toplevel = (ei_toplevel_t *) widget;
+        int title_width = 0;
+        int title_height = 0;
+        hw_text_compute_size(*toplevel->title, ei_default_font, &title_width, &title_height);
+        outer_rect.size.height += title_height + 2 * *toplevel->border_width;
+        outer_rect.size.width += 2 * *toplevel->border_width;
+        return outer_rect;
+}
+
+/**
+ * @brief	Redraws the area of a widget after it has moved among its siblings: it covers, or
+ *		is covered by, other parts of them. The decorations of a toplevel are included.
+ *
+ * @param	widget		The widget.
+ */
+static void invalidate_stacking(ei_widget_t* widget)
+{
+        if (widget->wclass != &toplevelclass) {
+                ei_widget_invalidate(widget);
+                return;
+        }
+        ei_rect_t rect2invalidate = ei_widget_outer_rect(widget);
+        ei_app_invalidate_rect(&rect2invalidate);
+}
+
+/**
+ * @brief	Puts a widget above its siblings: it is drawn after them, and picked where they
+ *		overlap. Takes a constant time, whatever the number of siblings.
+ *
+ * @param	widget		The widget. Nothing is done for the root widget.
+ */
+void ei_widget_raise(ei_widget_t* widget)
+{
+        if (widget->parent == NULL || widget->parent->children_tail == widget) return;
+        unlink_child(widget);
+        append_child(widget->parent, widget);
+        invalidate_stacking(widget);
+}
+
+/**
+ * @brief	Puts a widget below its siblings: it is drawn before them, and they are picked
+ *		where they overlap. Takes a constant time, whatever the number of siblings.
+ *
+ * @param	widget		The widget. Nothing is done for the root widget.
+ */
+void ei_widget_lower(ei_widget_t* widget)
+{
+        if (widget->parent == NULL || widget->parent->children_head == widget) return;
+        unlink_child(widget);
+        prepend_child(widget->parent, widget);
+        invalidate_stacking(widget);
+}
+
+/**
+ * @brief	Releases the table of the previous siblings. Called when the application is
+ *		released, after the widgets.
+ */
+void ei_widget_siblings_free(void)
+{
+        free(prev_siblings);
+        prev_siblings = NULL;
+        prev_siblings_size = 0;
+}
+
+/**
+ * @brief	Replaces the image of a widget by a copy of a new image.
+ *
+ * @param	field		The image of the widget, or NULL.
+ * @param	img		A pointer to the new image (which can be NULL), or NULL to keep the
+ *				current one.
+ *
+ * @return			EI_TRUE if the image has changed.
+ */
+static ei_bool_t update_image(ei_surface_t* field, ei_surface_t* img)
+{
+        if (img == NULL) return EI_FALSE;
+        if (*img == NULL) {
+                if (*field == NULL) return EI_FALSE;
+                hw_surface_free(*field);
+                *field = NULL;
+                return EI_TRUE;
+        }
+        // The widget draws its own copy, which can not be cheaply compared to the new image
+        if (*field != NULL) hw_surface_free(*field);
+        ei_size_t img_surf_size = hw_surface_get_size(*img);
+        ei_surface_t cpy_img = hw_surface_create(ei_app_root_surface(), img_surf_size, 1);
+        ei_stats.surfaces_created++;
+        ei_copy_surface(cpy_img, NULL, *img, NULL, 0);
+        *field = cpy_img;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Replaces the part of the image displayed by a widget, only if it is given and
+ *		different.
+ *
+ * @param	field		The rectangle of the widget, allocated with malloc, or NULL.
+ * @param	img_rect	A pointer to the new rectangle, or NULL to keep the current one.
+ *
+ * @return			EI_TRUE if the rectangle has changed.
+ */
+static ei_bool_t update_image_rect(ei_rect_t** field, ei_rect_t** img_rect)
+{
+        if (img_rect == NULL || *img_rect == NULL) return EI_FALSE;
+        if (*field != NULL && memcmp(*field, *img_rect, sizeof(ei_rect_t)) == 0) return EI_FALSE;
+        free(*field);
+        ei_rect_t* cpy_img_rect = ei_malloc(sizeof(ei_rect_t));
+        *cpy_img_rect = **img_rect;
+        *field = cpy_img_rect;
+        return EI_TRUE;
+}
+
+/**
+ * @brief	Ends a configure function of a widget class: redraws the widget if it has changed,
+ *		or counts the call as elided if nothing has changed.
+ *
+ *		Only the outer rectangle of the widget is redrawn, decorations of a toplevel
+ *		included. When the requested size has changed, the widget is placed again and
+ *		redrawn at its old and at its new place, or its whole parent is redrawn when
+ *		the "gridder" may move its siblings too.
+ *
+ * @param	widget			The configured widget.
+ * @param	changed			EI_TRUE if an attribute of the widget has changed.
+ * @param	old_requested_size	The requested size of the widget before the call.
+ */
+void ei_widget_configured(ei_widget_t* widget, ei_bool_t changed, ei_size_t old_requested_size)
+{
+        configure_count++;
+        ei_bool_t resized = (widget->requested_size.width != old_requested_size.width ||
+                             widget->requested_size.height != old_requested_size.height);
+        if (!changed && !resized) {
+                elided_count++;
+                return;
+        }
+        if (resized) ei_gridder_child_changed(widget);
+        if (resized && widget->parent != NULL && widget->placer_params->grid != NULL) {
+                ei_widget_invalidate(widget->parent);
+                return;
+        }
+        ei_rect_t outer_rect = ei_widget_outer_rect(widget);
+        ei_widget_invalidate_rect(widget, &outer_rect);
+        if (resized && widget->parent != NULL) {
+                ei_placer_run(widget);
+                outer_rect = ei_widget_outer_rect(widget);
+                ei_widget_invalidate_rect(widget, &outer_rect);
+        }
+}
+
+/**
+ * @brief	Returns the number of calls to the configure functions since the application
+ *		was started.
+ *
+ * @return			The number of calls.
+ */
+unsigned long ei_widget_configure_count(void)
+{
+        return configure_count;
+}
+
+/**
+ * @brief	Returns the number of calls to the configure functions which have been elided
+ *		because they did not change anything: nothing was copied nor redrawn.
+ *
+ * @return			The number of elided calls.
+ */
+unsigned long ei_widget_configure_elided_count(void)
+{
+        return elided_count;
+}
+
 /**
  * @brief	Configures the attributes of widgets of the class "frame".
  *
@@ -206,41 +553,18 @@ void ei_frame_configure (ei_widget_t* widget,
                          ei_anchor_t* img_anchor)
 {
         ei_frame_t *frame = (ei_frame_t*) widget;
-        if (color != NULL) *frame->color = *color;
-        if (border_width != NULL) *frame->border_width = *border_width;
-        if (relief != NULL) *frame->relief = *relief;
-        if (text != NULL) {
-                free(*frame->text);
-                if (*text != NULL) {
-                        *frame->text = calloc(strlen(*text) + 1, sizeof(char));
-                        strcpy(*frame->text, *text);
-                } else {
-                        *frame->text = NULL;
-                }
-        }
-        if (text_font != NULL) *frame->text_font = *text_font;
-        if (text_color != NULL) *frame->text_color = *text_color;
-        if (text_anchor != NULL) *frame->text_anchor = *text_anchor;
-        if (img != NULL) {
-                if (*img != NULL) {
-                        if (*frame->img != NULL) hw_surface_free(*frame->img);
-                        ei_size_t img_surf_size = hw_surface_get_size(*img);
-                        ei_surface_t cpy_img = hw_surface_create(ei_app_root_surface(), img_surf_size, 1);
-                        ei_copy_surface(cpy_img, NULL, *img, NULL, 0);
-                        *frame->img = cpy_img;
-                } else {
-                        *frame->img = NULL;
-                }
-        }
-        if (img_rect != NULL && *img_rect != NULL) {
-                free(*frame->img_rect);
-                ei_rect_t* cpy_img_rect = malloc(sizeof(ei_rect_t));
-                cpy_img_rect->top_left.x = (**img_rect).top_left.x;
-                cpy_img_rect->top_left.y = (**img_rect).top_left.y;
-                cpy_img_rect->size = (**img_rect).size;
-                (*frame->img_rect) = cpy_img_rect;
-        }
-        if (img_anchor != NULL) *frame->img_anchor = *img_anchor;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(frame->color, color, sizeof(ei_color_t));
+        changed |= update_field(frame->border_width, border_width, sizeof(int));
+        changed |= update_field(frame->relief, relief, sizeof(ei_relief_t));
+        changed |= update_text(frame->text, text);
+        changed |= update_field(frame->text_font, text_font, sizeof(ei_font_t));
+        changed |= update_field(frame->text_color, text_color, sizeof(ei_color_t));
+        changed |= update_field(frame->text_anchor, text_anchor, sizeof(ei_anchor_t));
+        changed |= update_image(frame->img, img);
+        changed |= update_image_rect(frame->img_rect, img_rect);
+        changed |= update_field(frame->img_anchor, img_anchor, sizeof(ei_anchor_t));
         if (requested_size != NULL) {
                 widget->requested_size = *requested_size;
         } else {
@@ -261,7 +585,7 @@ void ei_frame_configure (ei_widget_t* widget,
                 widget->requested_size.width = min_size.width;
                 widget->requested_size.height = min_size.height;
         }
-        ei_app_invalidate_rect(widget->content_rect);
+        ei_widget_configured(widget, changed, old_requested_size);
 }
 
 /**
@@ -297,44 +621,22 @@ void ei_button_configure (ei_widget_t* widget,
                           void** user_param)
 {
         ei_button_t *button = (ei_button_t*) widget;
-        if (color != NULL) *button->color = *color;
-        if (border_width != NULL) *button->border_width = *border_width;
-        if (corner_radius != NULL) *button->corner_radius = *corner_radius;
-        if (relief != NULL) *button->relief = *relief;
-        if (text != NULL) {
-                free(*button->text);
-                if (*text != NULL) {
-                        *button->text = calloc(strlen(*text) + 1, sizeof(char));
-                        strcpy(*button->text, *text);
-                } else {
-                        *button->text = NULL;
-                }
-        }
-        if (text_font != NULL) *button->text_font = *text_font;
-        if (text_color != NULL) *button->text_color = *text_color;
-        if (text_anchor != NULL) *button->text_anchor = *text_anchor;
-        if (img != NULL) {
-                if (*img != NULL) {
-                        if (*button->img != NULL) hw_surface_free(*button->img);
-                        ei_size_t img_surf_size = hw_surface_get_size(*img);
-                        ei_surface_t cpy_img = hw_surface_create(ei_app_root_surface(), img_surf_size, 1);
-                        ei_copy_surface(cpy_img, NULL, *img, NULL, 0);
-                        *button->img = cpy_img;
-                } else {
-                        *button->img = NULL;
-                }
-        }
-        if (img_rect != NULL && *img_rect != NULL) {
-                free(*button->img_rect);
-                ei_rect_t* cpy_img_rect = malloc(sizeof(ei_rect_t));
-                cpy_img_rect->top_left.x = (**img_rect).top_left.x;
-                cpy_img_rect->top_left.y = (**img_rect).top_left.y;
-                cpy_img_rect->size = (**img_rect).size;
-                (*button->img_rect) = cpy_img_rect;
-        }
-        if (img_anchor != NULL) *button->img_anchor = *img_anchor;
-        if (callback != NULL) *button->callback = *callback;
-        if (user_param != NULL) *button->user_param = *user_param;
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(button->color, color, sizeof(ei_color_t));
+        changed |= update_field(button->border_width, border_width, sizeof(int));
+        changed |= update_field(button->corner_radius, corner_radius, sizeof(int));
+        changed |= update_field(button->relief, relief, sizeof(ei_relief_t));
+        changed |= update_text(button->text, text);
+        changed |= update_field(button->text_font, text_font, sizeof(ei_font_t));
+        changed |= update_field(button->text_color, text_color, sizeof(ei_color_t));
+        changed |= update_field(button->text_anchor, text_anchor, sizeof(ei_anchor_t));
+        changed |= update_image(button->img, img);
+        changed |= update_image_rect(button->img_rect, img_rect);
+        changed |= update_field(button->img_anchor, img_anchor, sizeof(ei_anchor_t));
+        // The callback is not drawn: changing it needs no redraw
+        update_field(button->callback, callback, sizeof(ei_callback_t));
+        update_field(button->user_param, user_param, sizeof(void*));
         if (requested_size != NULL) {
                 widget->requested_size = *requested_size;
         } else {
@@ -360,7 +662,7 @@ void ei_button_configure (ei_widget_t* widget,
                 widget->requested_size.width = min_size.width;
                 widget->requested_size.height = min_size.height;
         }
-        ei_app_invalidate_rect(widget->content_rect);
+        ei_widget_configured(widget, changed, old_requested_size);
 }
 
 /**
@@ -395,15 +697,18 @@ void			ei_toplevel_configure		(ei_widget_t*		widget,
                                                                   ei_size_t**		min_size)
 {
         ei_toplevel_t *toplevel = (ei_toplevel_t*) widget;
-        if (color != NULL) *toplevel->color = *color;
-        if (border_width != NULL) *toplevel->border_width = *border_width;
-        if (title != NULL & *title != NULL) {
+        ei_size_t old_requested_size = widget->requested_size;
+        ei_bool_t changed = EI_FALSE;
+        changed |= update_field(toplevel->color, color, sizeof(ei_color_t));
+        changed |= update_field(toplevel->border_width, border_width, sizeof(int));
+        if (title != NULL && *title != NULL && strcmp(*toplevel->title, *title) != 0) {
                 if (strcmp(*toplevel->title,"Toplevel")) free(*toplevel->title);
-                *toplevel->title = calloc(strlen(*title)+1, sizeof(char));
+                *toplevel->title = ei_calloc(strlen(*title)+1, sizeof(char));
                 strcpy(*toplevel->title, *title);
+                changed = EI_TRUE;
         }
-        if (closable != NULL) *toplevel->closable = *closable;
-        if (resizable != NULL) *toplevel->resizable = *resizable;
+        changed |= update_field(toplevel->closable, closable, sizeof(ei_bool_t));
+        changed |= update_field(toplevel->resizable, resizable, sizeof(ei_axis_set_t));
         if (min_size != NULL && *min_size != NULL) *toplevel->min_size = *min_size;
         if (requested_size != NULL) {
                 // Set requested_size to a proper size
@@ -419,5 +724,5 @@ void			ei_toplevel_configure		(ei_widget_t*		widget,
                 if (min_size != NULL && *min_size != NULL) widget->requested_size = **min_size;
                 else widget->requested_size = **toplevel->min_size;
         }
-        ei_app_invalidate_rect(widget->content_rect);
-}
\ No newline at end of file
+        ei_widget_configured(widget, changed, old_requested_size);
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_canvas.h"
+#include "ei_event.h"
+#include "ei_scrollframe.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A map of 100000 shapes in a canvas, larger than the window, in a scrollframe. The map is
+ * scrolled with the arrow keys, clicking a shape removes it. */
+
+#define ITEM_COUNT	100000
+#define MAP_SIZE	8000
+#define SCROLL_STEP	40
+
+static ei_widget_t*	g_scrollframe;
+
+/*
+ * item_event --
+ *
+ *	Callback called for the mouse events over the canvas.
+ */
+ei_bool_t item_event(ei_widget_t* widget, int item, ei_event_t* event, void* user_param)
+{
+	if (event->type != ei_ev_mouse_buttondown || item == 0)
+		return EI_FALSE;
+
+	printf("Remove item %d\n", item);
+	ei_canvas_delete(widget, item);
+	return EI_TRUE;
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Scrolls the map with the arrow keys, and looks for the "Escape" key to request the
+ *	application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	switch (event->param.key.key_code) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_LEFT:
+			ei_scrollframe_scroll_by(g_scrollframe, -SCROLL_STEP, 0);
+			return EI_TRUE;
+		case SDLK_RIGHT:
+			ei_scrollframe_scroll_by(g_scrollframe, SCROLL_STEP, 0);
+			return EI_TRUE;
+		case SDLK_UP:
+			ei_scrollframe_scroll_by(g_scrollframe, 0, -SCROLL_STEP);
+			return EI_TRUE;
+		case SDLK_DOWN:
+			ei_scrollframe_scroll_by(g_scrollframe, 0, SCROLL_STEP);
+			return EI_TRUE;
+		default:
+			return EI_FALSE;
+	}
+}
+
+/*
+ * add_shape --
+ *
+ *	Adds a random triangle, square or zigzag line to the canvas.
+ */
+static void add_shape(ei_widget_t* canvas)
+{
+	ei_linked_point_t	points[4];
+	int			x	= rand() % MAP_SIZE;
+	int			y	= rand() % MAP_SIZE;
+	int			size	= 6 + rand() % 20;
+	int			kind	= rand() % 3;
+	ei_color_t		color	= {(unsigned char) rand(), (unsigned char) rand(), (unsigned char) rand(), 0xff};
+
+	points[0].point = ei_point(x, y);
+	points[1].point = ei_point(x + size, y + (kind == 0 ? size / 2 : 0));
+	points[2].point = ei_point(kind == 0 ? x : x + size, y + size);
+	points[3].point = ei_point(x, y + size);
+	for (int i = 0; i < 4; i++)
+		points[i].next = (i < 3) ? &points[i + 1] : NULL;
+	if (kind == 0)
+		points[2].next = NULL;
+
+	if (kind == 2)
+		ei_canvas_add_polyline(canvas, points, color);
+	else
+		ei_canvas_add_polygon(canvas, points, color);
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t		screen_size		= {600, 600};
+	ei_color_t		root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+
+	ei_size_t		viewport_size		= {560, 560};
+	int			viewport_x		= 20;
+	int			viewport_y		= 20;
+
+	ei_widget_t*		canvas;
+	ei_size_t		map_size		= {MAP_SIZE, MAP_SIZE};
+	ei_color_t		map_color		= {0xf0, 0xf0, 0xe0, 0xff};
+	ei_color_t		label_color		= {0x20, 0x20, 0x20, 0xff};
+	ei_canvas_handlefunc_t	handlefunc		= item_event;
+
+	ei_app_create(screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	g_scrollframe = ei_widget_create("scrollframe", ei_app_root_widget(), NULL, NULL);
+	ei_scrollframe_configure(g_scrollframe, &viewport_size, NULL, &map_size);
+	ei_place(g_scrollframe, NULL, &viewport_x, &viewport_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* The canvas is as large as the map: only the shapes under the viewport are drawn. */
+	canvas = ei_widget_create("canvas", g_scrollframe, NULL, NULL);
+	ei_canvas_configure(canvas, &map_size, &map_color, &handlefunc, NULL);
+	ei_place(canvas, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	srand(1);
+	for (int i = 0; i < ITEM_COUNT; i++)
+		add_shape(canvas);
+	for (int y = 0; y < MAP_SIZE; y += 500) {
+		for (int x = 0; x < MAP_SIZE; x += 500) {
+			char		label[16];
+			ei_point_t	where	= {x + 4, y + 4};
+			snprintf(label, sizeof(label), "%d,%d", x, y);
+			ei_canvas_add_text(canvas, &where, label, NULL, label_color);
+		}
+	}
+
+	ei_app_run();
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,106 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_chart.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A live trace of 100000 samples of a noisy signal, streamed in a chart. The "Space" key
+ * pauses the stream, the "Escape" key quits. */
+
+#define SAMPLE_COUNT		100000
+#define SAMPLES_PER_TICK	800
+#define TICK_MS			20
+
+static ei_widget_t*	g_chart;
+static ei_bool_t	g_paused		= EI_FALSE;
+static long		g_time			= 0;
+
+/*
+ * stream_samples --
+ *
+ *	Appends the samples of one tick to the chart, and schedules the next tick.
+ */
+static void stream_samples(void)
+{
+	float	samples[SAMPLES_PER_TICK];
+
+	for (int i = 0; i < SAMPLES_PER_TICK; i++, g_time++) {
+		float noise	= (float) rand() / RAND_MAX - 0.5f;
+		float spike	= (g_time % 37000 < 40) ? 1.5f : 0.0f;
+		samples[i]	= sinf((float) g_time / 6000.0f) + 0.3f * sinf((float) g_time / 90.0f) +
+				  0.2f * noise + spike;
+	}
+	ei_chart_append(g_chart, samples, SAMPLES_PER_TICK);
+}
+
+/*
+ * process_event --
+ *
+ *	Callback called for the events not handled by a widget.
+ *	Streams the samples on the application events, pauses with the "Space" key, and looks
+ *	for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_event(ei_event_t* event)
+{
+	if (event->type == ei_ev_app) {
+		if (!g_paused)
+			stream_samples();
+		hw_event_schedule_app(TICK_MS, NULL);
+		return EI_TRUE;
+	}
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	switch (event->param.key.key_code) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_SPACE:
+			g_paused = !g_paused;
+			return EI_TRUE;
+		default:
+			return EI_FALSE;
+	}
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t		screen_size		= {640, 300};
+	ei_color_t		root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+
+	ei_size_t		chart_size		= {600, 260};
+	int			chart_x			= 20;
+	int			chart_y			= 20;
+	ei_color_t		chart_color		= {0x10, 0x18, 0x20, 0xff};
+	ei_color_t		trace_color		= {0x40, 0xe0, 0x60, 0xff};
+	int			capacity		= SAMPLE_COUNT;
+	int			samples_per_column	= SAMPLE_COUNT / 600;
+	float			min_value		= -2.0f;
+	float			max_value		= 2.5f;
+
+	ei_app_create(screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_event);
+
+	/* Each column of pixels shows the minimum and the maximum of 166 samples. */
+	g_chart = ei_widget_create("chart", ei_app_root_widget(), NULL, NULL);
+	ei_chart_configure(g_chart, &chart_size, &chart_color, &trace_color, &capacity, &samples_per_column,
+			   &min_value, &max_value);
+	ei_place(g_chart, NULL, &chart_x, &chart_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	hw_event_schedule_app(TICK_MS, NULL);
+
+	ei_app_run();
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
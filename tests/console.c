@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_console.h"
+#include "ei_event.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A log of 50 lines every 20 milliseconds, shown in a console. The "Space" key pauses the log,
+ * the "Escape" key quits. */
+
+#define LINES_PER_TICK	50
+#define TICK_MS		20
+
+static ei_widget_t*	g_console;
+static ei_bool_t	g_paused		= EI_FALSE;
+static long		g_line			= 0;
+
+/*
+ * log_lines --
+ *
+ *	Appends the lines of one tick to the console, in one call.
+ */
+static void log_lines(void)
+{
+	static const char*	sources[]	= {"network", "storage", "sensor", "scheduler"};
+	char			text[LINES_PER_TICK * 64];
+	int			length		= 0;
+
+	for (int i = 0; i < LINES_PER_TICK; i++, g_line++) {
+		length += snprintf(text + length, sizeof(text) - length, "%s[%08ld] %-9s value=%d",
+				   (i > 0) ? "\n" : "", g_line, sources[rand() % 4], rand() % 10000);
+	}
+	ei_console_append(g_console, text);
+}
+
+/*
+ * process_event --
+ *
+ *	Callback called for the events not handled by a widget.
+ *	Logs the lines on the application events, pauses with the "Space" key, and looks for
+ *	the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_event(ei_event_t* event)
+{
+	if (event->type == ei_ev_app) {
+		if (!g_paused)
+			log_lines();
+		hw_event_schedule_app(TICK_MS, NULL);
+		return EI_TRUE;
+	}
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	switch (event->param.key.key_code) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_SPACE:
+			g_paused = !g_paused;
+			return EI_TRUE;
+		default:
+			return EI_FALSE;
+	}
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t		screen_size		= {640, 480};
+	ei_color_t		root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+
+	ei_size_t		console_size		= {600, 440};
+	int			console_x		= 20;
+	int			console_y		= 20;
+	ei_color_t		console_color		= {0x10, 0x10, 0x10, 0xff};
+	ei_color_t		text_color		= {0xd0, 0xd0, 0xd0, 0xff};
+	int			capacity		= 10000;
+
+	ei_app_create(screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_event);
+
+	g_console = ei_widget_create("console", ei_app_root_widget(), NULL, NULL);
+	ei_console_configure(g_console, &console_size, &console_color, &text_color, NULL, &capacity);
+	ei_place(g_console, NULL, &console_x, &console_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	hw_event_schedule_app(TICK_MS, NULL);
+
+	ei_app_run();
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "ei_grid.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A 200x200 game of life board: 40000 cells, drawn by a single "grid" widget. */
+
+#define BOARD_SIZE 200
+
+typedef struct {
+	ei_widget_t*	grid;
+	unsigned char	alive[BOARD_SIZE][BOARD_SIZE];
+	unsigned char	next[BOARD_SIZE][BOARD_SIZE];
+} board_t;
+
+static board_t		g_board;
+static ei_color_t	g_alive_color	= {0x20, 0x20, 0x20, 0xff};
+static ei_color_t	g_dead_color	= {0xf0, 0xf0, 0xe0, 0xff};
+
+/*
+ * draw_cell --
+ *
+ *	Draws one cell of the board.
+ */
+void draw_cell(ei_widget_t* widget, int row, int col, ei_surface_t surface,
+	       const ei_rect_t* cell_rect, const ei_rect_t* clipper, void* user_param)
+{
+	board_t* board = (board_t*) user_param;
+	ei_fill(surface, board->alive[row][col] ? &g_alive_color : &g_dead_color, clipper);
+}
+
+/*
+ * toggle_cell --
+ *
+ *	Toggles a cell when it is clicked.
+ */
+ei_bool_t toggle_cell(ei_widget_t* widget, int row, int col, ei_event_t* event, void* user_param)
+{
+	board_t* board = (board_t*) user_param;
+	if (event->type != ei_ev_mouse_buttondown)
+		return EI_FALSE;
+	board->alive[row][col] = !board->alive[row][col];
+	ei_grid_invalidate_cell(widget, row, col);
+	return EI_TRUE;
+}
+
+/*
+ * step --
+ *
+ *	Computes the next generation, and only redraws the cells that changed.
+ */
+void step(board_t* board)
+{
+	for (int row = 0; row < BOARD_SIZE; row++)
+		for (int col = 0; col < BOARD_SIZE; col++) {
+			int neighbours = 0;
+			for (int dr = -1; dr <= 1; dr++)
+				for (int dc = -1; dc <= 1; dc++) {
+					int r = row + dr, c = col + dc;
+					if ((dr || dc) && r >= 0 && r < BOARD_SIZE && c >= 0 && c < BOARD_SIZE)
+						neighbours += board->alive[r][c];
+				}
+			board->next[row][col] = (neighbours == 3 || (neighbours == 2 && board->alive[row][col]));
+		}
+	for (int row = 0; row < BOARD_SIZE; row++)
+		for (int col = 0; col < BOARD_SIZE; col++)
+			if (board->next[row][col] != board->alive[row][col]) {
+				board->alive[row][col] = board->next[row][col];
+				ei_grid_invalidate_cell(board->grid, row, col);
+			}
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	"Space" computes the next generation, "Escape" quits.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown) {
+		if (event->param.key.key_code == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		} else if (event->param.key.key_code == SDLK_SPACE) {
+			step(&g_board);
+			return EI_TRUE;
+		}
+	}
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t		screen_size	= {820, 820};
+	int			rows		= BOARD_SIZE;
+	int			cols		= BOARD_SIZE;
+	ei_size_t		cell_size	= {3, 3};
+	int			spacing		= 1;
+	ei_color_t		grid_color	= {0xa0, 0xa0, 0xa0, 0xff};
+	ei_grid_drawfunc_t	drawfunc	= draw_cell;
+	ei_grid_handlefunc_t	handlefunc	= toggle_cell;
+	void*			user_param	= &g_board;
+	int			grid_x		= 10;
+	int			grid_y		= 10;
+
+	ei_app_create(screen_size, EI_FALSE);
+
+	/* A glider and a blinker to start with. */
+	memset(&g_board, 0, sizeof(g_board));
+	g_board.alive[1][2] = g_board.alive[2][3] = 1;
+	g_board.alive[3][1] = g_board.alive[3][2] = g_board.alive[3][3] = 1;
+	g_board.alive[100][99] = g_board.alive[100][100] = g_board.alive[100][101] = 1;
+
+	g_board.grid = ei_widget_create("grid", ei_app_root_widget(), NULL, NULL);
+	ei_grid_configure(g_board.grid, NULL, &rows, &cols, &cell_size, &spacing, &grid_color,
+			  &drawfunc, &handlefunc, &user_param);
+	ei_place(g_board.grid, NULL, &grid_x, &grid_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	ei_event_set_default_handle_func(process_key);
+
+	ei_app_run();
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "ei_gridder.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A form laid out by the "gridder": labels on the left, buttons on the right. The buttons
+ * column takes the width left when the window is resized, the last row takes the height. */
+
+#define FORM_ROWS 12
+
+static char*	g_labels[FORM_ROWS] = {"Name", "Address", "City", "Zip code", "Country", "Phone",
+				       "E-mail", "Company", "Job", "Language", "Timezone", "Notes"};
+
+/*
+ * button_press --
+ *
+ *	Callback called when a user clicks on a button of the form.
+ */
+void button_press(ei_widget_t* widget, ei_event_t* event, void* user_param)
+{
+	printf("Edit %s\n", (char*) user_param);
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Simply looks for the "Escape" key to request the application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type == ei_ev_keydown)
+		if (event->param.key.key_code == SDLK_ESCAPE) {
+			ei_app_quit_request();
+			return EI_TRUE;
+		}
+
+	return EI_FALSE;
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {600, 600};
+	ei_color_t	root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+
+	ei_widget_t*	window;
+	ei_size_t	window_size		= {360, 400};
+	char*		window_title		= "Gridder form";
+	int		window_border_width	= 2;
+	ei_bool_t	window_closable		= EI_FALSE;
+	ei_axis_set_t	window_resizable	= ei_axis_both;
+	int		window_x		= 30;
+	int		window_y		= 30;
+
+	ei_color_t	label_color		= {0xd0, 0xd0, 0xd0, 0xff};
+	ei_anchor_t	label_anchor		= ei_anc_west;
+	ei_color_t	button_color		= {0xe9, 0x97, 0x7a, 0xff};
+	int		button_border_width	= 2;
+	int		button_corner_radius	= 6;
+	ei_relief_t	button_relief		= ei_relief_raised;
+	char*		button_title		= "Edit";
+	ei_callback_t	button_callback		= button_press;
+
+	int		label_column		= 0;
+	int		button_column		= 1;
+	int		padding			= 3;
+	ei_bool_t	label_fill		= EI_TRUE;
+	int		label_min_width		= 100;
+	int		grow			= 1;
+
+	ei_app_create(screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	window = ei_widget_create("toplevel", ei_app_root_widget(), NULL, NULL);
+	ei_toplevel_configure(window, &window_size, NULL, &window_border_width,
+				&window_title, &window_closable, &window_resizable, NULL);
+	ei_place(window, NULL, &window_x, &window_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* The rows and columns are computed once for all the children of the window. */
+	ei_gridder_configure_column(window, label_column, NULL, &label_min_width);
+	ei_gridder_configure_column(window, button_column, &grow, NULL);
+	ei_gridder_configure_row(window, FORM_ROWS - 1, &grow, NULL);
+
+	for (int row = 0; row < FORM_ROWS; row++) {
+		ei_widget_t* label = ei_widget_create("frame", window, NULL, NULL);
+		ei_frame_configure(label, NULL, &label_color, NULL, NULL, &g_labels[row], NULL, NULL,
+				   &label_anchor, NULL, NULL, NULL);
+		ei_gridder_place(label, &row, &label_column, &padding, &label_fill, NULL);
+
+		ei_widget_t* button = ei_widget_create("button", window, NULL, NULL);
+		void* user_param = g_labels[row];
+		ei_button_configure(button, NULL, &button_color, &button_border_width,
+				    &button_corner_radius, &button_relief, &button_title, NULL, NULL,
+				    NULL, NULL, NULL, NULL, &button_callback, &user_param);
+		ei_gridder_place(button, &row, &button_column, &padding, NULL, NULL);
+	}
+
+	ei_app_run();
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -285,6 +285,8 @@ void reset_game(map_t* map)
 	map->nb_revealed		= 0;
 	map->start_time			= -1.0;
 
+	// All the cells are replaced: only one repaint is needed at the end
+	ei_app_batch_begin();
 	for (i = 0, cell = map->cells; i < map->width * map->height; i++, cell++) {
 		cell->has_mine		= EI_FALSE;
 		cell->has_flag		= EI_FALSE;
@@ -299,6 +301,7 @@ void reset_game(map_t* map)
 	update_flag_count(map);
 	ei_frame_configure(map->victory_text_widget, NULL, &color, NULL, NULL, &nulltext, NULL, NULL,
 								NULL, NULL, NULL, NULL);
+	ei_app_batch_commit();
 }
 
 /*
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_event.h"
+#include "ei_scrollframe.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A board of buttons larger than the window, in a scrollframe. The board is scrolled with the
+ * arrow keys, or by dragging it between the buttons. */
+
+#define BOARD_SIZE	20
+#define SCROLL_STEP	24
+
+static ei_widget_t*	g_scrollframe;
+
+/*
+ * button_press --
+ *
+ *	Callback called when a user clicks on a button of the board.
+ */
+void button_press(ei_widget_t* widget, ei_event_t* event, void* user_param)
+{
+	printf("Click on %s\n", (char*) user_param);
+}
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Scrolls the board with the arrow keys, and looks for the "Escape" key to request the
+ *	application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	switch (event->param.key.key_code) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_LEFT:
+			ei_scrollframe_scroll_by(g_scrollframe, -SCROLL_STEP, 0);
+			return EI_TRUE;
+		case SDLK_RIGHT:
+			ei_scrollframe_scroll_by(g_scrollframe, SCROLL_STEP, 0);
+			return EI_TRUE;
+		case SDLK_UP:
+			ei_scrollframe_scroll_by(g_scrollframe, 0, -SCROLL_STEP);
+			return EI_TRUE;
+		case SDLK_DOWN:
+			ei_scrollframe_scroll_by(g_scrollframe, 0, SCROLL_STEP);
+			return EI_TRUE;
+		default:
+			return EI_FALSE;
+	}
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t	screen_size		= {600, 600};
+	ei_color_t	root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+
+	ei_size_t	viewport_size		= {400, 400};
+	ei_color_t	board_color		= {0x30, 0x30, 0x30, 0xff};
+	int		viewport_x		= 100;
+	int		viewport_y		= 100;
+
+	int		cell_size		= 60;
+	int		spacing			= 8;
+	ei_size_t	content_size		= {BOARD_SIZE * cell_size + spacing,
+						   BOARD_SIZE * cell_size + spacing};
+	ei_size_t	button_size		= {cell_size - spacing, cell_size - spacing};
+	int		button_border_width	= 2;
+	ei_relief_t	button_relief		= ei_relief_raised;
+	ei_callback_t	button_callback		= button_press;
+
+	static char	button_titles[BOARD_SIZE * BOARD_SIZE][8];
+
+	ei_app_create(screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	g_scrollframe = ei_widget_create("scrollframe", ei_app_root_widget(), NULL, NULL);
+	ei_scrollframe_configure(g_scrollframe, &viewport_size, &board_color, &content_size);
+	ei_place(g_scrollframe, NULL, &viewport_x, &viewport_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* The buttons are placed in the content: only the visible ones are drawn. */
+	for (int row = 0; row < BOARD_SIZE; row++) {
+		for (int col = 0; col < BOARD_SIZE; col++) {
+			char*	title	= button_titles[row * BOARD_SIZE + col];
+			int	x	= spacing + col * cell_size;
+			int	y	= spacing + row * cell_size;
+			ei_color_t color = {(unsigned char) (0x40 + row * 8), (unsigned char) (0x40 + col * 8), 0xa0, 0xff};
+
+			snprintf(title, sizeof(button_titles[0]), "%c%d", 'A' + row, col + 1);
+			ei_widget_t* button = ei_widget_create("button", g_scrollframe, NULL, NULL);
+			void* user_param = title;
+			ei_button_configure(button, &button_size, &color, &button_border_width, NULL,
+					    &button_relief, &title, NULL, NULL, NULL, NULL, NULL, NULL,
+					    &button_callback, &user_param);
+			ei_place(button, NULL, &x, &y, NULL, NULL, NULL, NULL, NULL, NULL);
+		}
+	}
+
+	ei_app_run();
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ei_application.h"
+#include "ei_canvas.h"
+#include "ei_event.h"
+#include "ei_scrollframe.h"
+#include "hw_interface.h"
+#include "ei_widget.h"
+
+/* A board of 10000 tiles cut from one image, with flags over some of them, in a canvas larger
+ * than the window. The tiles, then the flags, are drawn with one call each. The board is
+ * scrolled with the arrow keys. */
+
+#define BOARD_SIZE	100
+#define TILE_SIZE	32
+#define SCROLL_STEP	40
+
+static ei_widget_t*	g_scrollframe;
+
+/*
+ * process_key --
+ *
+ *	Callback called when any key is pressed by the user.
+ *	Scrolls the board with the arrow keys, and looks for the "Escape" key to request the
+ *	application to quit.
+ */
+ei_bool_t process_key(ei_event_t* event)
+{
+	if (event->type != ei_ev_keydown)
+		return EI_FALSE;
+
+	switch (event->param.key.key_code) {
+		case SDLK_ESCAPE:
+			ei_app_quit_request();
+			return EI_TRUE;
+		case SDLK_LEFT:
+			ei_scrollframe_scroll_by(g_scrollframe, -SCROLL_STEP, 0);
+			return EI_TRUE;
+		case SDLK_RIGHT:
+			ei_scrollframe_scroll_by(g_scrollframe, SCROLL_STEP, 0);
+			return EI_TRUE;
+		case SDLK_UP:
+			ei_scrollframe_scroll_by(g_scrollframe, 0, -SCROLL_STEP);
+			return EI_TRUE;
+		case SDLK_DOWN:
+			ei_scrollframe_scroll_by(g_scrollframe, 0, SCROLL_STEP);
+			return EI_TRUE;
+		default:
+			return EI_FALSE;
+	}
+}
+
+/*
+ * ei_main --
+ *
+ *	Main function of the application.
+ */
+int main(int argc, char** argv)
+{
+	ei_size_t		screen_size		= {600, 600};
+	ei_color_t		root_bgcol		= {0x52, 0x7f, 0xb4, 0xff};
+
+	ei_size_t		viewport_size		= {560, 560};
+	int			viewport_x		= 20;
+	int			viewport_y		= 20;
+
+	ei_widget_t*		canvas;
+	ei_size_t		board_size		= {BOARD_SIZE * TILE_SIZE, BOARD_SIZE * TILE_SIZE};
+	ei_surface_t		tiles;
+	ei_surface_t		flag;
+	ei_size_t		tiles_size;
+	ei_size_t		flag_size;
+
+	ei_app_create(screen_size, EI_FALSE);
+	ei_frame_configure(ei_app_root_widget(), NULL, &root_bgcol, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+	ei_event_set_default_handle_func(process_key);
+
+	if ((tiles = hw_image_load("misc/klimt.jpg", ei_app_root_surface())) == NULL ||
+	    (flag = hw_image_load("misc/flag.png", ei_app_root_surface())) == NULL) {
+		printf("ERROR: could not load the images.\n");
+		exit(1);
+	}
+	tiles_size	= hw_surface_get_size(tiles);
+	flag_size	= hw_surface_get_size(flag);
+
+	g_scrollframe = ei_widget_create("scrollframe", ei_app_root_widget(), NULL, NULL);
+	ei_scrollframe_configure(g_scrollframe, &viewport_size, NULL, &board_size);
+	ei_place(g_scrollframe, NULL, &viewport_x, &viewport_y, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	canvas = ei_widget_create("canvas", g_scrollframe, NULL, NULL);
+	ei_canvas_configure(canvas, &board_size, NULL, NULL, NULL);
+	ei_place(canvas, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+
+	/* Images of the same surface added one after the other are drawn together. */
+	srand(1);
+	for (int y = 0; y < BOARD_SIZE; y++) {
+		for (int x = 0; x < BOARD_SIZE; x++) {
+			ei_point_t	where		= {x * TILE_SIZE, y * TILE_SIZE};
+			ei_rect_t	tile_rect	= {{rand() % (tiles_size.width - TILE_SIZE),
+							    rand() % (tiles_size.height - TILE_SIZE)},
+							   {TILE_SIZE, TILE_SIZE}};
+			ei_canvas_add_image(canvas, &where, tiles, &tile_rect);
+		}
+	}
+	for (int y = 0; y < BOARD_SIZE; y++) {
+		for (int x = (y * 3) % 7; x < BOARD_SIZE; x += 7) {
+			ei_point_t	where		= {x * TILE_SIZE + (TILE_SIZE - flag_size.width) / 2,
+							   y * TILE_SIZE + (TILE_SIZE - flag_size.height) / 2};
+			ei_canvas_add_image(canvas, &where, flag, NULL);
+		}
+	}
+
+	ei_app_run();
+
+	hw_surface_free(flag);
+	hw_surface_free(tiles);
+
+	ei_app_free();
+
+	return (EXIT_SUCCESS);
+}